@@ -0,0 +1,336 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file algebraic_simplifier.c
+ * @brief Type aware algebraic simplification, reassociation and canonical operand order
+ */
+
+#include "algebraic_simplifier.h"
+#include "optimizer.h"
+#include "loop_invariant_motion.h"
+#include "induction_variables.h"
+#include <limits.h>
+
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    Function * function;
+    PointerTable * resultTable;
+} AlgebraicSimplifier;
+
+UnionType getSimplifiedType(AlgebraicSimplifier * simplifier, Expression * expression) {
+    return expression->getType(expression, simplifier->functionTable, simplifier->program, simplifier->function, simplifier->resultTable);
+}
+
+bool isOnlyInt(AlgebraicSimplifier * simplifier, Expression * expression) {
+    UnionType type = getSimplifiedType(simplifier, expression);
+    return type.isInt && !type.isFloat && !type.isString && !type.isBool && !type.isNull && !type.isUndefined;
+}
+
+bool isOnlyFloat(AlgebraicSimplifier * simplifier, Expression * expression) {
+    UnionType type = getSimplifiedType(simplifier, expression);
+    return type.isFloat && !type.isInt && !type.isString && !type.isBool && !type.isNull && !type.isUndefined;
+}
+
+bool isOnlyString(AlgebraicSimplifier * simplifier, Expression * expression) {
+    UnionType type = getSimplifiedType(simplifier, expression);
+    return type.isString && !type.isInt && !type.isFloat && !type.isBool && !type.isNull && !type.isUndefined;
+}
+
+bool isOnlyBool(AlgebraicSimplifier * simplifier, Expression * expression) {
+    UnionType type = getSimplifiedType(simplifier, expression);
+    return type.isBool && !type.isInt && !type.isFloat && !type.isString && !type.isNull && !type.isUndefined;
+}
+
+bool isConstantOfType(Expression * expression, int type) {
+    return expression->expressionType == EXPRESSION_CONSTANT && ((Expression__Constant*)expression)->type.type == type;
+}
+
+bool isIntConstantEqual(Expression * expression, long long value) {
+    return isConstantOfType(expression, TYPE_INT) && ((Expression__Constant*)expression)->value.integer == value;
+}
+
+/**
+ * @brief Checks for int or float constant with the value
+ */
+bool isNumberConstant(Expression * expression, long long value) {
+    return isIntConstantEqual(expression, value) || (isConstantOfType(expression, TYPE_FLOAT) && ((Expression__Constant*)expression)->value.real == (double)value);
+}
+
+bool isBoolConstant(Expression * expression, bool value) {
+    return isConstantOfType(expression, TYPE_BOOL) && ((Expression__Constant*)expression)->value.boolean == value;
+}
+
+bool isEmptyStringConstant(Expression * expression) {
+    return isConstantOfType(expression, TYPE_STRING) && ((Expression__Constant*)expression)->value.string[0] == '\0';
+}
+
+Expression * createIntConstant(long long value) {
+    Expression__Constant * constant = Expression__Constant__init();
+    constant->type = (Type){.type = TYPE_INT, .isRequired = true};
+    constant->value.integer = value;
+    return (Expression*)constant;
+}
+
+Expression * createSimplifiedOperation(Expression * lSide, TokenType operator, Expression * rSide) {
+    Expression__BinaryOperator * op = Expression__BinaryOperator__init();
+    op->operator = operator;
+    op->lSide = lSide;
+    op->rSide = rSide;
+    return (Expression*)op;
+}
+
+/**
+ * @brief Creates $x + value, $x - (-value) or just $x for zero
+ */
+Expression * createIntOffset(Expression * expression, long long value) {
+    if(value == 0) return expression;
+    if(value < 0) return createSimplifiedOperation(expression, TOKEN_MINUS, createIntConstant(-value));
+    return createSimplifiedOperation(expression, TOKEN_PLUS, createIntConstant(value));
+}
+
+/**
+ * @brief Checks if the operands can be swapped without changing behaviour
+ * @note constant can always move, otherwise both operands must be free of side effects and runtime errors
+ */
+bool canSwapOperands(AlgebraicSimplifier * simplifier, Expression__BinaryOperator * op) {
+    if(op->lSide->expressionType == EXPRESSION_CONSTANT || op->rSide->expressionType == EXPRESSION_CONSTANT) return true;
+    return isInvariantExpression(NULL, op->lSide) && isInvariantExpression(NULL, op->rSide) &&
+        !canExpressionFail(op->lSide, simplifier->function, simplifier->functionTable, simplifier->program, simplifier->resultTable) &&
+        !canExpressionFail(op->rSide, simplifier->function, simplifier->functionTable, simplifier->program, simplifier->resultTable);
+}
+
+/**
+ * @brief Puts operands of commutative operators into canonical order, constants right and the rest ordered by its text,
+ *  so equal expressions written differently are found by common subexpression elimination
+ */
+bool canonicalizeOperands(AlgebraicSimplifier * simplifier, Expression__BinaryOperator * op) {
+    TokenType mirrored;
+    switch(op->operator) {
+        case TOKEN_PLUS:
+        case TOKEN_MULTIPLY:
+        case TOKEN_EQUALS:
+        case TOKEN_NOT_EQUALS:
+            mirrored = op->operator;
+            break;
+        case TOKEN_LESS:
+            mirrored = TOKEN_GREATER;
+            break;
+        case TOKEN_GREATER:
+            mirrored = TOKEN_LESS;
+            break;
+        case TOKEN_LESS_OR_EQUALS:
+            mirrored = TOKEN_GREATER_OR_EQUALS;
+            break;
+        case TOKEN_GREATER_OR_EQUALS:
+            mirrored = TOKEN_LESS_OR_EQUALS;
+            break;
+        default:
+            return false;
+    }
+    if(op->rSide->expressionType == EXPRESSION_CONSTANT) return false;
+    bool isSwapNeeded = op->lSide->expressionType == EXPRESSION_CONSTANT;
+    if(!isSwapNeeded) {
+        // relational operators keep their order, only constants are moved
+        if(mirrored != op->operator) return false;
+        char * lKey = serializeExpression(op->lSide);
+        char * rKey = serializeExpression(op->rSide);
+        isSwapNeeded = strcmp(lKey, rKey) > 0;
+        free(lKey);
+        free(rKey);
+    }
+    if(!isSwapNeeded || !canSwapOperands(simplifier, op)) return false;
+    Expression * lSide = op->lSide;
+    op->lSide = op->rSide;
+    op->rSide = lSide;
+    op->operator = mirrored;
+    return true;
+}
+
+/**
+ * @brief Removes operations which return their operand unchanged, only when the operand already has the type of the result
+ * @note $x + 0 is kept for floats, because -0.0 + 0 is 0.0
+ */
+Expression * removeIdentity(AlgebraicSimplifier * simplifier, Expression__BinaryOperator * op) {
+    Expression * lSide = op->lSide;
+    Expression * rSide = op->rSide;
+    switch(op->operator) {
+        case TOKEN_PLUS:
+            if(isIntConstantEqual(rSide, 0) && isOnlyInt(simplifier, lSide)) return lSide;
+            break;
+        case TOKEN_MINUS:
+            if(isIntConstantEqual(rSide, 0) && isOnlyInt(simplifier, lSide)) return lSide;
+            if(isNumberConstant(rSide, 0) && isOnlyFloat(simplifier, lSide)) return lSide;
+            break;
+        case TOKEN_MULTIPLY:
+            if(isIntConstantEqual(rSide, 1) && isOnlyInt(simplifier, lSide)) return lSide;
+            if(isNumberConstant(rSide, 1) && isOnlyFloat(simplifier, lSide)) return lSide;
+            // the operand isnt needed, if its evaluation cant be observed
+            if(isIntConstantEqual(rSide, 0) && isOnlyInt(simplifier, lSide) && isInvariantExpression(NULL, lSide) &&
+                !canExpressionFail(lSide, simplifier->function, simplifier->functionTable, simplifier->program, simplifier->resultTable)) {
+                return createIntConstant(0);
+            }
+            break;
+        case TOKEN_DIVIDE:
+            // division always returns float
+            if(isNumberConstant(rSide, 1) && isOnlyFloat(simplifier, lSide)) return lSide;
+            break;
+        case TOKEN_CONCATENATE:
+            if(isEmptyStringConstant(rSide) && isOnlyString(simplifier, lSide)) return lSide;
+            if(isEmptyStringConstant(lSide) && isOnlyString(simplifier, rSide)) return rSide;
+            break;
+        case TOKEN_AND:
+            if(isBoolConstant(rSide, true) && isOnlyBool(simplifier, lSide)) return lSide;
+            if(isBoolConstant(lSide, true) && isOnlyBool(simplifier, rSide)) return rSide;
+            break;
+        case TOKEN_OR:
+            if(isBoolConstant(rSide, false) && isOnlyBool(simplifier, lSide)) return lSide;
+            if(isBoolConstant(lSide, false) && isOnlyBool(simplifier, rSide)) return rSide;
+            break;
+        default:
+            break;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Gets signed value of int constant added by + or - operation
+ */
+bool getIntOffset(TokenType operator, Expression * constant, long long * offset) {
+    if(!isConstantOfType(constant, TYPE_INT)) return false;
+    long long value = ((Expression__Constant*)constant)->value.integer;
+    if(operator == TOKEN_PLUS) {
+        *offset = value;
+        return true;
+    }
+    if(operator == TOKEN_MINUS && value != LLONG_MIN) {
+        *offset = -value;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Gathers constants of int addition and multiplication and of string concatenation
+ * @note int arithmetic is exact, so any order gives the same result, floats are never reassociated
+ */
+Expression * reassociate(AlgebraicSimplifier * simplifier, Expression__BinaryOperator * op) {
+    Expression__BinaryOperator * left = op->lSide->expressionType == EXPRESSION_BINARY_OPERATOR ? (Expression__BinaryOperator*)op->lSide : NULL;
+    Expression__BinaryOperator * right = op->rSide->expressionType == EXPRESSION_BINARY_OPERATOR ? (Expression__BinaryOperator*)op->rSide : NULL;
+    switch(op->operator) {
+        case TOKEN_PLUS:
+        case TOKEN_MINUS: {
+            long long outerOffset, innerOffset, offset;
+            // ($x + c1) + c2 => $x + (c1 + c2)
+            if(left != NULL && (left->operator == TOKEN_PLUS || left->operator == TOKEN_MINUS) && getIntOffset(op->operator, op->rSide, &outerOffset) &&
+                getIntOffset(left->operator, left->rSide, &innerOffset) && isOnlyInt(simplifier, left->lSide)) {
+                if(__builtin_add_overflow(outerOffset, innerOffset, &offset) || offset == LLONG_MIN) return NULL;
+                return createIntOffset(left->lSide, offset);
+            }
+            // ($y + c) + $x => ($y + $x) + c
+            if(left != NULL && (left->operator == TOKEN_PLUS || left->operator == TOKEN_MINUS) && isConstantOfType(left->rSide, TYPE_INT) &&
+                op->rSide->expressionType != EXPRESSION_CONSTANT && isOnlyInt(simplifier, op->rSide) && isOnlyInt(simplifier, left->lSide)) {
+                return createSimplifiedOperation(createSimplifiedOperation(left->lSide, op->operator, op->rSide), left->operator, left->rSide);
+            }
+            // $x + ($y + c) => ($x + $y) + c, so the constant can be gathered by the enclosing operation
+            if(right != NULL && (right->operator == TOKEN_PLUS || right->operator == TOKEN_MINUS) && isConstantOfType(right->rSide, TYPE_INT) &&
+                op->lSide->expressionType != EXPRESSION_CONSTANT && isOnlyInt(simplifier, op->lSide) && isOnlyInt(simplifier, right->lSide)) {
+                TokenType operator = op->operator == right->operator ? TOKEN_PLUS : TOKEN_MINUS;
+                return createSimplifiedOperation(createSimplifiedOperation(op->lSide, op->operator, right->lSide), operator, right->rSide);
+            }
+            break;
+        }
+        case TOKEN_MULTIPLY: {
+            // ($x * c1) * c2 => $x * (c1 * c2)
+            if(left != NULL && left->operator == TOKEN_MULTIPLY && isConstantOfType(op->rSide, TYPE_INT) && isConstantOfType(left->rSide, TYPE_INT) &&
+                isOnlyInt(simplifier, left->lSide)) {
+                long long factor;
+                if(__builtin_mul_overflow(((Expression__Constant*)op->rSide)->value.integer, ((Expression__Constant*)left->rSide)->value.integer, &factor)) return NULL;
+                return createSimplifiedOperation(left->lSide, TOKEN_MULTIPLY, createIntConstant(factor));
+            }
+            // ($y * c) * $x => ($y * $x) * c
+            if(left != NULL && left->operator == TOKEN_MULTIPLY && isConstantOfType(left->rSide, TYPE_INT) &&
+                op->rSide->expressionType != EXPRESSION_CONSTANT && isOnlyInt(simplifier, op->rSide) && isOnlyInt(simplifier, left->lSide)) {
+                return createSimplifiedOperation(createSimplifiedOperation(left->lSide, TOKEN_MULTIPLY, op->rSide), TOKEN_MULTIPLY, left->rSide);
+            }
+            // $x * ($y * c) => ($x * $y) * c
+            if(right != NULL && right->operator == TOKEN_MULTIPLY && isConstantOfType(right->rSide, TYPE_INT) &&
+                op->lSide->expressionType != EXPRESSION_CONSTANT && isOnlyInt(simplifier, op->lSide) && isOnlyInt(simplifier, right->lSide)) {
+                return createSimplifiedOperation(createSimplifiedOperation(op->lSide, TOKEN_MULTIPLY, right->lSide), TOKEN_MULTIPLY, right->rSide);
+            }
+            break;
+        }
+        case TOKEN_CONCATENATE: {
+            // concatenation is associative for any operands, operands of other types fail the same way in any order
+            // ($s . "a") . "b" => $s . "ab"
+            if(left != NULL && left->operator == TOKEN_CONCATENATE && isConstantOfType(op->rSide, TYPE_STRING) && isConstantOfType(left->rSide, TYPE_STRING)) {
+                Expression__BinaryOperator * constants = (Expression__BinaryOperator*)createSimplifiedOperation(left->rSide, TOKEN_CONCATENATE, op->rSide);
+                Expression * folded = (Expression*)performConstantFolding(constants);
+                free(constants);
+                return createSimplifiedOperation(left->lSide, TOKEN_CONCATENATE, folded);
+            }
+            // "a" . ("b" . $s) => "ab" . $s
+            if(right != NULL && right->operator == TOKEN_CONCATENATE && isConstantOfType(op->lSide, TYPE_STRING) && isConstantOfType(right->lSide, TYPE_STRING)) {
+                Expression__BinaryOperator * constants = (Expression__BinaryOperator*)createSimplifiedOperation(op->lSide, TOKEN_CONCATENATE, right->lSide);
+                Expression * folded = (Expression*)performConstantFolding(constants);
+                free(constants);
+                return createSimplifiedOperation(folded, TOKEN_CONCATENATE, right->rSide);
+            }
+            // $s . ($t . "a") => ($s . $t) . "a"
+            if(right != NULL && right->operator == TOKEN_CONCATENATE && isConstantOfType(right->rSide, TYPE_STRING) && op->lSide->expressionType != EXPRESSION_CONSTANT) {
+                return createSimplifiedOperation(createSimplifiedOperation(op->lSide, TOKEN_CONCATENATE, right->lSide), TOKEN_CONCATENATE, right->rSide);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Simplifies negation, double negation of bool and negated equality
+ */
+Expression * simplifyNegation(AlgebraicSimplifier * simplifier, Expression__PrefixOperator * op) {
+    if(op->operator != TOKEN_NEGATE) return NULL;
+    if(op->rSide->expressionType == EXPRESSION_PREFIX_OPERATOR && ((Expression__PrefixOperator*)op->rSide)->operator == TOKEN_NEGATE) {
+        Expression * operand = ((Expression__PrefixOperator*)op->rSide)->rSide;
+        if(isOnlyBool(simplifier, operand)) return operand;
+    }
+    if(op->rSide->expressionType == EXPRESSION_BINARY_OPERATOR) {
+        Expression__BinaryOperator * comparison = (Expression__BinaryOperator*)op->rSide;
+        // strict comparisons always return bool, so their negation is the opposite comparison
+        if(comparison->operator == TOKEN_EQUALS) return createSimplifiedOperation(comparison->lSide, TOKEN_NOT_EQUALS, comparison->rSide);
+        if(comparison->operator == TOKEN_NOT_EQUALS) return createSimplifiedOperation(comparison->lSide, TOKEN_EQUALS, comparison->rSide);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Applies algebraic rules to the expression in the slot, rules are applied only where types guarantee the same result
+ *
+ * @param slot
+ * @param functionTable
+ * @param program
+ * @param currentFunction
+ * @param resultTable
+ * @return true if the expression was changed
+ */
+bool performAlgebraicSimplification(Expression ** slot, Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable) {
+    AlgebraicSimplifier simplifier = {.functionTable = functionTable, .program = program, .function = currentFunction, .resultTable = resultTable};
+    Expression * expression = *slot;
+    Expression * simplified = NULL;
+    if(expression->expressionType == EXPRESSION_PREFIX_OPERATOR) {
+        simplified = simplifyNegation(&simplifier, (Expression__PrefixOperator*)expression);
+    } else if(expression->expressionType == EXPRESSION_BINARY_OPERATOR) {
+        Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+        if(op->operator == TOKEN_ASSIGN) return false;
+        // operations of constants are left for constant folding
+        if(op->lSide->expressionType == EXPRESSION_CONSTANT && op->rSide->expressionType == EXPRESSION_CONSTANT) return false;
+        if(canonicalizeOperands(&simplifier, op)) return true;
+        simplified = removeIdentity(&simplifier, op);
+        if(simplified == NULL) simplified = reassociate(&simplifier, op);
+    }
+    if(simplified == NULL) return false;
+    *slot = simplified;
+    return true;
+}
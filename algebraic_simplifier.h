@@ -0,0 +1,17 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file algebraic_simplifier.h
+ * @brief Header file for type aware algebraic simplification
+ */
+
+#ifndef __ALGEBRAIC_SIMPLIFIER_H__
+#define __ALGEBRAIC_SIMPLIFIER_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+#include "pointer_hashtable.h"
+
+bool performAlgebraicSimplification(Expression ** slot, Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable);
+
+#endif // __ALGEBRAIC_SIMPLIFIER_H__
@@ -36,6 +36,19 @@ Statement *** getAllStatements(Statement * parent, size_t * count) {
     return children;
 }
 
+/**
+ * @brief Get number of nodes in a block, used as estimate of the code size
+ * 
+ * @param statement
+ * @return int
+ */
+int getStatementSize(Statement * statement) {
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(statement, &statementCount);
+    free(allStatements);
+    return (int)statementCount;
+}
+
 /**
  * @brief Statement list serializer
  * 
@@ -308,6 +321,32 @@ Expression__Constant* Expression__Constant__duplicate(Expression__Constant* this
     return duplicate;
 }
 
+/**
+ * @brief Compares values of two constants
+ * 
+ * @param this 
+ * @param other 
+ * @return true if both constants have the same type and value
+ */
+bool Expression__Constant__equals(Expression__Constant* this, Expression__Constant* other) {
+    if(this == other) return true;
+    if(this->type.type != other->type.type) return false;
+    switch(this->type.type) {
+        case TYPE_INT:
+            return this->value.integer == other->value.integer;
+        case TYPE_FLOAT:
+            return this->value.real == other->value.real;
+        case TYPE_STRING:
+            return strcmp(this->value.string, other->value.string) == 0;
+        case TYPE_BOOL:
+            return this->value.boolean == other->value.boolean;
+        case TYPE_NULL:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void Expression__Constant__free(Expression__Constant* this) {
     if(this->type.type == TYPE_STRING) {
         //free(this->value.string);
@@ -424,6 +463,16 @@ void freeTableStatement(PointerTable * table) {
     free(table);
 }
 
+/**
+ * @brief Checks if both known constants have the same value, equal constants from different assignments stay known after join
+ */
+bool isSameConstant(Expression * constant1, Expression * constant2) {
+    if(constant1 == constant2) return true;
+    if(constant1 == NULL || constant2 == NULL) return false;
+    if(constant1->expressionType != EXPRESSION_CONSTANT || constant2->expressionType != EXPRESSION_CONSTANT) return false;
+    return Expression__Constant__equals((Expression__Constant*)constant1, (Expression__Constant*)constant2);
+}
+
 UnionType orUnionType(UnionType type1, UnionType type2) {
     UnionType ret;
     ret.isBool = type1.isBool || type2.isBool;
@@ -432,7 +481,7 @@ UnionType orUnionType(UnionType type1, UnionType type2) {
     ret.isNull = type1.isNull || type2.isNull;
     ret.isString = type1.isString || type2.isString;
     ret.isUndefined = type1.isUndefined || type2.isUndefined;
-    if(type1.constant == type2.constant) {
+    if(isSameConstant(type1.constant, type2.constant)) {
         ret.constant = type1.constant;
     } else if(type1.constant != NULL && type2.constant == NULL) {
         if(!type2.isBool && !type2.isFloat && !type2.isInt && !type2.isNull && !type2.isString && !type2.isUndefined) {
@@ -464,7 +513,7 @@ bool orVariableTables(Table * variableTable, Table * duplTable) {
             }
             UnionType * type1 = (UnionType*)item1->data;
             UnionType * type2 = (UnionType*)item2->data;
-            if(type1->constant != type2->constant) {
+            if(!isSameConstant(type1->constant, type2->constant)) {
                 if(type1->constant != NULL) {
                     type1->constant = NULL;
                     changed = true;
@@ -637,6 +686,91 @@ void freeControlFlowInfo(ControlFlowInfo flow) {
 }
 
 
+/**
+ * @brief Forgets that variables are copies of the written variable, the copies keep the old value
+ *
+ * @param variableTable 
+ * @param name name of the written variable
+ */
+void invalidateVariableCopies(Table * variableTable, char * name) {
+    for(int i = 0; i < TB_SIZE; i++) {
+        TableItem * item = variableTable->tb[i];
+        while (item != NULL) {
+            UnionType * type = (UnionType*)item->data;
+            if(type->constant != NULL && type->constant->expressionType == EXPRESSION_VARIABLE && strcmp(((Expression__Variable*)type->constant)->name, name) == 0) {
+                type->constant = NULL;
+            }
+            item = item->next;
+        }
+    }
+}
+
+/**
+ * @brief Type of variable after increment or decrement, null becomes 1 after increment and stays null after decrement, bool doesnt change
+ * @note strings arent supported by generated code, so they can become any number
+ * 
+ * @param type type before the operation
+ * @param operator TOKEN_INCREMENT or TOKEN_DECREMENT
+ * @return UnionType 
+ */
+UnionType getIncrementedType(UnionType type, TokenType operator) {
+    bool isOther = type.isString || type.isUndefined || !(type.isInt || type.isFloat || type.isNull || type.isBool);
+    UnionType result = {0};
+    result.isInt = type.isInt || isOther || (type.isNull && operator == TOKEN_INCREMENT);
+    result.isFloat = type.isFloat || isOther;
+    result.isBool = type.isBool;
+    result.isNull = type.isNull && operator == TOKEN_DECREMENT;
+    return result;
+}
+
+/**
+ * @brief Type of result of +, - or *, operands are converted to float only if one of them is float, otherwise to int
+ * 
+ * @param lType 
+ * @param rType 
+ * @return UnionType 
+ */
+UnionType getArithmeticResultType(UnionType lType, UnionType rType) {
+    bool canLBeNonFloat = lType.isInt || lType.isBool || lType.isNull || lType.isString;
+    bool canRBeNonFloat = rType.isInt || rType.isBool || rType.isNull || rType.isString;
+    return (UnionType){.isInt = canLBeNonFloat && canRBeNonFloat, .isFloat = lType.isFloat || rType.isFloat};
+}
+
+/**
+ * @brief Type of result of ??, right side is the result only if left side is null
+ * 
+ * @param lType 
+ * @param rType 
+ * @return UnionType 
+ */
+UnionType getNullCoalescingResultType(UnionType lType, UnionType rType) {
+    if(!lType.isNull) {
+        lType.isUndefined = false;
+        return lType;
+    }
+    UnionType nonNullType = lType;
+    nonNullType.isNull = false;
+    nonNullType.isUndefined = false;
+    nonNullType.constant = NULL;
+    UnionType result = orUnionType(nonNullType, rType);
+    // right side is read before the operator, so it cant be undefined
+    result.isUndefined = false;
+    result.constant = NULL;
+    return result;
+}
+
+/**
+ * @brief Checks if generated call checks types of arguments, conversion functions and write accept any value
+ * 
+ * @param function called function
+ * @return true if arguments are checked
+ */
+bool areArgumentsTypeChecked(Function * function) {
+    if(function->body != NULL) return true;
+    return strcmp(function->name, "write") != 0 && strcmp(function->name, "intval") != 0 && strcmp(function->name, "floatval") != 0 &&
+        strcmp(function->name, "boolval") != 0 && strcmp(function->name, "strval") != 0;
+}
+
 void getExpressionVarType(Table * functionTable, Expression * expression, Table * variableTable, UnionType * exprTypeRet, PointerTable * resultTable) {
     switch (expression->expressionType) {
         case EXPRESSION_CONSTANT:
@@ -662,12 +796,32 @@ void getExpressionVarType(Table * functionTable, Expression * expression, Table
         }
         case EXPRESSION_FUNCTION_CALL: {
             Expression__FunctionCall* func = (Expression__FunctionCall*)expression;
+            // generated code reads variable arguments only after all arguments are evaluated
+            for(int i = 0; i < func->arity; i++) {
+                if(func->arguments[i]->expressionType != EXPRESSION_VARIABLE) getExpressionVarType(functionTable, func->arguments[i], variableTable, NULL, resultTable);
+            }
             for(int i = 0; i < func->arity; i++) {
-                getExpressionVarType(functionTable, func->arguments[i], variableTable, NULL, resultTable);
+                if(func->arguments[i]->expressionType == EXPRESSION_VARIABLE) getExpressionVarType(functionTable, func->arguments[i], variableTable, NULL, resultTable);
+            }
+            Function * function = (Function*)table_find(functionTable, func->name)->data;
+            if(areArgumentsTypeChecked(function) && function->arity == func->arity) {
+                // arguments are checked after all of them are evaluated, variables which passed the check have the parameter type
+                for(int i = 0; i < func->arity; i++) {
+                    if(func->arguments[i]->expressionType != EXPRESSION_VARIABLE || function->parameterTypes[i].type == TYPE_UNKNOWN) continue;
+                    UnionType * type = (UnionType*)table_find(variableTable, ((Expression__Variable*)func->arguments[i])->name)->data;
+                    UnionType checkedType = *type;
+                    UnionType parameterType = typeToUnionType(function->parameterTypes[i]);
+                    checkedType.isInt = type->isInt && parameterType.isInt;
+                    checkedType.isFloat = type->isFloat && parameterType.isFloat;
+                    checkedType.isString = type->isString && parameterType.isString;
+                    checkedType.isBool = type->isBool && parameterType.isBool;
+                    checkedType.isNull = type->isNull && parameterType.isNull;
+                    if(!checkedType.isInt && !checkedType.isFloat && !checkedType.isString && !checkedType.isBool && !checkedType.isNull) continue;
+                    *type = checkedType;
+                }
             }
             if(exprTypeRet != NULL) {
-                Function * function = (Function*)table_find(functionTable, func->name)->data;
-                *exprTypeRet = typeToUnionType(function->returnType);
+                *exprTypeRet = Function__getReturnType(function);
             }
             break;
         }
@@ -677,15 +831,10 @@ void getExpressionVarType(Table * functionTable, Expression * expression, Table
                 UnionType assignedType;
                 getExpressionVarType(functionTable, binOp->rSide, variableTable, &assignedType, resultTable);
                 assignedType.isUndefined = false;
-                for(int i = 0; i < TB_SIZE; i++) {
-                    TableItem * item = variableTable->tb[i];
-                    while (item != NULL) {
-                        UnionType * type = (UnionType*)item->data;
-                        if(type->constant != NULL && type->constant->expressionType == EXPRESSION_VARIABLE && strcmp(((Expression__Variable*)type->constant)->name, ((Expression__Variable*)binOp->lSide)->name) == 0) {
-                            type->constant = NULL;
-                        }
-                        item = item->next;
-                    }
+                invalidateVariableCopies(variableTable, ((Expression__Variable*)binOp->lSide)->name);
+                // self assignment would make the variable a copy of itself
+                if(assignedType.constant != NULL && assignedType.constant->expressionType == EXPRESSION_VARIABLE && strcmp(((Expression__Variable*)assignedType.constant)->name, ((Expression__Variable*)binOp->lSide)->name) == 0) {
+                    assignedType.constant = NULL;
                 }
                 *(UnionType*)table_find(variableTable, ((Expression__Variable*)binOp->lSide)->name)->data = assignedType;
                 if(exprTypeRet != NULL) {
@@ -698,8 +847,23 @@ void getExpressionVarType(Table * functionTable, Expression * expression, Table
             }
             UnionType lType;
             UnionType rType;
-            getExpressionVarType(functionTable, binOp->lSide, variableTable, &lType, resultTable);
-            getExpressionVarType(functionTable, binOp->rSide, variableTable, &rType, resultTable);
+            bool isShortCircuit = binOp->operator == TOKEN_AND || binOp->operator == TOKEN_OR || binOp->operator == TOKEN_NULL_COALESCING;
+            if(!isShortCircuit && binOp->lSide->expressionType == EXPRESSION_VARIABLE) {
+                // variable operand is read by the operator itself, after the other operand is evaluated
+                getExpressionVarType(functionTable, binOp->rSide, variableTable, &rType, resultTable);
+                getExpressionVarType(functionTable, binOp->lSide, variableTable, &lType, resultTable);
+            } else {
+                getExpressionVarType(functionTable, binOp->lSide, variableTable, &lType, resultTable);
+            }
+            if(isShortCircuit) {
+                // right side of short circuit operators doesnt have to be evaluated
+                Table * duplTable = duplicateVarTypeTable(variableTable);
+                getExpressionVarType(functionTable, binOp->rSide, duplTable, &rType, resultTable);
+                orVariableTables(variableTable, duplTable);
+                freeVarTypeTable(duplTable);
+            } else if(binOp->lSide->expressionType != EXPRESSION_VARIABLE) {
+                getExpressionVarType(functionTable, binOp->rSide, variableTable, &rType, resultTable);
+            }
             if(exprTypeRet == NULL) {
                 return;
             }
@@ -708,10 +872,12 @@ void getExpressionVarType(Table * functionTable, Expression * expression, Table
                 case TOKEN_PLUS:
                 case TOKEN_MINUS:
                 case TOKEN_MULTIPLY: {
-                    exprTypeRet->isInt = lType.isInt && rType.isInt;
-                    exprTypeRet->isFloat = lType.isFloat || rType.isFloat;
+                    *exprTypeRet = getArithmeticResultType(lType, rType);
                     break;
                 }
+                case TOKEN_NULL_COALESCING:
+                    *exprTypeRet = getNullCoalescingResultType(lType, rType);
+                    break;
                 case TOKEN_CONCATENATE:
                     exprTypeRet->isString = true;
                     break;
@@ -728,6 +894,8 @@ void getExpressionVarType(Table * functionTable, Expression * expression, Table
                 case TOKEN_GREATER:
                 case TOKEN_LESS_OR_EQUALS:
                 case TOKEN_GREATER_OR_EQUALS:
+                case TOKEN_AND:
+                case TOKEN_OR:
                     exprTypeRet->isBool = true;
                     break;
                 default:
@@ -739,26 +907,30 @@ void getExpressionVarType(Table * functionTable, Expression * expression, Table
             Expression__PrefixOperator* unOp = (Expression__PrefixOperator*)expression;
             UnionType rType;
             getExpressionVarType(functionTable, unOp->rSide, variableTable, &rType, resultTable);
-             if(exprTypeRet == NULL) {
-                return;
-            }
-            *exprTypeRet = (UnionType){0};
+            UnionType resultType = {0};
             switch (unOp->operator) {
                 case TOKEN_NEGATE:
-                    exprTypeRet->isBool = true;
+                    resultType.isBool = true;
                     break;
                 case TOKEN_INCREMENT:
-                case TOKEN_DECREMENT:
-                    exprTypeRet->isInt = true;
-                    exprTypeRet->isFloat = true;
+                case TOKEN_DECREMENT: {
+                    resultType = getIncrementedType(rType, unOp->operator);
                     if(unOp->rSide->expressionType == EXPRESSION_VARIABLE) {
+                        invalidateVariableCopies(variableTable, ((Expression__Variable*)unOp->rSide)->name);
                         UnionType * type = (UnionType*)table_find(variableTable, ((Expression__Variable*)unOp->rSide)->name)->data;
-                        type->constant = NULL;
+                        *type = resultType;
+                        // operand is written, so its value cant be replaced by constant
+                        UnionType * operandType = malloc(sizeof(UnionType));
+                        *operandType = rType;
+                        operandType->constant = NULL;
+                        pointer_table_insert(resultTable, unOp->rSide, operandType);
                     }
                     break;
+                }
                 default:
                     break;
             }
+            if(exprTypeRet) *exprTypeRet = resultType;
             break;
         }
         case EXPRESSION_POSTFIX_OPERATOR: {
@@ -767,18 +939,15 @@ void getExpressionVarType(Table * functionTable, Expression * expression, Table
                 case TOKEN_INCREMENT:
                 case TOKEN_DECREMENT:
                     if(postOp->operand->expressionType == EXPRESSION_VARIABLE) {
+                        invalidateVariableCopies(variableTable, ((Expression__Variable*)postOp->operand)->name);
                         UnionType * type = (UnionType*)table_find(variableTable, ((Expression__Variable*)postOp->operand)->name)->data;
                         if(exprTypeRet) *exprTypeRet = *type;
-                        type->constant = NULL;
-                        type->isBool = false;
-                        type->isInt = true;
-                        type->isFloat = true;
-                        type->isString = false;
-                        type->isNull = false;
-                        type->isUndefined = false;
-                        UnionType * emptyType = malloc(sizeof(UnionType));
-                        *emptyType = (UnionType){0};
-                        pointer_table_insert(resultTable, postOp->operand, emptyType);
+                        // operand is written, so its value cant be replaced by constant
+                        UnionType * operandType = malloc(sizeof(UnionType));
+                        *operandType = *type;
+                        operandType->constant = NULL;
+                        *type = getIncrementedType(*type, postOp->operator);
+                        pointer_table_insert(resultTable, postOp->operand, operandType);
                     }
                     break;
                 default:
@@ -801,6 +970,25 @@ void andUnionType(UnionType * target, UnionType * src) {
     }
 }
 
+/**
+ * @brief Removes null from type of variable compared with null, used in the branch where the comparison failed
+ * 
+ * @param variableTable variable types of the branch
+ * @param side compared expression
+ * @param otherType type of the other side of the comparison
+ */
+void removeComparedNull(Table * variableTable, Expression * side, UnionType otherType) {
+    if(side->expressionType != EXPRESSION_VARIABLE) return;
+    if(!otherType.isNull || otherType.isInt || otherType.isFloat || otherType.isString || otherType.isBool || otherType.isUndefined) return;
+    UnionType * type = (UnionType*)table_find(variableTable, ((Expression__Variable*)side)->name)->data;
+    // branch is unreachable if the variable is always null, type without any value is avoided
+    if(!type->isInt && !type->isFloat && !type->isString && !type->isBool) return;
+    type->isNull = false;
+    if(type->constant != NULL && type->constant->expressionType == EXPRESSION_CONSTANT && ((Expression__Constant*)type->constant)->type.type == TYPE_NULL) {
+        type->constant = NULL;
+    }
+}
+
 ControlFlowInfo getStatementListVarType(Table * functionTable, StatementList * statementList, Table * variableTable, PointerTable * resultTable);
 
 ControlFlowInfo getStatementVarType(Table * functionTable, Statement * statement, Table * variableTable, PointerTable * resultTable) {
@@ -849,9 +1037,13 @@ ControlFlowInfo getStatementVarType(Table * functionTable, Statement * statement
                     UnionType * type = (UnionType*)table_find(variableTable, var->name)->data;
                     andUnionType(type, &lType);
                 }
+                removeComparedNull(duplTable, lSide, rType);
+                removeComparedNull(duplTable, rSide, lType);
             }
             
             if(performTypeComparison && operator == TOKEN_NOT_EQUALS) {
+                removeComparedNull(variableTable, lSide, rType);
+                removeComparedNull(variableTable, rSide, lType);
                 if(lSide->expressionType == EXPRESSION_VARIABLE) {
                     Expression__Variable* var = (Expression__Variable*)lSide;
                     UnionType * type = (UnionType*)table_find(duplTable, var->name)->data;
@@ -907,12 +1099,17 @@ ControlFlowInfo getStatementVarType(Table * functionTable, Statement * statement
                     andUnionType(type, &lType);
                 }
             }
+            if(performTypeComparison && operator == TOKEN_NOT_EQUALS) {
+                removeComparedNull(duplTable, lSide, rType);
+                removeComparedNull(duplTable, rSide, lType);
+            }
 
             ControlFlowInfo flow = (ControlFlowInfo){0};
             bool changed = true;
             while(changed) {
                 changed = false;
                 ControlFlowInfo partialFlow = getStatementVarType(functionTable, whileStatement->body, duplTable, duplResultTable);
+                performTypeComparison = false;
                 if(partialFlow.returnedEveryhere || partialFlow.returnedPartially || partialFlow.breakLevels > 0 || partialFlow.continueLevels > 0) {
                     Table * duplTable2 = duplicateVarTypeTable(duplTable);
                     PointerTable * duplResultTable2 = duplicateTableStatement(resultTable);
@@ -922,12 +1119,6 @@ ControlFlowInfo getStatementVarType(Table * functionTable, Statement * statement
                     freeVarTypeTable(duplTable2);
                     freeTableStatement(duplResultTable2);
                 } else {
-                    bool performTypeComparison = false;
-                    Expression * lSide = NULL;
-                    Expression * rSide = NULL;
-                    UnionType lType = {0};
-                    UnionType rType = {0};
-                    TokenType operator = 0;
                     if(whileStatement->condition->expressionType == EXPRESSION_BINARY_OPERATOR && (((Expression__BinaryOperator*)whileStatement->condition)->operator == TOKEN_EQUALS || ((Expression__BinaryOperator*)whileStatement->condition)->operator == TOKEN_NOT_EQUALS)) {
                         Expression__BinaryOperator * binOp = ((Expression__BinaryOperator*)whileStatement->condition);
                         lSide = binOp->lSide;
@@ -941,25 +1132,29 @@ ControlFlowInfo getStatementVarType(Table * functionTable, Statement * statement
                     }
                     rType.constant = NULL;
                     lType.constant = NULL;
-
-                    if(performTypeComparison && operator == TOKEN_EQUALS) {
-                        if(lSide->expressionType == EXPRESSION_VARIABLE) {
-                            Expression__Variable* var = (Expression__Variable*)lSide;
-                            UnionType * type = (UnionType*)table_find(duplTable, var->name)->data;
-                            andUnionType(type, &rType);
-                        }
-                        if(rSide->expressionType == EXPRESSION_VARIABLE) {
-                            Expression__Variable* var = (Expression__Variable*)rSide;
-                            UnionType * type = (UnionType*)table_find(duplTable, var->name)->data;
-                            andUnionType(type, &lType);
-                        }
-                    }
                 }
                 reduceLevelOfControlFlowInfo(&partialFlow);
                 mergeControlFlowInfos(&flow, partialFlow);
                 freeControlFlowInfo(partialFlow);
                 changed |= orVariableTables(variableTable, duplTable);
                 orResultTables(resultTable, duplResultTable);
+                // loop can end after the condition, so only the types for the next iteration of the body are narrowed
+                if(performTypeComparison && operator == TOKEN_EQUALS) {
+                    if(lSide->expressionType == EXPRESSION_VARIABLE) {
+                        Expression__Variable* var = (Expression__Variable*)lSide;
+                        UnionType * type = (UnionType*)table_find(duplTable, var->name)->data;
+                        andUnionType(type, &rType);
+                    }
+                    if(rSide->expressionType == EXPRESSION_VARIABLE) {
+                        Expression__Variable* var = (Expression__Variable*)rSide;
+                        UnionType * type = (UnionType*)table_find(duplTable, var->name)->data;
+                        andUnionType(type, &lType);
+                    }
+                }
+                if(performTypeComparison && operator == TOKEN_NOT_EQUALS) {
+                    removeComparedNull(duplTable, lSide, rType);
+                    removeComparedNull(duplTable, rSide, lType);
+                }
             }
             freeVarTypeTable(duplTable);
             freeTableStatement(duplResultTable);
@@ -1080,7 +1275,7 @@ ControlFlowInfo getStatementListVarType(Table * functionTable, StatementList * s
 void generateResultsTypeForFunction(Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable) {
     Table * variableTable = table_init();
     for(int i=0; i<currentFunction->arity; i++) {
-        UnionType type = typeToUnionType(currentFunction->parameterTypes[i]);
+        UnionType type = Function__getParameterType(currentFunction, i);
         UnionType * typePerm = malloc(sizeof(UnionType));
         *typePerm = type;
         table_insert(variableTable, currentFunction->parameterNames[i], typePerm);
@@ -1126,6 +1321,19 @@ void generateResultsTypeForProgram(Table * functionTable, StatementList * progra
     freeVarTypeTable(variableTable);
 }
 
+/**
+ * @brief Drops cached variable types of function or main program, they are recomputed on next use
+ * 
+ * @param resultTable 
+ * @param owner function or main program whose body was changed
+ */
+void invalidateResultsType(PointerTable * resultTable, Statement * owner) {
+    PointerTableItem * item = pointer_table_remove(resultTable, owner);
+    if(item == NULL) return;
+    pointer_table_free((PointerTable*)item->data);
+    free(item);
+}
+
 /**
  * @brief Get variable expression type
  * 
@@ -1251,7 +1459,7 @@ UnionType Expression__FunctionCall__getType(Expression__FunctionCall *this, Tabl
     Type type;
     TableItem * item = table_find(functionTable, this->name);
     if(item != NULL) {
-        type = ((Function*)item->data)->returnType;
+        return Function__getReturnType((Function*)item->data);
     } else {
         type.isRequired = false;
         type.type = TYPE_UNKNOWN;
@@ -1417,12 +1625,8 @@ UnionType Expression__BinaryOperator__getType(Expression__BinaryOperator *this,
         case TOKEN_MULTIPLY: {
             lType = this->lSide->getType(this->lSide, functionTable, program, currentFunction, resultTable);
             rType = this->rSide->getType(this->rSide, functionTable, program, currentFunction, resultTable);
-            if(lType.isInt && rType.isInt) {
-                type.isInt = true;
-            }
-            if(lType.isFloat || rType.isFloat) {
-                type.isFloat = true;
-            }
+            type = getArithmeticResultType(lType, rType);
+            type.constant = NULL;
             break;
         }
         case TOKEN_CONCATENATE:
@@ -1434,17 +1638,7 @@ UnionType Expression__BinaryOperator__getType(Expression__BinaryOperator *this,
         case TOKEN_NULL_COALESCING:
             lType = this->lSide->getType(this->lSide, functionTable, program, currentFunction, resultTable);
             rType = this->rSide->getType(this->rSide, functionTable, program, currentFunction, resultTable);
-            if(lType.isUndefined && rType.isUndefined) {
-                type.isUndefined = true;
-            }
-            else if(lType.isNull || lType.isUndefined) {
-                if(!rType.isUndefined) {
-                    type = rType;
-                }
-            }
-            else {
-                type = lType;
-            }
+            type = getNullCoalescingResultType(lType, rType);
             break;
         case TOKEN_ASSIGN:
             type = this->rSide->getType(this->rSide, functionTable, program, currentFunction, resultTable);
@@ -1839,6 +2033,8 @@ StatementWhile* StatementWhile__duplicate(StatementWhile* this) {
     StatementWhile* duplicate = StatementWhile__init();
     duplicate->body = (this->body != NULL ? this->body->duplicate(this->body) : NULL);
     duplicate->condition = (this->condition != NULL ? (Expression*)this->condition->super.duplicate((Statement*)this->condition) : NULL);
+    duplicate->isUnrolled = this->isUnrolled;
+    duplicate->peelCount = this->peelCount;
     return duplicate;
 }
 
@@ -1864,6 +2060,8 @@ StatementWhile* StatementWhile__init() {
     this->super.free = (void (*)(struct Statement *))StatementWhile__free;
     this->condition = NULL;
     this->body = NULL;
+    this->isUnrolled = false;
+    this->peelCount = 0;
     return this;
 }
 
@@ -1930,6 +2128,8 @@ StatementFor* StatementFor__duplicate(StatementFor* this) {
     duplicate->condition = (this->condition != NULL ? (Expression*)this->condition->super.duplicate((Statement*)this->condition) : NULL);
     duplicate->init = (this->init != NULL ? (Expression*)this->init->super.duplicate((Statement*)this->init) : NULL);
     duplicate->increment = (this->increment != NULL ? (Expression*)this->increment->super.duplicate((Statement*)this->increment) : NULL);
+    duplicate->isUnrolled = this->isUnrolled;
+    duplicate->peelCount = this->peelCount;
     return duplicate;
 }
 
@@ -1964,6 +2164,8 @@ StatementFor* StatementFor__init() {
     this->body = NULL;
     this->init = NULL;
     this->increment = NULL;
+    this->isUnrolled = false;
+    this->peelCount = 0;
     return this;
 }
 
@@ -2280,9 +2482,35 @@ Function* Function__init() {
     this->parameterNames = NULL;
     this->globalVariables = table_init();
     this->body = NULL;
+    this->isReturnTypeInferred = false;
+    this->inferredReturnType = (UnionType){0};
+    this->inferredParameterTypes = NULL;
     return this;
 }
 
+/**
+ * @brief Get type of values returned by the function
+ * 
+ * @param this 
+ * @return UnionType inferred type if available, declared type otherwise
+ */
+UnionType Function__getReturnType(Function *this) {
+    if(this->isReturnTypeInferred) return this->inferredReturnType;
+    return typeToUnionType(this->returnType);
+}
+
+/**
+ * @brief Get type of the parameter at the start of the function body
+ * 
+ * @param this 
+ * @param index index of the parameter
+ * @return UnionType inferred type if available, declared type otherwise
+ */
+UnionType Function__getParameterType(Function *this, int index) {
+    if(this->inferredParameterTypes != NULL) return this->inferredParameterTypes[index];
+    return typeToUnionType(this->parameterTypes[index]);
+}
+
 /**
  * @brief Add function parameter
  * 
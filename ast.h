@@ -44,6 +44,7 @@ typedef struct Statement {
 } Statement;
 
 Statement *** getAllStatements(Statement * parent, size_t * count);
+int getStatementSize(Statement * statement);
 
 /**
  * @brief Statement list structure
@@ -86,6 +87,8 @@ typedef struct {
 Type tokenToType(Token token);
 UnionType typeToUnionType(Type type);
 Type unionTypeToType(UnionType unionType);
+bool isSameConstant(struct Expression * constant1, struct Expression * constant2);
+UnionType orUnionType(UnionType type1, UnionType type2);
 
 /**
  * @brief Expression type enumeration
@@ -126,6 +129,8 @@ typedef struct Expression__Constant {
 
 Expression__Constant* Expression__Constant__init();
 
+bool Expression__Constant__equals(Expression__Constant* this, Expression__Constant* other);
+
 typedef struct {
     Expression super; /*<Superclass>*/
 
@@ -134,6 +139,9 @@ typedef struct {
 
 Expression__Variable* Expression__Variable__init();
 
+void invalidateResultsType(PointerTable * resultTable, Statement * owner);
+bool areArgumentsTypeChecked(struct Function * function);
+
 typedef struct {
     Expression super; /*<Superclass>*/
 
@@ -188,6 +196,8 @@ typedef struct {
 
     Expression * condition; /*<Condition of the while statement>*/
     Statement * body; /*<Body of the while statement>*/
+    bool isUnrolled; /*<Body was already unrolled, loop isnt expanded again>*/
+    int peelCount; /*<Number of iterations already peeled off the loop>*/
 } StatementWhile;
 
 StatementWhile* StatementWhile__init();
@@ -199,6 +209,8 @@ typedef struct {
     Statement * body; /*<Body of the for statement>*/
     Expression * init; /*<Initialization of the for statement>*/
     Expression * increment; /*<Increment of the for statement>*/
+    bool isUnrolled; /*<Body was already unrolled, loop isnt expanded again>*/
+    int peelCount; /*<Number of iterations already peeled off the loop>*/
 } StatementFor;
 
 StatementFor* StatementFor__init();
@@ -245,10 +257,17 @@ typedef struct Function {
     char ** parameterNames; /*<Names of the parameters>*/
     Table * globalVariables; /*<Global variables of the function>*/
     Statement * body; /*<Body of the function>*/
+    bool isReturnTypeInferred; /*<Return type was refined by interprocedural analysis>*/
+    UnionType inferredReturnType; /*<Refined return type, valid only if isReturnTypeInferred is set>*/
+    UnionType * inferredParameterTypes; /*<Refined types of parameters at the start of the body, NULL if not inferred>*/
 } Function;
 
 Function* Function__init();
 
+UnionType Function__getReturnType(Function *this);
+
+UnionType Function__getParameterType(Function *this, int index);
+
 Function* Function__addParameter(Function *this, Type type, char *name);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,353 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file call_graph.c
+ * @brief Call graph and interprocedural analyses
+ */
+
+#include "call_graph.h"
+
+#define MAX_RETURN_TYPE_ITERATIONS 8
+#define MAX_PARAMETER_TYPE_ITERATIONS 8
+
+typedef struct {
+    CallGraph * graph;
+    int * order; /*<Order in which the function was visited, -1 if not visited yet>*/
+    int * lowLink;
+    bool * isOnStack;
+    int * stack;
+    int stackSize;
+    int visitedCount;
+    int memberCount;
+} SCCBuilder;
+
+int CallGraph__getIndex(CallGraph * this, char * name) {
+    TableItem * item = table_find(this->functionIndices, name);
+    if(item == NULL) return -1;
+    return *(int*)item->data;
+}
+
+void addCallGraphEdges(CallGraph * this, int caller) {
+    Function * function = this->functions[caller];
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(function->body, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_FUNCTION_CALL) continue;
+        int callee = CallGraph__getIndex(this, ((Expression__FunctionCall*)statement)->name);
+        if(callee < 0) continue;
+        bool isKnown = false;
+        for(int j=0; j<this->calleeCounts[caller]; j++) {
+            if(this->callees[caller][j] == callee) {
+                isKnown = true;
+                break;
+            }
+        }
+        if(isKnown) continue;
+        this->callees[caller] = realloc(this->callees[caller], sizeof(int) * (this->calleeCounts[caller] + 1));
+        this->callees[caller][this->calleeCounts[caller]++] = callee;
+    }
+    free(allStatements);
+}
+
+/**
+ * @brief Tarjan's algorithm, components are emitted after all components they call
+ */
+void visitCallGraphFunction(SCCBuilder * builder, int function) {
+    CallGraph * graph = builder->graph;
+    builder->order[function] = builder->visitedCount;
+    builder->lowLink[function] = builder->visitedCount;
+    builder->visitedCount++;
+    builder->stack[builder->stackSize++] = function;
+    builder->isOnStack[function] = true;
+    for(int i=0; i<graph->calleeCounts[function]; i++) {
+        int callee = graph->callees[function][i];
+        if(builder->order[callee] < 0) {
+            visitCallGraphFunction(builder, callee);
+            if(builder->lowLink[callee] < builder->lowLink[function]) builder->lowLink[function] = builder->lowLink[callee];
+        } else if(builder->isOnStack[callee] && builder->order[callee] < builder->lowLink[function]) {
+            builder->lowLink[function] = builder->order[callee];
+        }
+    }
+    if(builder->lowLink[function] != builder->order[function]) return;
+    graph->sccStarts[graph->sccCount++] = builder->memberCount;
+    int member;
+    do {
+        member = builder->stack[--builder->stackSize];
+        builder->isOnStack[member] = false;
+        graph->sccMembers[builder->memberCount++] = member;
+    } while(member != function);
+}
+
+/**
+ * @brief Builds call graph of all user defined functions
+ *
+ * @param functionTable
+ * @return CallGraph*
+ */
+CallGraph * CallGraph__build(Table * functionTable) {
+    CallGraph * this = malloc(sizeof(CallGraph));
+    *this = (CallGraph){0};
+    this->functionIndices = table_init();
+    for(int i = 0; i < TB_SIZE; i++) {
+        TableItem * item = functionTable->tb[i];
+        while(item != NULL) {
+            Function * function = (Function*)item->data;
+            if(function->body != NULL) {
+                this->functions = realloc(this->functions, sizeof(Function*) * (this->functionCount + 1));
+                this->functions[this->functionCount++] = function;
+            }
+            item = item->next;
+        }
+    }
+    this->indices = malloc(sizeof(int) * (this->functionCount + 1));
+    this->calleeCounts = calloc(this->functionCount + 1, sizeof(int));
+    this->callees = calloc(this->functionCount + 1, sizeof(int*));
+    this->sccStarts = malloc(sizeof(int) * (this->functionCount + 1));
+    this->sccMembers = malloc(sizeof(int) * (this->functionCount + 1));
+    for(int i=0; i<this->functionCount; i++) {
+        this->indices[i] = i;
+        table_insert(this->functionIndices, this->functions[i]->name, &this->indices[i]);
+    }
+    for(int i=0; i<this->functionCount; i++) {
+        addCallGraphEdges(this, i);
+    }
+    SCCBuilder builder = {0};
+    builder.graph = this;
+    builder.order = malloc(sizeof(int) * (this->functionCount + 1));
+    builder.lowLink = malloc(sizeof(int) * (this->functionCount + 1));
+    builder.isOnStack = calloc(this->functionCount + 1, sizeof(bool));
+    builder.stack = malloc(sizeof(int) * (this->functionCount + 1));
+    for(int i=0; i<this->functionCount; i++) {
+        builder.order[i] = -1;
+    }
+    for(int i=0; i<this->functionCount; i++) {
+        if(builder.order[i] < 0) visitCallGraphFunction(&builder, i);
+    }
+    this->sccStarts[this->sccCount] = builder.memberCount;
+    free(builder.order);
+    free(builder.lowLink);
+    free(builder.isOnStack);
+    free(builder.stack);
+    return this;
+}
+
+void CallGraph__free(CallGraph * this) {
+    for(int i=0; i<this->functionCount; i++) {
+        free(this->callees[i]);
+    }
+    free(this->callees);
+    free(this->calleeCounts);
+    free(this->sccStarts);
+    free(this->sccMembers);
+    free(this->indices);
+    free(this->functions);
+    table_free(this->functionIndices);
+    free(this);
+}
+
+/**
+ * @brief Removes types which fail type check of the declared type, undefined flag is dropped
+ * @note constant is kept only if it is a literal which passes the check, copies of variables of the caller are meaningless in the callee
+ */
+UnionType restrictToDeclaredType(UnionType type, Type declaredType) {
+    UnionType declared = typeToUnionType(declaredType);
+    type.isInt &= declared.isInt;
+    type.isFloat &= declared.isFloat;
+    type.isString &= declared.isString;
+    type.isBool &= declared.isBool;
+    type.isNull &= declared.isNull;
+    type.isUndefined = false;
+    if(type.constant != NULL) {
+        UnionType constantType = type.constant->expressionType == EXPRESSION_CONSTANT ? typeToUnionType(((Expression__Constant*)type.constant)->type) : (UnionType){0};
+        bool isChecked = (constantType.isInt && type.isInt) || (constantType.isFloat && type.isFloat) || (constantType.isString && type.isString) || (constantType.isBool && type.isBool) || (constantType.isNull && type.isNull);
+        if(!isChecked) type.constant = NULL;
+    }
+    return type;
+}
+
+/**
+ * @brief Sets type of the parameter at the start of the function body
+ * @note constant is copied, argument it comes from can be replaced in the caller
+ */
+void setInferredParameterType(Function * function, int index, UnionType type) {
+    if(function->inferredParameterTypes == NULL) {
+        function->inferredParameterTypes = malloc(sizeof(UnionType) * (function->arity + 1));
+        for(int i=0; i<function->arity; i++) {
+            function->inferredParameterTypes[i] = typeToUnionType(function->parameterTypes[i]);
+        }
+    }
+    if(type.constant != NULL) type.constant = (Expression*)type.constant->super.duplicate((Statement*)type.constant);
+    function->inferredParameterTypes[index] = type;
+}
+
+bool areUnionTypesEqual(UnionType a, UnionType b) {
+    if(a.isInt != b.isInt || a.isFloat != b.isFloat || a.isString != b.isString || a.isBool != b.isBool || a.isNull != b.isNull || a.isUndefined != b.isUndefined) return false;
+    if(a.constant == NULL || b.constant == NULL) return a.constant == b.constant;
+    return Expression__Constant__equals((Expression__Constant*)a.constant, (Expression__Constant*)b.constant);
+}
+
+/**
+ * @brief Joins types of all returned values, assumes that called functions return their current return types
+ * @note values which dont match declared type end with runtime error, so they are never returned
+ */
+UnionType computeFunctionReturnType(Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    UnionType declared = typeToUnionType(function->returnType);
+    UnionType result = {0};
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(function->body, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_RETURN) continue;
+        Expression * expression = ((StatementReturn*)statement)->expression;
+        UnionType type = {.isNull = true};
+        if(expression != NULL) type = expression->getType(expression, functionTable, program, function, resultTable);
+        result = orUnionType(result, type);
+    }
+    free(allStatements);
+    result.isInt &= declared.isInt;
+    result.isFloat &= declared.isFloat;
+    result.isString &= declared.isString;
+    result.isBool &= declared.isBool;
+    result.isNull &= declared.isNull;
+    result.isUndefined = false;
+    if(!result.isInt && !result.isFloat && !result.isString && !result.isBool && !result.isNull) return declared;
+    if(result.constant != NULL) {
+        Expression__Constant * constant = (Expression__Constant*)result.constant;
+        // only real constants are valid outside of the function, variables would be resolved in wrong scope
+        if(result.constant->expressionType != EXPRESSION_CONSTANT ||
+            !((constant->type.type == TYPE_INT && result.isInt) || (constant->type.type == TYPE_FLOAT && result.isFloat) ||
+              (constant->type.type == TYPE_STRING && result.isString) || (constant->type.type == TYPE_BOOL && result.isBool) ||
+              (constant->type.type == TYPE_NULL && result.isNull))) {
+            result.constant = NULL;
+        } else {
+            result.constant = (Expression*)constant->super.super.duplicate((Statement*)constant);
+        }
+    }
+    return result;
+}
+
+void invalidateFunctionResultsTypes(CallGraph * graph, int from, int to, PointerTable * resultTable) {
+    for(int i=from; i<to; i++) {
+        invalidateResultsType(resultTable, (Statement*)graph->functions[graph->sccMembers[i]]);
+    }
+}
+
+/**
+ * @brief Refines return types of user functions from their return statements
+ * @note components of the call graph are processed bottom up, recursive functions are iterated starting from the previous (sound) type
+ *
+ * @return true if any return type changed
+ */
+bool inferFunctionReturnTypes(Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    CallGraph * graph = CallGraph__build(functionTable);
+    bool changedAny = false;
+    for(int scc=0; scc<graph->sccCount; scc++) {
+        int from = graph->sccStarts[scc];
+        int to = graph->sccStarts[scc + 1];
+        // types of called functions changed, cached variable types can depend on them
+        if(changedAny) invalidateFunctionResultsTypes(graph, from, to, resultTable);
+        bool changed = true;
+        for(int iteration=0; changed && iteration<MAX_RETURN_TYPE_ITERATIONS; iteration++) {
+            changed = false;
+            for(int i=from; i<to; i++) {
+                Function * function = graph->functions[graph->sccMembers[i]];
+                if(function->returnType.type == TYPE_VOID) continue;
+                UnionType type = computeFunctionReturnType(function, functionTable, program, resultTable);
+                if(areUnionTypesEqual(type, Function__getReturnType(function))) continue;
+                function->inferredReturnType = type;
+                function->isReturnTypeInferred = true;
+                changed = true;
+            }
+            if(changed) invalidateFunctionResultsTypes(graph, from, to, resultTable);
+            changedAny |= changed;
+        }
+    }
+    if(changedAny) {
+        invalidateFunctionResultsTypes(graph, 0, graph->sccStarts[graph->sccCount], resultTable);
+        invalidateResultsType(resultTable, (Statement*)program);
+    }
+    CallGraph__free(graph);
+    return changedAny;
+}
+
+/**
+ * @brief Joins types of arguments of all calls of user functions in the body
+ *
+ * @param graph
+ * @param body body of function or main program
+ * @param owner function owning the body, NULL for main program
+ * @param argumentTypes joined types of arguments, indexed by function and parameter
+ * @param isCalled set for every called function
+ */
+void collectArgumentTypes(CallGraph * graph, Statement * body, Function * owner, Table * functionTable, StatementList * program, PointerTable * resultTable, UnionType ** argumentTypes, bool * isCalled) {
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(body, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_FUNCTION_CALL) continue;
+        Expression__FunctionCall * call = (Expression__FunctionCall*)statement;
+        int callee = CallGraph__getIndex(graph, call->name);
+        if(callee < 0 || call->arity != graph->functions[callee]->arity) continue;
+        isCalled[callee] = true;
+        for(int j=0; j<call->arity; j++) {
+            UnionType type = call->arguments[j]->getType(call->arguments[j], functionTable, program, owner, resultTable);
+            argumentTypes[callee][j] = orUnionType(argumentTypes[callee][j], type);
+        }
+    }
+    free(allStatements);
+}
+
+/**
+ * @brief Refines types of parameters from arguments of all calls
+ * @note argument which doesnt match declared type ends with runtime error, so parameter holds only values of both types,
+ * types are refined repeatedly starting from the declared (sound) types
+ *
+ * @return true if any parameter type changed
+ */
+bool inferFunctionParameterTypes(Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    CallGraph * graph = CallGraph__build(functionTable);
+    UnionType ** argumentTypes = malloc(sizeof(UnionType*) * (graph->functionCount + 1));
+    bool * isCalled = malloc(sizeof(bool) * (graph->functionCount + 1));
+    for(int i=0; i<graph->functionCount; i++) {
+        argumentTypes[i] = malloc(sizeof(UnionType) * (graph->functions[i]->arity + 1));
+    }
+    bool changedAny = false;
+    bool changed = true;
+    for(int iteration=0; changed && iteration<MAX_PARAMETER_TYPE_ITERATIONS; iteration++) {
+        changed = false;
+        for(int i=0; i<graph->functionCount; i++) {
+            isCalled[i] = false;
+            for(int j=0; j<graph->functions[i]->arity; j++) {
+                argumentTypes[i][j] = (UnionType){0};
+            }
+        }
+        collectArgumentTypes(graph, (Statement*)program, NULL, functionTable, program, resultTable, argumentTypes, isCalled);
+        for(int i=0; i<graph->functionCount; i++) {
+            collectArgumentTypes(graph, graph->functions[i]->body, graph->functions[i], functionTable, program, resultTable, argumentTypes, isCalled);
+        }
+        for(int i=0; i<graph->functionCount; i++) {
+            Function * function = graph->functions[i];
+            if(!isCalled[i] || function->arity == 0) continue;
+            bool isFunctionChanged = false;
+            for(int j=0; j<function->arity; j++) {
+                UnionType type = restrictToDeclaredType(argumentTypes[i][j], function->parameterTypes[j]);
+                // every call fails the type check, body is never executed
+                if(!type.isInt && !type.isFloat && !type.isString && !type.isBool && !type.isNull) type = typeToUnionType(function->parameterTypes[j]);
+                if(areUnionTypesEqual(type, Function__getParameterType(function, j))) continue;
+                setInferredParameterType(function, j, type);
+                isFunctionChanged = true;
+            }
+            if(!isFunctionChanged) continue;
+            invalidateResultsType(resultTable, (Statement*)function);
+            changed = true;
+            changedAny = true;
+        }
+    }
+    for(int i=0; i<graph->functionCount; i++) {
+        free(argumentTypes[i]);
+    }
+    free(argumentTypes);
+    free(isCalled);
+    CallGraph__free(graph);
+    return changedAny;
+}
@@ -0,0 +1,40 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file call_graph.h
+ * @brief Header file for the call graph and interprocedural analyses
+ */
+
+#ifndef __CALL_GRAPH_H__
+#define __CALL_GRAPH_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+#include "pointer_hashtable.h"
+
+/**
+ * @brief Calls between user defined functions, builtins arent part of the graph
+ */
+typedef struct {
+    int functionCount;
+    Function ** functions;
+    Table * functionIndices; /*<Function name -> index into functions>*/
+    int * indices; /*<Storage of the indices referenced from functionIndices>*/
+    int * calleeCounts;
+    int ** callees; /*<Indices of functions called from each function, without duplicates>*/
+    int sccCount;
+    int * sccStarts; /*<Members of scc i are sccMembers[sccStarts[i]] .. sccMembers[sccStarts[i+1]-1]>*/
+    int * sccMembers; /*<Strongly connected components ordered so that callees come before callers>*/
+} CallGraph;
+
+CallGraph * CallGraph__build(Table * functionTable);
+int CallGraph__getIndex(CallGraph * this, char * name);
+void CallGraph__free(CallGraph * this);
+
+UnionType restrictToDeclaredType(UnionType type, Type declaredType);
+void setInferredParameterType(Function * function, int index, UnionType type);
+bool areUnionTypesEqual(UnionType a, UnionType b);
+bool inferFunctionReturnTypes(Table * functionTable, StatementList * program, PointerTable * resultTable);
+bool inferFunctionParameterTypes(Table * functionTable, StatementList * program, PointerTable * resultTable);
+
+#endif // __CALL_GRAPH_H__
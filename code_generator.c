@@ -11,6 +11,10 @@
 #include "string_builder.h"
 #include "optimizer.h"
 
+#define LOOP_ROTATION_CONDITION_SIZE 30 /*<Maximum size of loop condition which is generated twice when the loop is rotated>*/
+#define DECISION_TREE_MIN_CASES 8 /*<Minimum number of if/elseif comparisons of one variable lowered into binary search>*/
+#define DECISION_TREE_LEAF_SIZE 6 /*<Maximum number of cases compared one by one in a leaf of the binary search>*/
+
 /**
  * @brief Join two strings together
  * 
@@ -82,6 +86,14 @@ typedef struct {
     StringArray * continueLabels;
 } Context;
 
+/**
+ * @brief case of if/elseif chain comparing one variable with int constants
+ */
+typedef struct {
+    long long value;
+    char * label; /*<Label of the body of the case>*/
+} ChainCase;
+
 /**
  * @brief Create new string array
  * 
@@ -1078,6 +1090,31 @@ void freeArguments(Symb * arguments, int argumentCount, Context ctx) {
     }
 }
 
+/**
+ * @brief Checks if argument has to be passed to the parameter
+ * @note parameter which gets the same constant from every call is replaced by the constant in the body, so it doesnt have to be defined
+ * 
+ * @param function called user function
+ * @param index index of the parameter
+ * @return true if the parameter is read or assigned in the body
+ */
+bool isParameterPassed(Function * function, int index) {
+    if(function->inferredParameterTypes == NULL || function->inferredParameterTypes[index].constant == NULL) return true;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(function->body, &statementCount);
+    bool isPassed = false;
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement != NULL && statement->statementType == STATEMENT_EXPRESSION && ((Expression*)statement)->expressionType == EXPRESSION_VARIABLE &&
+            strcmp(((Expression__Variable*)statement)->name, function->parameterNames[index]) == 0) {
+            isPassed = true;
+            break;
+        }
+    }
+    free(allStatements);
+    return isPassed;
+}
+
 /**
  * @brief Generate code for a function call
  * 
@@ -1242,6 +1279,7 @@ Symb generateFunctionCall(Expression__FunctionCall * expression, Context ctx, Va
     }
     emit_CREATEFRAME();
     for(int i=0; i<expression->arity; i++) {
+        if(!isParameterPassed(function, i)) continue;
         emit_DEFVAR((Var){.frameType = TF, .name = function->parameterNames[i]});
         emit_MOVE((Var){.frameType = TF, .name = function->parameterNames[i]}, arguments[i]);
     }
@@ -1397,7 +1435,7 @@ Symb generateBinaryOperator(Expression__BinaryOperator * expression, Context ctx
     Symb left = generateExpression(expression->lSide, ctx, false, NULL);
     left = saveTempSymb(left, ctx);
     Symb right;
-    if(expression->operator != TOKEN_AND && expression->operator != TOKEN_OR) {
+    if(expression->operator != TOKEN_AND && expression->operator != TOKEN_OR && expression->operator != TOKEN_NULL_COALESCING) {
         right = generateExpression(expression->rSide, ctx, false, NULL);
     }
     Var outVar;
@@ -1553,11 +1591,21 @@ Symb generateBinaryOperator(Expression__BinaryOperator * expression, Context ctx
             //Type typeR = unionTypeToType(uTypeR);
             size_t operatorNullCoalescingId = getNextCodeGenUID();
             char* null_coalescing_done = create_label("null_coalescing_done&", operatorNullCoalescingId);
-            emit_MOVE(outVar, right);
-            emit_JUMPIFEQ(null_coalescing_done, left, (Symb){.type=Type_null});
+            char* null_coalescing_right = create_label("null_coalescing_right&", operatorNullCoalescingId);
+            // right side is evaluated only if the left side is null
+            emit_JUMPIFEQ(null_coalescing_right, left, (Symb){.type=Type_null});
             emit_MOVE(outVar, left);
+            emit_JUMP(null_coalescing_done);
+            emit_LABEL(null_coalescing_right);
+            freeTemporarySymbol(left, ctx);
+            right = generateExpression(expression->rSide, ctx, false, NULL);
+            if(right.type != Type_variable || right.value.v.frameType != outVar.frameType || strcmp(right.value.v.name, outVar.name) != 0) {
+                emit_MOVE(outVar, right);
+            }
+            freeTemporarySymbol(right, ctx);
             emit_LABEL(null_coalescing_done);
             free(null_coalescing_done);
+            free(null_coalescing_right);
             return outSymb;
             break;
         }
@@ -1601,53 +1649,89 @@ Symb generateUnaryOperator(Expression__PrefixOperator * expression, Context ctx,
     return outSymb;
 }
 
+/**
+ * @brief Generates increment or decrement of variable whose value has the given type
+ * 
+ * @param var Variable to change
+ * @param type Type of its value
+ * @param operator TOKEN_INCREMENT or TOKEN_DECREMENT
+ */
+void generateIncrementStep(Var var, StorageType type, TokenType operator) {
+    Symb symb = (Symb){.type = Type_variable, .value.v = var};
+    // bool doesnt change
+    if(type == Type_bool) return;
+    if(type == Type_null) {
+        // increment of null is 1, decrement keeps null
+        if(operator == TOKEN_INCREMENT) emit_MOVE(var, (Symb){.type = Type_int, .value.i = 1});
+        return;
+    }
+    Symb one = type == Type_float ? (Symb){.type = Type_float, .value.f = 1} : (Symb){.type = Type_int, .value.i = 1};
+    if(operator == TOKEN_INCREMENT) {
+        emit_ADD(var, symb, one);
+    } else {
+        emit_SUB(var, symb, one);
+    }
+}
+
 /**
  * @brief Generates postfix operator code
+ * @note value of the operand is changed in place, its runtime type is checked only if it can be more than one of int, float, bool and null
  * 
  * @param expression Expression to generate
  * @param ctx Context
  * @return Symb
  */
 Symb generatePostfixOperator(Expression__PostfixOperator * expression, Context ctx, bool throwaway, Var * outVarAlt) {
+    if(expression->operator != TOKEN_INCREMENT && expression->operator != TOKEN_DECREMENT) {
+        fprintf(stderr, "Unknown operator found while generating output code\n");
+        exit(99);
+    }
     Symb symb = generateExpression(expression->operand, ctx, false, NULL);
-    Symb symbType = generateSymbType(expression->operand, symb, ctx); 
+    // in $x = $x++ the old value overwrites the incremented one, so nothing changes
+    if(outVarAlt != NULL && symb.type == Type_variable && outVarAlt->frameType == symb.value.v.frameType && strcmp(outVarAlt->name, symb.value.v.name) == 0) {
+        return symb;
+    }
     Var outVar;
-    //size_t castUID = getNextCodeGenUID();
     if(outVarAlt == NULL) {
         outVar = generateTemporaryVariable(ctx);
     } else {
         outVar = *outVarAlt;
     }
     Symb outSymb = (Symb){.type = Type_variable, .value.v = outVar};
-    Symb one = (Symb){.type = Type_int, .value.i = 1};
+    if(symb.type != Type_variable) return outSymb;
+    emit_MOVE(outVar, symb);
 
     UnionType unionTypeOp = expression->operand->getType(expression->operand, ctx.functionTable, ctx.program, ctx.currentFunction, ctx.resultTable);
-    if(unionTypeOp.isFloat) {
-        symb = generateCastToFloat(symb, expression->operand, &ctx, &symbType, false);             
-        one = (Symb){.type = Type_float, .value.f = 1};
-    } else if(unionTypeOp.isInt) {
-        symb = generateCastToInt(symb, expression->operand, &ctx, &symbType, false);             
-    }
-    switch(expression->operator) {
-        case TOKEN_INCREMENT: {
-            if(symb.type == Type_variable) {
-                emit_MOVE(outVar, symb);
-                emit_ADD(symb.value.v, symb, one);
-            }
-            break;
-        }
-        case TOKEN_DECREMENT: {
-            if(symb.type == Type_variable) {
-                emit_MOVE(outVar, symb);
-                emit_SUB(symb.value.v, symb, one);
-            }
+    // strings arent supported, they fail in the int arithmetic
+    bool isOther = unionTypeOp.isString || unionTypeOp.isUndefined || !(unionTypeOp.isInt || unionTypeOp.isFloat || unionTypeOp.isNull || unionTypeOp.isBool);
+    StorageType types[4];
+    int typeCount = 0;
+    if(unionTypeOp.isFloat) types[typeCount++] = Type_float;
+    if(unionTypeOp.isNull) types[typeCount++] = Type_null;
+    if(unionTypeOp.isBool) types[typeCount++] = Type_bool;
+    if(unionTypeOp.isInt || isOther) types[typeCount++] = Type_int;
+    if(typeCount == 1) {
+        generateIncrementStep(symb.value.v, types[0], expression->operator);
+        return outSymb;
+    }
+    Symb symbType = generateSymbType(expression->operand, symb, ctx);
+    char * increment_done = create_label("increment_done&", getNextCodeGenUID());
+    for(int i=0; i<typeCount; i++) {
+        if(i == typeCount - 1) {
+            generateIncrementStep(symb.value.v, types[i], expression->operator);
             break;
         }
-        default:
-            fprintf(stderr, "Unknown operator found while generating output code\n");
-            exit(99);
-    }
-    freeTemporarySymbol(symb, ctx);
+        char * increment_next = create_label("increment_next&", getNextCodeGenUID());
+        char * typeName = types[i] == Type_float ? "float" : types[i] == Type_null ? "nil" : types[i] == Type_bool ? "bool" : "int";
+        emit_JUMPIFNEQ(increment_next, symbType, (Symb){.type = Type_string, .value.s = typeName});
+        generateIncrementStep(symb.value.v, types[i], expression->operator);
+        emit_JUMP(increment_done);
+        emit_LABEL(increment_next);
+        free(increment_next);
+    }
+    emit_LABEL(increment_done);
+    free(increment_done);
+    freeTemporarySymbol(symbType, ctx);
     return outSymb;
 }
 
@@ -1698,7 +1782,85 @@ void generateStatementList(StatementList* statementList, Context ctx) {
     }
 }
 
+/**
+ * @brief Generates jump to the label taken when the condition has the given value
+ * @note &&, ||, ! and ?? are lowered directly into jumps, so their bool results arent stored,
+ * relational operators are fused with the jump
+ * 
+ * @param expression condition
+ * @param ctx
+ * @param label
+ * @param valueToJump value of the condition for which the jump is taken
+ */
 void generateConditionJump(Expression * expression, Context ctx, char * label, bool valueToJump) {
+    if(expression->expressionType == EXPRESSION_CONSTANT) {
+        Expression__Constant * constant = performConstantCastCondition((Expression__Constant*)expression);
+        if(constant->value.boolean == valueToJump) {
+            emit_JUMP(label);
+        }
+        return;
+    }
+    if(expression->expressionType == EXPRESSION_PREFIX_OPERATOR && ((Expression__PrefixOperator*)expression)->operator == TOKEN_NEGATE) {
+        generateConditionJump(((Expression__PrefixOperator*)expression)->rSide, ctx, label, !valueToJump);
+        return;
+    }
+    if(expression->expressionType == EXPRESSION_BINARY_OPERATOR) {
+        Expression__BinaryOperator * binaryOperator = (Expression__BinaryOperator*)expression;
+        if(binaryOperator->operator == TOKEN_AND || binaryOperator->operator == TOKEN_OR) {
+            // left side decides the result when it is false for && or true for ||
+            bool shortCircuitValue = binaryOperator->operator == TOKEN_OR;
+            if(valueToJump == shortCircuitValue) {
+                generateConditionJump(binaryOperator->lSide, ctx, label, valueToJump);
+                generateConditionJump(binaryOperator->rSide, ctx, label, valueToJump);
+            } else {
+                char* conditionSkip = create_label("condition_skip&", getNextCodeGenUID());
+                generateConditionJump(binaryOperator->lSide, ctx, conditionSkip, shortCircuitValue);
+                generateConditionJump(binaryOperator->rSide, ctx, label, valueToJump);
+                emit_LABEL(conditionSkip);
+                free(conditionSkip);
+            }
+            return;
+        }
+        if(binaryOperator->operator == TOKEN_LESS || binaryOperator->operator == TOKEN_GREATER || binaryOperator->operator == TOKEN_LESS_OR_EQUALS || binaryOperator->operator == TOKEN_GREATER_OR_EQUALS) {
+            // <= and >= are negated > and <, the negation is done by the jump instead of NOT
+            Symb left = generateExpression(binaryOperator->lSide, ctx, false, NULL);
+            left = saveTempSymb(left, ctx);
+            Symb right = generateExpression(binaryOperator->rSide, ctx, false, NULL);
+            relationalOperatorCast(left, right, binaryOperator->lSide, binaryOperator->rSide, &left, &right, &ctx);
+            Var result = generateTemporaryVariable(ctx);
+            bool isNegated = binaryOperator->operator == TOKEN_LESS_OR_EQUALS || binaryOperator->operator == TOKEN_GREATER_OR_EQUALS;
+            if(binaryOperator->operator == TOKEN_LESS || binaryOperator->operator == TOKEN_GREATER_OR_EQUALS) {
+                emit_LT(result, left, right);
+            } else {
+                emit_GT(result, left, right);
+            }
+            emit_JUMPIFEQ(label, (Symb){.type=Type_variable, .value.v=result}, (Symb){.type=Type_bool, .value.b=isNegated ? !valueToJump : valueToJump});
+            freeTemporaryVariable(result, ctx);
+            freeTemporarySymbol(left, ctx);
+            freeTemporarySymbol(right, ctx);
+            return;
+        }
+        if(binaryOperator->operator == TOKEN_NULL_COALESCING) {
+            size_t conditionUID = getNextCodeGenUID();
+            char* conditionRight = create_label("condition_right&", conditionUID);
+            char* conditionEnd = create_label("condition_end&", conditionUID);
+            Symb left = generateExpression(binaryOperator->lSide, ctx, false, NULL);
+            emit_JUMPIFEQ(conditionRight, left, (Symb){.type=Type_null});
+            Symb leftBool = generateCastToBool(binaryOperator->lSide, left, ctx, true);
+            emit_JUMPIFEQ(label, leftBool, (Symb){.type=Type_bool, .value.b=valueToJump});
+            if(leftBool.type != Type_variable || left.type != Type_variable || leftBool.value.v.frameType != left.value.v.frameType || strcmp(leftBool.value.v.name, left.value.v.name) != 0) {
+                freeTemporarySymbol(leftBool, ctx);
+            }
+            freeTemporarySymbol(left, ctx);
+            emit_JUMP(conditionEnd);
+            emit_LABEL(conditionRight);
+            generateConditionJump(binaryOperator->rSide, ctx, label, valueToJump);
+            emit_LABEL(conditionEnd);
+            free(conditionRight);
+            free(conditionEnd);
+            return;
+        }
+    }
     if(expression->expressionType == EXPRESSION_BINARY_OPERATOR) {
         Expression__BinaryOperator * binaryOperator = (Expression__BinaryOperator*)expression;
         Type typeL = unionTypeToType(binaryOperator->lSide->getType(binaryOperator->lSide, ctx.functionTable, ctx.program, ctx.currentFunction, ctx.resultTable));
@@ -1734,6 +1896,138 @@ void generateConditionJump(Expression * expression, Context ctx, char * label, b
     freeTemporarySymbol(condition, ctx);
 }
 
+/**
+ * @brief Gets variable compared by === with int constant in the condition
+ *
+ * @param condition
+ * @param value compared constant
+ * @return compared variable or NULL if the condition isnt such comparison
+ */
+Expression__Variable * getChainComparison(Expression * condition, long long * value) {
+    if(condition->expressionType != EXPRESSION_BINARY_OPERATOR || ((Expression__BinaryOperator*)condition)->operator != TOKEN_EQUALS) return NULL;
+    Expression * variable = ((Expression__BinaryOperator*)condition)->lSide;
+    Expression * constant = ((Expression__BinaryOperator*)condition)->rSide;
+    if(variable->expressionType == EXPRESSION_CONSTANT) {
+        variable = constant;
+        constant = ((Expression__BinaryOperator*)condition)->lSide;
+    }
+    if(variable->expressionType != EXPRESSION_VARIABLE || constant->expressionType != EXPRESSION_CONSTANT || ((Expression__Constant*)constant)->type.type != TYPE_INT) return NULL;
+    *value = ((Expression__Constant*)constant)->value.integer;
+    return (Expression__Variable*)variable;
+}
+
+/**
+ * @brief Gets if statement which is the only statement of the else branch
+ */
+StatementIf * getChainNext(StatementIf * statement) {
+    Statement * elseBody = statement->elseBody;
+    if(elseBody != NULL && elseBody->statementType == STATEMENT_LIST && ((StatementList*)elseBody)->listSize == 1) elseBody = ((StatementList*)elseBody)->statements[0];
+    if(elseBody == NULL || elseBody->statementType != STATEMENT_IF) return NULL;
+    return (StatementIf*)elseBody;
+}
+
+int compareChainCases(const void * a, const void * b) {
+    long long valueA = ((ChainCase*)a)->value;
+    long long valueB = ((ChainCase*)b)->value;
+    return (valueA > valueB) - (valueA < valueB);
+}
+
+/**
+ * @brief Generates binary search of the sorted cases, leaves compare the cases one by one
+ *
+ * @param cases sorted cases
+ * @param count
+ * @param variable compared int value
+ * @param defaultLabel label jumped to if no case matches
+ * @param ctx
+ */
+void generateDecisionTree(ChainCase * cases, int count, Symb variable, char * defaultLabel, Context ctx) {
+    if(count <= DECISION_TREE_LEAF_SIZE) {
+        for(int i=0; i<count; i++) {
+            emit_JUMPIFEQ(cases[i].label, variable, (Symb){.type=Type_int, .value.i=cases[i].value});
+        }
+        emit_JUMP(defaultLabel);
+        return;
+    }
+    int middle = count / 2;
+    char* upperHalf = create_label("decision_upper&", getNextCodeGenUID());
+    Var isLower = generateTemporaryVariable(ctx);
+    emit_LT(isLower, variable, (Symb){.type=Type_int, .value.i=cases[middle].value});
+    emit_JUMPIFEQ(upperHalf, (Symb){.type=Type_variable, .value.v=isLower}, (Symb){.type=Type_bool, .value.b=false});
+    freeTemporaryVariable(isLower, ctx);
+    generateDecisionTree(cases, middle, variable, defaultLabel, ctx);
+    emit_LABEL(upperHalf);
+    generateDecisionTree(cases + middle, count - middle, variable, defaultLabel, ctx);
+    free(upperHalf);
+}
+
+/**
+ * @brief Generates if/elseif chain comparing one variable with int constants as a binary search
+ * @note type of the variable is checked once in front of the search
+ *
+ * @return false if the statement isnt long enough chain
+ */
+bool generateIfChain(StatementIf * statement, Context ctx) {
+    long long value;
+    Expression__Variable * variable = getChainComparison(statement->condition, &value);
+    if(variable == NULL) return false;
+    int chainLength = 0;
+    StatementIf ** chain = NULL;
+    for(StatementIf * chainIf = statement; chainIf != NULL; chainIf = getChainNext(chainIf)) {
+        Expression__Variable * compared = getChainComparison(chainIf->condition, &value);
+        if(compared == NULL || strcmp(compared->name, variable->name) != 0) break;
+        chain = realloc(chain, sizeof(StatementIf*) * (chainLength + 1));
+        chain[chainLength++] = chainIf;
+    }
+    if(chainLength < DECISION_TREE_MIN_CASES) {
+        free(chain);
+        return false;
+    }
+    size_t chainUID = getNextCodeGenUID();
+    char* chainDefault = create_label("chainDefault&", chainUID);
+    char* chainEnd = create_label("chainEnd&", chainUID);
+    Symb symb = generateExpression((Expression*)variable, ctx, false, NULL);
+    Symb symbType = generateSymbType((Expression*)variable, symb, ctx);
+    if(symbType.type == Type_variable || strcmp(symbType.value.s, "int") != 0) {
+        emit_JUMPIFNEQ(chainDefault, symbType, (Symb){.type=Type_string, .value.s="int"});
+    }
+    freeTemporarySymbol(symbType, ctx);
+    // later comparisons with the same value are never true, so their bodies dont get a case
+    ChainCase * cases = malloc(sizeof(ChainCase) * chainLength);
+    char ** labels = malloc(sizeof(char*) * chainLength);
+    int caseCount = 0;
+    for(int i=0; i<chainLength; i++) {
+        getChainComparison(chain[i]->condition, &value);
+        labels[i] = NULL;
+        bool isDuplicate = false;
+        for(int j=0; j<caseCount; j++) {
+            if(cases[j].value == value) isDuplicate = true;
+        }
+        if(isDuplicate) continue;
+        labels[i] = create_label("chainCase&", getNextCodeGenUID());
+        cases[caseCount++] = (ChainCase){.value = value, .label = labels[i]};
+    }
+    qsort(cases, caseCount, sizeof(ChainCase), compareChainCases);
+    generateDecisionTree(cases, caseCount, symb, chainDefault, ctx);
+    freeTemporarySymbol(symb, ctx);
+    for(int i=0; i<chainLength; i++) {
+        if(labels[i] == NULL) continue;
+        emit_LABEL(labels[i]);
+        generateStatement(chain[i]->ifBody, ctx);
+        emit_JUMP(chainEnd);
+        free(labels[i]);
+    }
+    emit_LABEL(chainDefault);
+    if(chain[chainLength - 1]->elseBody != NULL) generateStatement(chain[chainLength - 1]->elseBody, ctx);
+    emit_LABEL(chainEnd);
+    free(cases);
+    free(labels);
+    free(chain);
+    free(chainDefault);
+    free(chainEnd);
+    return true;
+}
+
 /**
  * @brief Generates code for if statement
  * 
@@ -1741,6 +2035,7 @@ void generateConditionJump(Expression * expression, Context ctx, char * label, b
  * @param ctx 
  */
 void generateIf(StatementIf * statement, Context ctx) {
+    if(generateIfChain(statement, ctx)) return;
     size_t ifUID = getNextCodeGenUID();
     char* ifElse = create_label("ifElse&", ifUID);
     char* ifEnd = create_label("ifEnd&", ifUID);
@@ -1757,8 +2052,17 @@ void generateIf(StatementIf * statement, Context ctx) {
     free(ifEnd);
 }
 
+/**
+ * @brief Checks if the loop condition is small enough to be generated both in front of the loop and at its bottom
+ */
+bool isLoopRotated(Expression * condition) {
+    return condition == NULL || getStatementSize((Statement*)condition) <= LOOP_ROTATION_CONDITION_SIZE;
+}
+
 /**
  * @brief Generates code for while statement
+ * @note loop is rotated, condition is tested once in front of the loop and then at the bottom of the body,
+ * so an iteration doesnt need the jump back to the condition
  * 
  * @param statement 
  * @param ctx 
@@ -1767,23 +2071,37 @@ void generateWhile(StatementWhile * statement, Context ctx) {
     size_t whileUID = getNextCodeGenUID();
     char* whileStart = create_label("whileStart&", whileUID);
     char* whileEnd = create_label("whileEnd&", whileUID);
+    char* whileContinue = create_label("whileContinue&", whileUID);
+    bool isRotated = isLoopRotated(statement->condition);
 
+    if(isRotated) {
+        generateConditionJump(statement->condition, ctx, whileEnd, false);
+    }
     emit_LABEL(whileStart);
-    generateConditionJump(statement->condition, ctx, whileEnd, false);
+    if(!isRotated) {
+        generateConditionJump(statement->condition, ctx, whileEnd, false);
+    }
     stringArrayAdd(ctx.breakLabels, whileEnd);
-    stringArrayAdd(ctx.continueLabels, whileStart);
+    stringArrayAdd(ctx.continueLabels, isRotated ? whileContinue : whileStart);
     generateStatement(statement->body, ctx);
-    emit_JUMP(whileStart);
+    if(isRotated) {
+        emit_LABEL(whileContinue);
+        generateConditionJump(statement->condition, ctx, whileStart, true);
+    } else {
+        emit_JUMP(whileStart);
+    }
     emit_LABEL(whileEnd);
     stringArrayRemove(ctx.breakLabels);
     stringArrayRemove(ctx.continueLabels);
 
     free(whileStart);
     free(whileEnd);
+    free(whileContinue);
 }
 
 /**
  * @brief Generates code for for statement
+ * @note loop is rotated the same way as while loop
  * 
  * @param statement 
  * @param ctx 
@@ -1793,15 +2111,20 @@ void generateFor(StatementFor * statement, Context ctx) {
     char* forStart = create_label("forStart&", forUID);
     char* forEnd = create_label("forEnd&", forUID);
     char* forContinue = create_label("forContinue&", forUID);
+    bool isRotated = isLoopRotated(statement->condition);
 
     if (statement->init != NULL) generateExpression(statement->init, ctx, true, NULL);
 
+    if (isRotated && statement->condition != NULL) {
+        generateConditionJump(statement->condition, ctx, forEnd, false);
+    }
+
     emit_LABEL(forStart);
 
-    if (statement->condition != NULL) {
-        generateConditionJump(statement->condition, ctx, forEnd, false);
-    }else {
+    if (statement->condition == NULL) {
         emit_COMMENT("No condition for for statement");
+    } else if (!isRotated) {
+        generateConditionJump(statement->condition, ctx, forEnd, false);
     }
 
     stringArrayAdd(ctx.breakLabels, forEnd);
@@ -1812,7 +2135,11 @@ void generateFor(StatementFor * statement, Context ctx) {
     emit_LABEL(forContinue);
     if (statement->increment != NULL) generateExpression(statement->increment, ctx, false, NULL);
 
-    emit_JUMP(forStart);
+    if (isRotated && statement->condition != NULL) {
+        generateConditionJump(statement->condition, ctx, forStart, true);
+    } else {
+        emit_JUMP(forStart);
+    }
     emit_LABEL(forEnd);
 
     stringArrayRemove (ctx.breakLabels);
@@ -1960,6 +2287,7 @@ void generateFunction(Function* function, Table * functionTable, PointerTable *
     if(function->body == NULL) return;
     Table* localTable = table_init();
     char * functionLabel = join_strings("function&", function->name);
+    emit_function_start();
     emit_instruction_start();
     emit_LABEL(functionLabel);
     emit_instruction_end();
@@ -2144,4 +2472,5 @@ void generateCode(StatementList * program, Table * functionTable) {
             item = item->next;
         }
     }
+    emit_close();
 }
\ No newline at end of file
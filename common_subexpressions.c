@@ -0,0 +1,462 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file common_subexpressions.c
+ * @brief Common subexpression elimination of pure expressions
+ */
+
+#include "common_subexpressions.h"
+#include "loop_invariant_motion.h"
+#include "induction_variables.h"
+#include "string_builder.h"
+
+typedef struct {
+    char * key; /*<Serialized expression, equal expressions have equal value while their variables arent assigned>*/
+    char ** variables; /*<Variables read by the expression>*/
+    int variableCount;
+    char * holder; /*<Variable holding the value, NULL until the value is needed again>*/
+    Expression ** slot; /*<First computation of the value>*/
+    Statement * statement; /*<Statement containing the first computation, its value is saved right before it>*/
+} AvailableExpression;
+
+typedef struct {
+    AvailableExpression ** expressions; /*<Expressions computed on every path to the current point>*/
+    int count;
+} AvailableExpressions;
+
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    Function * function;
+    PointerTable * resultTable;
+    PointerTable * savedValues; /*<Assignments of saved values, StatementList placed before the statement used as key>*/
+    AvailableExpression ** allExpressions; /*<All created expressions, shared by the available sets*/
+    int allExpressionCount;
+    StatementList * replacedExpressions; /*<Replaced computations, freed after the pass so cached types of new expressions stay valid>*/
+    int replacedCount;
+    Table * assignedInStatement; /*<Variables assigned earlier in the current statement, values read after them cant be saved before it>*/
+} CommonSubexpressions;
+
+/**
+ * @brief Get the next unique id of variable holding common subexpression
+ *
+ * @return size_t
+ */
+size_t getNextCommonSubexpressionUID() {
+    static size_t commonSubexpressionUID = 0;
+    return commonSubexpressionUID++;
+}
+
+AvailableExpression * findAvailableExpression(AvailableExpressions * available, char * key) {
+    for(int i=0; i<available->count; i++) {
+        if(strcmp(available->expressions[i]->key, key) == 0) return available->expressions[i];
+    }
+    return NULL;
+}
+
+AvailableExpressions copyAvailableExpressions(AvailableExpressions * available) {
+    AvailableExpressions copy = {.expressions = NULL, .count = available->count};
+    if(available->count > 0) {
+        copy.expressions = malloc(sizeof(AvailableExpression*) * available->count);
+        memcpy(copy.expressions, available->expressions, sizeof(AvailableExpression*) * available->count);
+    }
+    return copy;
+}
+
+void addVariableRead(AvailableExpression * available, Statement * statement) {
+    if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_VARIABLE) return;
+    char * name = ((Expression__Variable*)statement)->name;
+    for(int i=0; i<available->variableCount; i++) {
+        if(strcmp(available->variables[i], name) == 0) return;
+    }
+    available->variables = realloc(available->variables, sizeof(char*) * (available->variableCount + 1));
+    available->variables[available->variableCount++] = strdup(name);
+}
+
+AvailableExpression * createAvailableExpression(CommonSubexpressions * cse, char * key, Expression ** slot, Statement * statement) {
+    AvailableExpression * available = malloc(sizeof(AvailableExpression));
+    *available = (AvailableExpression){.key = key, .variables = NULL, .variableCount = 0, .holder = NULL, .slot = slot, .statement = statement};
+    // variables are collected before any subexpression is replaced by a read of saved value
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements((Statement*)*slot, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        addVariableRead(available, *allStatements[i]);
+    }
+    free(allStatements);
+    cse->allExpressions = realloc(cse->allExpressions, sizeof(AvailableExpression*) * (cse->allExpressionCount + 1));
+    cse->allExpressions[cse->allExpressionCount++] = available;
+    return available;
+}
+
+void freeAvailableExpression(AvailableExpression * available) {
+    for(int i=0; i<available->variableCount; i++) {
+        free(available->variables[i]);
+    }
+    free(available->variables);
+    free(available->key);
+    free(available->holder);
+    free(available);
+}
+
+void addAvailableExpression(AvailableExpressions * available, AvailableExpression * expression) {
+    available->expressions = realloc(available->expressions, sizeof(AvailableExpression*) * (available->count + 1));
+    available->expressions[available->count++] = expression;
+}
+
+/**
+ * @brief Checks if the value of the expression changes when the variable is assigned
+ */
+bool dependsOnVariable(AvailableExpression * available, char * name) {
+    if(available->holder != NULL && strcmp(available->holder, name) == 0) return true;
+    for(int i=0; i<available->variableCount; i++) {
+        if(strcmp(available->variables[i], name) == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Removes expressions depending on the variable
+ */
+void killVariable(AvailableExpressions * available, char * name) {
+    int count = 0;
+    for(int i=0; i<available->count; i++) {
+        if(!dependsOnVariable(available->expressions[i], name)) available->expressions[count++] = available->expressions[i];
+    }
+    available->count = count;
+}
+
+/**
+ * @brief Removes expressions depending on any of the assigned variables
+ */
+void killAssignedVariables(AvailableExpressions * available, Table * assignedVariables) {
+    for(int i=0; i<TB_SIZE; i++) {
+        for(TableItem * item = assignedVariables->tb[i]; item != NULL; item = item->next) {
+            killVariable(available, item->name);
+        }
+    }
+}
+
+/**
+ * @brief Checks if the slot is part of the statement
+ */
+bool isSlotInStatement(Statement * statement, Expression ** slot) {
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(statement, &statementCount);
+    bool found = false;
+    for(size_t i=0; i<statementCount; i++) {
+        if(allStatements[i] == (Statement**)slot) {
+            found = true;
+            break;
+        }
+    }
+    free(allStatements);
+    return found;
+}
+
+/**
+ * @brief Moves the first computation of the expression into assignment of a new variable placed before its statement
+ * @note assignment of enclosing expression, which was saved earlier, must stay after the assignment of its part
+ */
+void saveAvailableExpression(CommonSubexpressions * cse, AvailableExpression * available) {
+    StringBuilder sb;
+    StringBuilder__init(&sb);
+    StringBuilder__appendString(&sb, "$&common&");
+    StringBuilder__appendInt(&sb, (int)getNextCommonSubexpressionUID());
+    Expression__Variable * variable = Expression__Variable__init();
+    variable->name = sb.text;
+    Expression__BinaryOperator * assignment = Expression__BinaryOperator__init();
+    assignment->operator = TOKEN_ASSIGN;
+    assignment->lSide = (Expression*)variable->super.super.duplicate((Statement*)variable);
+    assignment->rSide = *available->slot;
+    *available->slot = (Expression*)variable;
+    available->holder = strdup(variable->name);
+
+    PointerTableItem * item = pointer_table_find(cse->savedValues, available->statement);
+    if(item == NULL) item = pointer_table_insert(cse->savedValues, available->statement, StatementList__init());
+    StatementList * assignments = (StatementList*)item->data;
+    int position = assignments->listSize;
+    for(int i=0; i<assignments->listSize; i++) {
+        if(isSlotInStatement(assignments->statements[i], available->slot)) {
+            position = i;
+            break;
+        }
+    }
+    StatementList__addStatement(assignments, NULL);
+    memmove(&assignments->statements[position + 1], &assignments->statements[position], sizeof(Statement*) * (assignments->listSize - 1 - position));
+    assignments->statements[position] = (Statement*)assignment;
+}
+
+void reuseAvailableExpression(CommonSubexpressions * cse, AvailableExpression * available, Expression ** slot) {
+    if(available->holder == NULL) saveAvailableExpression(cse, available);
+    Expression__Variable * variable = Expression__Variable__init();
+    variable->name = strdup(available->holder);
+    StatementList__addStatement(cse->replacedExpressions, (Statement*)*slot);
+    *slot = (Expression*)variable;
+    cse->replacedCount++;
+}
+
+AvailableExpression * findAvailableExpressionBySlot(AvailableExpressions * available, Expression ** slot) {
+    for(int i=0; i<available->count; i++) {
+        if(available->expressions[i]->slot == slot) return available->expressions[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Replaces already computed pure subexpressions by reads of their saved values and records new ones
+ *
+ * @param cse
+ * @param available expressions available before the evaluation, updated to the state after it
+ * @param slot
+ * @param statement statement evaluating the expression, NULL if its values cant be saved before it
+ * @param isEvaluatedFirst true while nothing with side effect or possible runtime error was evaluated in the statement before,
+ *  expressions which can fail are saved before the statement only then, so the error is raised at the same point
+ * @param isConditional the expression isnt evaluated every time the statement is
+ * @param isAssigned the value is assigned to a variable, which can hold it without a new assignment
+ */
+void eliminateInExpression(CommonSubexpressions * cse, AvailableExpressions * available, Expression ** slot, Statement * statement, bool * isEvaluatedFirst, bool isConditional, bool isAssigned) {
+    Expression * expression = *slot;
+    if(expression == NULL) return;
+    bool isPure = isInvariantExpression(NULL, expression);
+    AvailableExpression * computed = NULL;
+    if(isPure && isHoistingWorthwhile(expression)) {
+        char * key = serializeExpression(expression);
+        AvailableExpression * existing = findAvailableExpression(available, key);
+        if(existing != NULL) {
+            free(key);
+            reuseAvailableExpression(cse, existing, slot);
+            return;
+        }
+        bool canFail = canExpressionFail(expression, cse->function, cse->functionTable, cse->program, cse->resultTable);
+        if(statement != NULL && isInvariantExpression(cse->assignedInStatement, expression) && (*isEvaluatedFirst || !canFail || (isAssigned && !isConditional))) {
+            computed = createAvailableExpression(cse, key, slot, statement);
+        } else {
+            free(key);
+        }
+    }
+    bool isSafe = isPure && !canExpressionFail(expression, cse->function, cse->functionTable, cse->program, cse->resultTable);
+    switch(expression->expressionType) {
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            if(op->operator == TOKEN_ASSIGN) {
+                eliminateInExpression(cse, available, &op->rSide, statement, isEvaluatedFirst, isConditional, op->lSide->expressionType == EXPRESSION_VARIABLE);
+                if(op->lSide->expressionType != EXPRESSION_VARIABLE) break;
+                char * name = ((Expression__Variable*)op->lSide)->name;
+                killVariable(available, name);
+                collectAssignedVariables(cse->assignedInStatement, (Statement*)expression);
+                // the variable keeps the value until it is assigned again
+                AvailableExpression * value = findAvailableExpressionBySlot(available, &op->rSide);
+                if(value != NULL && value->holder == NULL && !isConditional) value->holder = strdup(name);
+                break;
+            }
+            eliminateInExpression(cse, available, &op->lSide, statement, isEvaluatedFirst, isConditional, false);
+            // right side of short circuit operators isnt evaluated every time
+            if(op->operator == TOKEN_AND || op->operator == TOKEN_OR || op->operator == TOKEN_NULL_COALESCING) {
+                bool isRightEvaluatedFirst = false;
+                AvailableExpressions conditional = copyAvailableExpressions(available);
+                eliminateInExpression(cse, &conditional, &op->rSide, statement, &isRightEvaluatedFirst, true, false);
+                free(conditional.expressions);
+                Table * assignedVariables = table_init();
+                collectAssignedVariables(assignedVariables, (Statement*)op->rSide);
+                killAssignedVariables(available, assignedVariables);
+                table_free(assignedVariables);
+                collectAssignedVariables(cse->assignedInStatement, (Statement*)op->rSide);
+                if(!isRightEvaluatedFirst) *isEvaluatedFirst = false;
+            } else {
+                eliminateInExpression(cse, available, &op->rSide, statement, isEvaluatedFirst, isConditional, false);
+            }
+            break;
+        }
+        case EXPRESSION_PREFIX_OPERATOR: {
+            Expression__PrefixOperator * op = (Expression__PrefixOperator*)expression;
+            if(op->operator == TOKEN_NEGATE) {
+                eliminateInExpression(cse, available, &op->rSide, statement, isEvaluatedFirst, isConditional, false);
+            } else if(op->rSide->expressionType == EXPRESSION_VARIABLE) {
+                killVariable(available, ((Expression__Variable*)op->rSide)->name);
+                collectAssignedVariables(cse->assignedInStatement, (Statement*)expression);
+            }
+            break;
+        }
+        case EXPRESSION_POSTFIX_OPERATOR: {
+            Expression__PostfixOperator * op = (Expression__PostfixOperator*)expression;
+            if(op->operand->expressionType == EXPRESSION_VARIABLE) {
+                killVariable(available, ((Expression__Variable*)op->operand)->name);
+                collectAssignedVariables(cse->assignedInStatement, (Statement*)expression);
+            }
+            break;
+        }
+        case EXPRESSION_FUNCTION_CALL: {
+            // user functions see only their own variables, so their calls cant change any available value
+            Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+            for(int i=0; i<call->arity; i++) {
+                eliminateInExpression(cse, available, &call->arguments[i], statement, isEvaluatedFirst, isConditional, false);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    if(computed != NULL) addAvailableExpression(available, computed);
+    if(!isSafe) *isEvaluatedFirst = false;
+}
+
+/**
+ * @brief Checks if the condition compares variable by === or !==, type analysis narrows type of the variable by such condition
+ */
+bool isTypeNarrowingCondition(Expression * condition) {
+    if(condition == NULL || condition->expressionType != EXPRESSION_BINARY_OPERATOR) return false;
+    Expression__BinaryOperator * op = (Expression__BinaryOperator*)condition;
+    if(op->operator != TOKEN_EQUALS && op->operator != TOKEN_NOT_EQUALS) return false;
+    return op->lSide->expressionType == EXPRESSION_VARIABLE || op->rSide->expressionType == EXPRESSION_VARIABLE;
+}
+
+/**
+ * @brief Processes condition of if or loop, comparison which narrows types stays in the condition and only its operands are replaced
+ */
+void eliminateInCondition(CommonSubexpressions * cse, AvailableExpressions * available, Expression ** condition, Statement * statement, bool * isEvaluatedFirst) {
+    if(!isTypeNarrowingCondition(*condition)) {
+        eliminateInExpression(cse, available, condition, statement, isEvaluatedFirst, false, false);
+        return;
+    }
+    Expression__BinaryOperator * op = (Expression__BinaryOperator*)*condition;
+    eliminateInExpression(cse, available, &op->lSide, statement, isEvaluatedFirst, false, false);
+    eliminateInExpression(cse, available, &op->rSide, statement, isEvaluatedFirst, false, false);
+}
+
+void eliminateInStatement(CommonSubexpressions * cse, AvailableExpressions * available, Statement ** slot);
+
+/**
+ * @brief Processes body of the loop, only values not changed by any iteration stay available in it
+ */
+void eliminateInLoop(CommonSubexpressions * cse, AvailableExpressions * available, Expression ** condition, Statement ** body, Expression ** increment) {
+    Table * assignedVariables = table_init();
+    collectAssignedVariables(assignedVariables, (Statement*)*condition);
+    collectAssignedVariables(assignedVariables, *body);
+    if(increment != NULL) collectAssignedVariables(assignedVariables, (Statement*)*increment);
+    killAssignedVariables(available, assignedVariables);
+    table_free(assignedVariables);
+    // values of condition and increment change every iteration, they cant be saved before the loop
+    AvailableExpressions iteration = copyAvailableExpressions(available);
+    bool isEvaluatedFirst = false;
+    eliminateInCondition(cse, &iteration, condition, NULL, &isEvaluatedFirst);
+    free(iteration.expressions);
+    iteration = copyAvailableExpressions(available);
+    eliminateInStatement(cse, &iteration, body);
+    free(iteration.expressions);
+    if(increment != NULL) {
+        iteration = copyAvailableExpressions(available);
+        eliminateInExpression(cse, &iteration, increment, NULL, &isEvaluatedFirst, false, false);
+        free(iteration.expressions);
+    }
+}
+
+/**
+ * @brief Replaces pure expressions computed on every path to the statement by reads of their saved values
+ */
+void eliminateInStatement(CommonSubexpressions * cse, AvailableExpressions * available, Statement ** slot) {
+    Statement * statement = *slot;
+    if(statement == NULL) return;
+    bool isEvaluatedFirst = true;
+    table_free(cse->assignedInStatement);
+    cse->assignedInStatement = table_init();
+    switch(statement->statementType) {
+        case STATEMENT_EXPRESSION:
+            // pure expression statements are evaluated only because of their errors, their values arent used
+            if(isInvariantExpression(NULL, (Expression*)statement)) break;
+            eliminateInExpression(cse, available, (Expression**)slot, statement, &isEvaluatedFirst, false, false);
+            break;
+        case STATEMENT_RETURN:
+            eliminateInExpression(cse, available, &((StatementReturn*)statement)->expression, statement, &isEvaluatedFirst, false, false);
+            break;
+        case STATEMENT_IF: {
+            StatementIf * ifStatement = (StatementIf*)statement;
+            eliminateInCondition(cse, available, &ifStatement->condition, statement, &isEvaluatedFirst);
+            // values computed in a branch arent available after the if
+            AvailableExpressions branch = copyAvailableExpressions(available);
+            eliminateInStatement(cse, &branch, &ifStatement->ifBody);
+            free(branch.expressions);
+            branch = copyAvailableExpressions(available);
+            eliminateInStatement(cse, &branch, &ifStatement->elseBody);
+            free(branch.expressions);
+            Table * assignedVariables = table_init();
+            collectAssignedVariables(assignedVariables, ifStatement->ifBody);
+            collectAssignedVariables(assignedVariables, ifStatement->elseBody);
+            killAssignedVariables(available, assignedVariables);
+            table_free(assignedVariables);
+            break;
+        }
+        case STATEMENT_WHILE: {
+            StatementWhile * whileStatement = (StatementWhile*)statement;
+            eliminateInLoop(cse, available, &whileStatement->condition, &whileStatement->body, NULL);
+            break;
+        }
+        case STATEMENT_FOR: {
+            StatementFor * forStatement = (StatementFor*)statement;
+            // initialization is evaluated once right before the loop
+            eliminateInExpression(cse, available, &forStatement->init, statement, &isEvaluatedFirst, false, false);
+            eliminateInLoop(cse, available, &forStatement->condition, &forStatement->body, &forStatement->increment);
+            break;
+        }
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)statement;
+            for(int i=0; i<list->listSize; i++) {
+                eliminateInStatement(cse, available, &list->statements[i]);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Places assignments of saved values before the statements computing them
+ */
+void insertSavedValues(CommonSubexpressions * cse, Statement ** slot) {
+    if(slot == NULL || *slot == NULL) return;
+    Statement * statement = *slot;
+    if(statement->statementType != STATEMENT_EXPRESSION && statement->statementType != STATEMENT_FUNCTION) {
+        int childrenCount = 0;
+        Statement *** children = statement->getChildren(statement, &childrenCount);
+        for(int i=0; i<childrenCount; i++) {
+            insertSavedValues(cse, children[i]);
+        }
+        free(children);
+    }
+    PointerTableItem * item = pointer_table_find(cse->savedValues, statement);
+    if(item == NULL) return;
+    StatementList * list = (StatementList*)item->data;
+    StatementList__addStatement(list, statement);
+    *slot = (Statement*)list;
+}
+
+/**
+ * @brief Replaces repeated computations of pure expressions by reads of a variable holding their value
+ * @note values are reused in the statements dominated by their computation, assignment of any variable read by the expression
+ *  makes its value unavailable
+ *
+ * @param body
+ * @param function function owning the body, NULL for main program
+ * @param functionTable
+ * @param program
+ * @param resultTable
+ * @return true if the body was changed
+ */
+bool eliminateCommonSubexpressions(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    CommonSubexpressions cse = {.functionTable = functionTable, .program = program, .function = function, .resultTable = resultTable,
+        .savedValues = pointer_table_init(), .allExpressions = NULL, .allExpressionCount = 0,
+        .replacedExpressions = StatementList__init(), .replacedCount = 0, .assignedInStatement = table_init()};
+    AvailableExpressions available = {.expressions = NULL, .count = 0};
+    eliminateInStatement(&cse, &available, body);
+    free(available.expressions);
+    insertSavedValues(&cse, body);
+    for(int i=0; i<cse.allExpressionCount; i++) {
+        freeAvailableExpression(cse.allExpressions[i]);
+    }
+    free(cse.allExpressions);
+    cse.replacedExpressions->super.free((Statement*)cse.replacedExpressions);
+    pointer_table_free(cse.savedValues);
+    table_free(cse.assignedInStatement);
+    if(cse.replacedCount == 0) return false;
+    invalidateResultsType(resultTable, function != NULL ? (Statement*)function : (Statement*)program);
+    return true;
+}
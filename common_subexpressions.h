@@ -0,0 +1,18 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file common_subexpressions.h
+ * @brief Header file for common subexpression elimination
+ */
+
+#ifndef __COMMON_SUBEXPRESSIONS_H__
+#define __COMMON_SUBEXPRESSIONS_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+#include "pointer_hashtable.h"
+
+bool isTypeNarrowingCondition(Expression * condition);
+bool eliminateCommonSubexpressions(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable);
+
+#endif // __COMMON_SUBEXPRESSIONS_H__
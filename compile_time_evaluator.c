@@ -0,0 +1,995 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file compile_time_evaluator.c
+ * @brief Compile time execution of the program or of its prefix which doesnt depend on input
+ */
+
+#include "compile_time_evaluator.h"
+#include "optimizer.h"
+#include <math.h>
+
+#define EVALUATION_FUEL 1000000 /*<Maximum number of evaluated expressions and statements*/
+#define EVALUATION_MAX_CALL_DEPTH 1000 /*<Deeper recursion isnt evaluated*/
+#define EVALUATION_MAX_STRING_LENGTH 65536 /*<Longer strings arent created by the evaluator*/
+#define EVALUATION_MAX_OUTPUT_SIZE 65536 /*<Maximum size of output replacing the evaluated code*/
+#define EVALUATION_CALL_FUEL 100000 /*<Maximum number of evaluated expressions and statements of single folded call*/
+
+/**
+ * @brief Value of expression known during compilation, only type.type is used
+ */
+typedef struct {
+    Type type;
+    union {
+        long long int integer;
+        double real;
+        char * string;
+        bool boolean;
+    } value;
+} EvaluatedValue;
+
+typedef enum {
+    EVALUATION_NEXT, /*<Execution continues with the next statement*/
+    EVALUATION_BREAK,
+    EVALUATION_CONTINUE,
+    EVALUATION_RETURN,
+    EVALUATION_EXIT, /*<Program ended, exitCode is set*/
+    EVALUATION_UNKNOWN /*<Result depends on input or on behaviour which isnt simulated*/
+} EvaluationState;
+
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    PointerTable * resultTable;
+    Function * function; /*<Function whose body is evaluated, NULL for main program*/
+    Table * variables; /*<Variables of the current frame*/
+    long long fuel;
+    int callDepth;
+    EvaluationState state;
+    int jumpDepth; /*<Remaining depth of break or continue*/
+    int exitCode;
+    EvaluatedValue returnValue;
+    EvaluatedValue * output; /*<Values passed to write*/
+    int outputCount;
+    size_t outputSize;
+} Evaluator;
+
+/**
+ * @brief Stops evaluation, also used for runtime errors, because other optimizations may remove or reorder the failing operation
+ */
+bool giveUpEvaluation(Evaluator * evaluator) {
+    evaluator->state = EVALUATION_UNKNOWN;
+    return false;
+}
+
+bool exitEvaluation(Evaluator * evaluator, int exitCode) {
+    evaluator->state = EVALUATION_EXIT;
+    evaluator->exitCode = exitCode;
+    return false;
+}
+
+EvaluatedValue createIntValue(long long int integer) {
+    EvaluatedValue value = {.type = {.type = TYPE_INT, .isRequired = true}};
+    value.value.integer = integer;
+    return value;
+}
+
+EvaluatedValue createFloatValue(double real) {
+    EvaluatedValue value = {.type = {.type = TYPE_FLOAT, .isRequired = true}};
+    value.value.real = real;
+    return value;
+}
+
+EvaluatedValue createStringValue(char * string) {
+    EvaluatedValue value = {.type = {.type = TYPE_STRING, .isRequired = true}};
+    value.value.string = string;
+    return value;
+}
+
+EvaluatedValue createBoolValue(bool boolean) {
+    EvaluatedValue value = {.type = {.type = TYPE_BOOL, .isRequired = true}};
+    value.value.boolean = boolean;
+    return value;
+}
+
+EvaluatedValue createNullValue() {
+    EvaluatedValue value = {.type = {.type = TYPE_NULL, .isRequired = false}};
+    value.value.integer = 0;
+    return value;
+}
+
+Expression__Constant * createConstantFromValue(EvaluatedValue value) {
+    Expression__Constant * constant = Expression__Constant__init();
+    constant->type = value.type;
+    switch(value.type.type) {
+        case TYPE_INT:
+            constant->value.integer = value.value.integer;
+            break;
+        case TYPE_FLOAT:
+            constant->value.real = value.value.real;
+            break;
+        case TYPE_STRING:
+            constant->value.string = value.value.string;
+            break;
+        case TYPE_BOOL:
+            constant->value.boolean = value.value.boolean;
+            break;
+        default:
+            constant->type = (Type){.type = TYPE_NULL, .isRequired = false};
+            break;
+    }
+    return constant;
+}
+
+bool isAsciiString(char * string) {
+    for(; *string != '\0'; string++) {
+        if((unsigned char)*string >= 128) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Casts value to bool like the generated code, only conditions treat string "0" as false
+ */
+bool castValueToBool(EvaluatedValue value, bool isCondition) {
+    switch(value.type.type) {
+        case TYPE_INT:
+            return value.value.integer != 0;
+        case TYPE_FLOAT:
+            return value.value.real != 0.0;
+        case TYPE_STRING:
+            return value.value.string[0] != '\0' && (!isCondition || strcmp(value.value.string, "0") != 0);
+        case TYPE_BOOL:
+            return value.value.boolean;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Casts value to int like the generated code, conversion of strings isnt simulated
+ */
+bool castValueToInt(Evaluator * evaluator, EvaluatedValue value, long long int * result) {
+    switch(value.type.type) {
+        case TYPE_INT:
+            *result = value.value.integer;
+            return true;
+        case TYPE_FLOAT:
+            // interpreter has unlimited integers, so only values representable in both are converted
+            if(!isfinite(value.value.real) || fabs(value.value.real) >= 9.0e18) return giveUpEvaluation(evaluator);
+            *result = (long long int)value.value.real;
+            return true;
+        case TYPE_BOOL:
+            *result = value.value.boolean;
+            return true;
+        case TYPE_NULL:
+            *result = 0;
+            return true;
+        default:
+            return giveUpEvaluation(evaluator);
+    }
+}
+
+bool castValueToFloat(Evaluator * evaluator, EvaluatedValue value, double * result) {
+    switch(value.type.type) {
+        case TYPE_INT:
+            *result = (double)value.value.integer;
+            return true;
+        case TYPE_FLOAT:
+            *result = value.value.real;
+            return true;
+        case TYPE_BOOL:
+            *result = value.value.boolean;
+            return true;
+        case TYPE_NULL:
+            *result = 0.0;
+            return true;
+        default:
+            return giveUpEvaluation(evaluator);
+    }
+}
+
+/**
+ * @brief Casts value to string like the generated code, generated conversion of floats differs from the constant one, so it isnt simulated
+ */
+bool castValueToString(Evaluator * evaluator, EvaluatedValue value, char ** result) {
+    switch(value.type.type) {
+        case TYPE_STRING:
+            *result = value.value.string;
+            return true;
+        case TYPE_INT:
+            *result = malloc(32);
+            sprintf(*result, "%lld", value.value.integer);
+            return true;
+        case TYPE_BOOL:
+            *result = value.value.boolean ? "1" : "";
+            return true;
+        case TYPE_NULL:
+            *result = "";
+            return true;
+        default:
+            return giveUpEvaluation(evaluator);
+    }
+}
+
+bool checkFloatResult(Evaluator * evaluator, double real, EvaluatedValue * result) {
+    if(!isfinite(real)) return giveUpEvaluation(evaluator);
+    *result = createFloatValue(real);
+    return true;
+}
+
+/**
+ * @brief Evaluates +, - and *, operands are converted to float if any of them is float
+ */
+bool evaluateArithmetic(Evaluator * evaluator, TokenType operator, EvaluatedValue left, EvaluatedValue right, EvaluatedValue * result) {
+    if(left.type.type == TYPE_FLOAT || right.type.type == TYPE_FLOAT) {
+        double leftReal, rightReal;
+        if(!castValueToFloat(evaluator, left, &leftReal) || !castValueToFloat(evaluator, right, &rightReal)) return false;
+        if(operator == TOKEN_PLUS) return checkFloatResult(evaluator, leftReal + rightReal, result);
+        if(operator == TOKEN_MINUS) return checkFloatResult(evaluator, leftReal - rightReal, result);
+        return checkFloatResult(evaluator, leftReal * rightReal, result);
+    }
+    long long int leftInteger, rightInteger, integer;
+    if(!castValueToInt(evaluator, left, &leftInteger) || !castValueToInt(evaluator, right, &rightInteger)) return false;
+    bool overflow;
+    if(operator == TOKEN_PLUS) {
+        overflow = __builtin_add_overflow(leftInteger, rightInteger, &integer);
+    } else if(operator == TOKEN_MINUS) {
+        overflow = __builtin_sub_overflow(leftInteger, rightInteger, &integer);
+    } else {
+        overflow = __builtin_mul_overflow(leftInteger, rightInteger, &integer);
+    }
+    // integers of interpreter dont overflow
+    if(overflow) return giveUpEvaluation(evaluator);
+    *result = createIntValue(integer);
+    return true;
+}
+
+int compareStrings(char * left, char * right) {
+    return strcmp(left, right);
+}
+
+/**
+ * @brief Compares values by the rules of relational operators, result is negative, zero or positive
+ */
+bool compareValues(Evaluator * evaluator, EvaluatedValue left, EvaluatedValue right, int * result) {
+    if(left.type.type == TYPE_NULL || right.type.type == TYPE_NULL) {
+        *result = (int)castValueToBool(left, false) - (int)castValueToBool(right, false);
+        return true;
+    }
+    if(left.type.type == right.type.type && left.type.type == TYPE_BOOL) {
+        *result = (int)left.value.boolean - (int)right.value.boolean;
+        return true;
+    }
+    if(left.type.type == TYPE_STRING || right.type.type == TYPE_STRING) {
+        char * leftString;
+        char * rightString;
+        if(!castValueToString(evaluator, left, &leftString) || !castValueToString(evaluator, right, &rightString)) return false;
+        *result = compareStrings(leftString, rightString);
+        return true;
+    }
+    if(left.type.type == TYPE_FLOAT || right.type.type == TYPE_FLOAT) {
+        double leftReal, rightReal;
+        if(!castValueToFloat(evaluator, left, &leftReal) || !castValueToFloat(evaluator, right, &rightReal)) return false;
+        *result = (leftReal > rightReal) - (leftReal < rightReal);
+        return true;
+    }
+    long long int leftInteger, rightInteger;
+    if(!castValueToInt(evaluator, left, &leftInteger) || !castValueToInt(evaluator, right, &rightInteger)) return false;
+    *result = (leftInteger > rightInteger) - (leftInteger < rightInteger);
+    return true;
+}
+
+bool areValuesIdentical(EvaluatedValue left, EvaluatedValue right) {
+    if(left.type.type != right.type.type) return false;
+    switch(left.type.type) {
+        case TYPE_INT:
+            return left.value.integer == right.value.integer;
+        case TYPE_FLOAT:
+            return left.value.real == right.value.real;
+        case TYPE_STRING:
+            return strcmp(left.value.string, right.value.string) == 0;
+        case TYPE_BOOL:
+            return left.value.boolean == right.value.boolean;
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief Evaluates === like the generated code, operands of statically different types are never identical
+ */
+bool evaluateIdentity(Evaluator * evaluator, Expression__BinaryOperator * op, EvaluatedValue left, EvaluatedValue right) {
+    Type typeL = unionTypeToType(op->lSide->getType(op->lSide, evaluator->functionTable, evaluator->program, evaluator->function, evaluator->resultTable));
+    Type typeR = unionTypeToType(op->rSide->getType(op->rSide, evaluator->functionTable, evaluator->program, evaluator->function, evaluator->resultTable));
+    if(typeL.type != TYPE_UNKNOWN && typeR.type != TYPE_UNKNOWN) {
+        if(!(typeL.type == typeR.type || (typeL.type == TYPE_NULL && !typeR.isRequired) || (typeR.type == TYPE_NULL && !typeL.isRequired))) return false;
+    }
+    return areValuesIdentical(left, right);
+}
+
+Table * copyVariables(Table * variables) {
+    Table * copy = table_init();
+    for(int i=0; i<TB_SIZE; i++) {
+        for(TableItem * item = variables->tb[i]; item != NULL; item = item->next) {
+            EvaluatedValue * value = malloc(sizeof(EvaluatedValue));
+            *value = *(EvaluatedValue*)item->data;
+            table_insert(copy, item->name, value);
+        }
+    }
+    return copy;
+}
+
+void freeVariables(Table * variables) {
+    for(int i=0; i<TB_SIZE; i++) {
+        for(TableItem * item = variables->tb[i]; item != NULL; item = item->next) {
+            free(item->data);
+        }
+    }
+    table_free(variables);
+}
+
+void setVariable(Table * variables, char * name, EvaluatedValue value) {
+    TableItem * item = table_find(variables, name);
+    if(item != NULL) {
+        *(EvaluatedValue*)item->data = value;
+        return;
+    }
+    EvaluatedValue * data = malloc(sizeof(EvaluatedValue));
+    *data = value;
+    table_insert(variables, name, data);
+}
+
+bool evaluateExpression(Evaluator * evaluator, Expression * expression, EvaluatedValue * result);
+EvaluationState executeStatement(Evaluator * evaluator, Statement * statement);
+
+bool addOutput(Evaluator * evaluator, EvaluatedValue value) {
+    if(value.type.type == TYPE_STRING) {
+        evaluator->outputSize += strlen(value.value.string);
+    } else {
+        evaluator->outputSize += 32;
+    }
+    if(evaluator->outputSize > EVALUATION_MAX_OUTPUT_SIZE) return giveUpEvaluation(evaluator);
+    evaluator->output = realloc(evaluator->output, sizeof(EvaluatedValue) * (evaluator->outputCount + 1));
+    evaluator->output[evaluator->outputCount++] = value;
+    return true;
+}
+
+/**
+ * @brief Checks type of argument or return value, null is accepted by optional types
+ */
+bool isValueOfType(EvaluatedValue value, Type type) {
+    return value.type.type == type.type || (!type.isRequired && value.type.type == TYPE_NULL);
+}
+
+/**
+ * @brief Evaluates built in function, read functions depend on input, so they arent evaluated
+ */
+bool evaluateBuiltinCall(Evaluator * evaluator, Function * function, EvaluatedValue * arguments, int arity, EvaluatedValue * result) {
+    char * name = function->name;
+    *result = createNullValue();
+    if(strcmp(name, "write") == 0) {
+        for(int i=0; i<arity; i++) {
+            // constant bool is written differently than bool computed at runtime
+            if(arguments[i].type.type == TYPE_BOOL) return giveUpEvaluation(evaluator);
+            if(!addOutput(evaluator, arguments[i])) return false;
+        }
+        return true;
+    }
+    if(arity != function->arity) return giveUpEvaluation(evaluator);
+    if(strcmp(name, "intval") == 0) {
+        long long int integer;
+        if(!castValueToInt(evaluator, arguments[0], &integer)) return false;
+        *result = createIntValue(integer);
+        return true;
+    } else if(strcmp(name, "floatval") == 0) {
+        double real;
+        if(!castValueToFloat(evaluator, arguments[0], &real)) return false;
+        *result = createFloatValue(real);
+        return true;
+    } else if(strcmp(name, "boolval") == 0) {
+        *result = createBoolValue(castValueToBool(arguments[0], false));
+        return true;
+    } else if(strcmp(name, "strval") == 0) {
+        char * string;
+        if(!castValueToString(evaluator, arguments[0], &string)) return false;
+        *result = createStringValue(string);
+        return true;
+    }
+    for(int i=0; i<arity; i++) {
+        if(!isValueOfType(arguments[i], function->parameterTypes[i])) return giveUpEvaluation(evaluator);
+    }
+    // interpreter works with unicode characters, so only ascii strings are indexed
+    if(strcmp(name, "strlen") == 0) {
+        if(!isAsciiString(arguments[0].value.string)) return giveUpEvaluation(evaluator);
+        *result = createIntValue(strlen(arguments[0].value.string));
+        return true;
+    } else if(strcmp(name, "substring") == 0) {
+        char * string = arguments[0].value.string;
+        if(!isAsciiString(string)) return giveUpEvaluation(evaluator);
+        long long int length = strlen(string);
+        long long int start = arguments[1].value.integer;
+        long long int end = arguments[2].value.integer;
+        if(start < 0 || start > end || start >= length || end > length) return true;
+        char * substring = malloc(end - start + 1);
+        memcpy(substring, string + start, end - start);
+        substring[end - start] = '\0';
+        *result = createStringValue(substring);
+        return true;
+    } else if(strcmp(name, "ord") == 0) {
+        unsigned char first = (unsigned char)arguments[0].value.string[0];
+        if(first >= 128) return giveUpEvaluation(evaluator);
+        *result = createIntValue(first);
+        return true;
+    } else if(strcmp(name, "chr") == 0) {
+        long long int code = arguments[0].value.integer;
+        if(code <= 0 || code >= 128) return giveUpEvaluation(evaluator);
+        char * string = malloc(2);
+        string[0] = (char)code;
+        string[1] = '\0';
+        *result = createStringValue(string);
+        return true;
+    }
+    return giveUpEvaluation(evaluator);
+}
+
+/**
+ * @brief Evaluates call of user function in new frame, failed type check of arguments or return value stops evaluation
+ */
+bool evaluateUserCall(Evaluator * evaluator, Function * function, EvaluatedValue * arguments, int arity, EvaluatedValue * result) {
+    if(arity != function->arity || evaluator->callDepth >= EVALUATION_MAX_CALL_DEPTH) return giveUpEvaluation(evaluator);
+    for(int i=0; i<arity; i++) {
+        if(!isValueOfType(arguments[i], function->parameterTypes[i])) return giveUpEvaluation(evaluator);
+    }
+    Table * callerVariables = evaluator->variables;
+    Function * caller = evaluator->function;
+    evaluator->variables = table_init();
+    evaluator->function = function;
+    evaluator->callDepth++;
+    for(int i=0; i<arity; i++) {
+        setVariable(evaluator->variables, function->parameterNames[i], arguments[i]);
+    }
+    EvaluationState state = executeStatement(evaluator, function->body);
+    freeVariables(evaluator->variables);
+    evaluator->variables = callerVariables;
+    evaluator->function = caller;
+    evaluator->callDepth--;
+    if(state == EVALUATION_EXIT || state == EVALUATION_UNKNOWN) return false;
+    if(state == EVALUATION_RETURN) {
+        evaluator->state = EVALUATION_NEXT;
+        *result = evaluator->returnValue;
+        return true;
+    }
+    // end of body was reached without return
+    if(function->returnType.type != TYPE_VOID) return giveUpEvaluation(evaluator);
+    *result = createNullValue();
+    return true;
+}
+
+bool evaluateFunctionCall(Evaluator * evaluator, Expression__FunctionCall * call, EvaluatedValue * result) {
+    TableItem * item = table_find(evaluator->functionTable, call->name);
+    if(item == NULL) return giveUpEvaluation(evaluator);
+    Function * function = (Function*)item->data;
+    if(function->body == NULL && (strcmp(call->name, "reads") == 0 || strcmp(call->name, "readi") == 0 || strcmp(call->name, "readf") == 0)) {
+        return giveUpEvaluation(evaluator);
+    }
+    // all arguments are evaluated before the call, variable arguments are read only after the others
+    EvaluatedValue * arguments = malloc(sizeof(EvaluatedValue) * (call->arity + 1));
+    for(int pass=0; pass<2; pass++) {
+        for(int i=0; i<call->arity; i++) {
+            if((call->arguments[i]->expressionType == EXPRESSION_VARIABLE) != (pass == 1)) continue;
+            if(!evaluateExpression(evaluator, call->arguments[i], &arguments[i])) {
+                free(arguments);
+                return false;
+            }
+        }
+    }
+    bool success;
+    if(function->body == NULL) {
+        success = evaluateBuiltinCall(evaluator, function, arguments, call->arity, result);
+    } else {
+        success = evaluateUserCall(evaluator, function, arguments, call->arity, result);
+    }
+    free(arguments);
+    return success;
+}
+
+bool evaluateBinaryOperator(Evaluator * evaluator, Expression__BinaryOperator * op, EvaluatedValue * result) {
+    if(op->operator == TOKEN_ASSIGN) {
+        if(op->lSide->expressionType != EXPRESSION_VARIABLE) return giveUpEvaluation(evaluator);
+        if(!evaluateExpression(evaluator, op->rSide, result)) return false;
+        setVariable(evaluator->variables, ((Expression__Variable*)op->lSide)->name, *result);
+        return true;
+    }
+    EvaluatedValue left, right;
+    if(op->operator != TOKEN_AND && op->operator != TOKEN_OR && op->operator != TOKEN_NULL_COALESCING && op->lSide->expressionType == EXPRESSION_VARIABLE) {
+        // variable operand is read by the operator itself, after the other operand is evaluated
+        if(!evaluateExpression(evaluator, op->rSide, &right)) return false;
+        if(!evaluateExpression(evaluator, op->lSide, &left)) return false;
+    } else {
+        if(!evaluateExpression(evaluator, op->lSide, &left)) return false;
+    }
+    if(op->operator == TOKEN_AND || op->operator == TOKEN_OR) {
+        bool leftBool = castValueToBool(left, false);
+        if(leftBool == (op->operator == TOKEN_OR)) {
+            *result = createBoolValue(leftBool);
+            return true;
+        }
+        if(!evaluateExpression(evaluator, op->rSide, &right)) return false;
+        *result = createBoolValue(castValueToBool(right, false));
+        return true;
+    }
+    // right side of ?? is evaluated always by the generated code
+    if(op->lSide->expressionType != EXPRESSION_VARIABLE || op->operator == TOKEN_NULL_COALESCING) {
+        if(!evaluateExpression(evaluator, op->rSide, &right)) return false;
+    }
+    switch(op->operator) {
+        case TOKEN_PLUS:
+        case TOKEN_MINUS:
+        case TOKEN_MULTIPLY:
+            return evaluateArithmetic(evaluator, op->operator, left, right, result);
+        case TOKEN_DIVIDE: {
+            double leftReal, rightReal;
+            if(!castValueToFloat(evaluator, left, &leftReal) || !castValueToFloat(evaluator, right, &rightReal)) return false;
+            if(rightReal == 0.0) return giveUpEvaluation(evaluator);
+            return checkFloatResult(evaluator, leftReal / rightReal, result);
+        }
+        case TOKEN_CONCATENATE: {
+            char * leftString;
+            char * rightString;
+            if(!castValueToString(evaluator, left, &leftString) || !castValueToString(evaluator, right, &rightString)) return false;
+            size_t leftLength = strlen(leftString);
+            size_t rightLength = strlen(rightString);
+            if(leftLength + rightLength > EVALUATION_MAX_STRING_LENGTH) return giveUpEvaluation(evaluator);
+            evaluator->fuel -= (leftLength + rightLength) / 64;
+            char * string = malloc(leftLength + rightLength + 1);
+            memcpy(string, leftString, leftLength);
+            memcpy(string + leftLength, rightString, rightLength + 1);
+            *result = createStringValue(string);
+            return true;
+        }
+        case TOKEN_EQUALS:
+            *result = createBoolValue(evaluateIdentity(evaluator, op, left, right));
+            return true;
+        case TOKEN_NOT_EQUALS:
+            *result = createBoolValue(!evaluateIdentity(evaluator, op, left, right));
+            return true;
+        case TOKEN_LESS:
+        case TOKEN_GREATER:
+        case TOKEN_LESS_OR_EQUALS:
+        case TOKEN_GREATER_OR_EQUALS: {
+            int comparison;
+            if(!compareValues(evaluator, left, right, &comparison)) return false;
+            if(op->operator == TOKEN_LESS) *result = createBoolValue(comparison < 0);
+            else if(op->operator == TOKEN_GREATER) *result = createBoolValue(comparison > 0);
+            else if(op->operator == TOKEN_LESS_OR_EQUALS) *result = createBoolValue(comparison <= 0);
+            else *result = createBoolValue(comparison >= 0);
+            return true;
+        }
+        case TOKEN_NULL_COALESCING:
+            *result = left.type.type == TYPE_NULL ? right : left;
+            return true;
+        default:
+            return giveUpEvaluation(evaluator);
+    }
+}
+
+/**
+ * @brief Evaluates increment or decrement, generated code dispatches on the runtime type of the operand
+ *
+ * @param isPostfix result is the old value
+ */
+bool evaluateIncrement(Evaluator * evaluator, Expression * operand, TokenType operator, bool isPostfix, EvaluatedValue * result) {
+    if(operand->expressionType != EXPRESSION_VARIABLE) return giveUpEvaluation(evaluator);
+    EvaluatedValue value;
+    if(!evaluateExpression(evaluator, operand, &value)) return false;
+    EvaluatedValue updated;
+    if(value.type.type == TYPE_NULL) {
+        // increment of null is 1, decrement keeps null
+        updated = operator == TOKEN_INCREMENT ? createIntValue(1) : value;
+    } else if(value.type.type == TYPE_BOOL) {
+        updated = value;
+    } else if(value.type.type == TYPE_INT || value.type.type == TYPE_FLOAT) {
+        EvaluatedValue one = value.type.type == TYPE_INT ? createIntValue(1) : createFloatValue(1.0);
+        if(!evaluateArithmetic(evaluator, operator == TOKEN_INCREMENT ? TOKEN_PLUS : TOKEN_MINUS, value, one, &updated)) return false;
+    } else {
+        return giveUpEvaluation(evaluator);
+    }
+    setVariable(evaluator->variables, ((Expression__Variable*)operand)->name, updated);
+    *result = isPostfix ? value : updated;
+    return true;
+}
+
+bool evaluateExpression(Evaluator * evaluator, Expression * expression, EvaluatedValue * result) {
+    if(--evaluator->fuel < 0) return giveUpEvaluation(evaluator);
+    switch(expression->expressionType) {
+        case EXPRESSION_CONSTANT: {
+            Expression__Constant * constant = (Expression__Constant*)expression;
+            *result = createNullValue();
+            switch(constant->type.type) {
+                case TYPE_INT:
+                    *result = createIntValue(constant->value.integer);
+                    return true;
+                case TYPE_FLOAT:
+                    *result = createFloatValue(constant->value.real);
+                    return true;
+                case TYPE_STRING:
+                    *result = createStringValue(constant->value.string);
+                    return true;
+                case TYPE_BOOL:
+                    *result = createBoolValue(constant->value.boolean);
+                    return true;
+                case TYPE_NULL:
+                    return true;
+                default:
+                    return giveUpEvaluation(evaluator);
+            }
+        }
+        case EXPRESSION_VARIABLE: {
+            TableItem * item = table_find(evaluator->variables, ((Expression__Variable*)expression)->name);
+            if(item == NULL) return giveUpEvaluation(evaluator);
+            *result = *(EvaluatedValue*)item->data;
+            return true;
+        }
+        case EXPRESSION_FUNCTION_CALL:
+            return evaluateFunctionCall(evaluator, (Expression__FunctionCall*)expression, result);
+        case EXPRESSION_BINARY_OPERATOR:
+            return evaluateBinaryOperator(evaluator, (Expression__BinaryOperator*)expression, result);
+        case EXPRESSION_PREFIX_OPERATOR: {
+            Expression__PrefixOperator * op = (Expression__PrefixOperator*)expression;
+            if(op->operator == TOKEN_INCREMENT || op->operator == TOKEN_DECREMENT) return evaluateIncrement(evaluator, op->rSide, op->operator, false, result);
+            if(op->operator != TOKEN_NEGATE) return giveUpEvaluation(evaluator);
+            EvaluatedValue value;
+            if(!evaluateExpression(evaluator, op->rSide, &value)) return false;
+            *result = createBoolValue(!castValueToBool(value, false));
+            return true;
+        }
+        case EXPRESSION_POSTFIX_OPERATOR: {
+            Expression__PostfixOperator * op = (Expression__PostfixOperator*)expression;
+            return evaluateIncrement(evaluator, op->operand, op->operator, true, result);
+        }
+    }
+    return giveUpEvaluation(evaluator);
+}
+
+/**
+ * @brief Evaluates condition of if or loop, generated code doesnt convert operands of identity comparison
+ */
+bool evaluateCondition(Evaluator * evaluator, Expression * condition, bool * result) {
+    EvaluatedValue value;
+    if(!evaluateExpression(evaluator, condition, &value)) return false;
+    *result = castValueToBool(value, true);
+    return true;
+}
+
+/**
+ * @brief Handles state of loop body after one iteration
+ *
+ * @return true if the loop continues with next iteration
+ */
+bool continueLoop(Evaluator * evaluator, EvaluationState * state) {
+    if(*state == EVALUATION_BREAK || *state == EVALUATION_CONTINUE) {
+        if(--evaluator->jumpDepth > 0) return false;
+        bool isContinue = *state == EVALUATION_CONTINUE;
+        *state = EVALUATION_NEXT;
+        evaluator->state = EVALUATION_NEXT;
+        return isContinue;
+    }
+    return *state == EVALUATION_NEXT;
+}
+
+EvaluationState executeStatement(Evaluator * evaluator, Statement * statement) {
+    if(statement == NULL) return EVALUATION_NEXT;
+    if(--evaluator->fuel < 0) {
+        giveUpEvaluation(evaluator);
+        return evaluator->state;
+    }
+    EvaluatedValue value;
+    switch(statement->statementType) {
+        case STATEMENT_EXPRESSION:
+            evaluateExpression(evaluator, (Expression*)statement, &value);
+            return evaluator->state;
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)statement;
+            for(int i=0; i<list->listSize; i++) {
+                EvaluationState state = executeStatement(evaluator, list->statements[i]);
+                if(state != EVALUATION_NEXT) return state;
+            }
+            return EVALUATION_NEXT;
+        }
+        case STATEMENT_IF: {
+            StatementIf * ifStatement = (StatementIf*)statement;
+            bool condition;
+            if(!evaluateCondition(evaluator, ifStatement->condition, &condition)) return evaluator->state;
+            return executeStatement(evaluator, condition ? ifStatement->ifBody : ifStatement->elseBody);
+        }
+        case STATEMENT_WHILE: {
+            StatementWhile * whileStatement = (StatementWhile*)statement;
+            while(true) {
+                bool condition;
+                if(!evaluateCondition(evaluator, whileStatement->condition, &condition)) return evaluator->state;
+                if(!condition) return EVALUATION_NEXT;
+                EvaluationState state = executeStatement(evaluator, whileStatement->body);
+                if(!continueLoop(evaluator, &state)) return state;
+            }
+        }
+        case STATEMENT_FOR: {
+            StatementFor * forStatement = (StatementFor*)statement;
+            if(forStatement->init != NULL && !evaluateExpression(evaluator, forStatement->init, &value)) return evaluator->state;
+            while(true) {
+                bool condition = true;
+                if(forStatement->condition != NULL && !evaluateCondition(evaluator, forStatement->condition, &condition)) return evaluator->state;
+                if(!condition) return EVALUATION_NEXT;
+                EvaluationState state = executeStatement(evaluator, forStatement->body);
+                if(!continueLoop(evaluator, &state)) return state;
+                if(forStatement->increment != NULL && !evaluateExpression(evaluator, forStatement->increment, &value)) return evaluator->state;
+            }
+        }
+        case STATEMENT_BREAK:
+            evaluator->jumpDepth = ((StatementBreak*)statement)->depth;
+            evaluator->state = EVALUATION_BREAK;
+            return EVALUATION_BREAK;
+        case STATEMENT_CONTINUE:
+            evaluator->jumpDepth = ((StatementContinue*)statement)->depth;
+            evaluator->state = EVALUATION_CONTINUE;
+            return EVALUATION_CONTINUE;
+        case STATEMENT_RETURN: {
+            StatementReturn * returnStatement = (StatementReturn*)statement;
+            value = createNullValue();
+            if(returnStatement->expression != NULL && !evaluateExpression(evaluator, returnStatement->expression, &value)) return evaluator->state;
+            // return from main program ends it
+            if(evaluator->function == NULL) {
+                exitEvaluation(evaluator, 0);
+                return EVALUATION_EXIT;
+            }
+            if(returnStatement->expression != NULL && !isValueOfType(value, evaluator->function->returnType)) {
+                giveUpEvaluation(evaluator);
+                return EVALUATION_UNKNOWN;
+            }
+            evaluator->returnValue = value;
+            evaluator->state = EVALUATION_RETURN;
+            return EVALUATION_RETURN;
+        }
+        case STATEMENT_EXIT:
+            exitEvaluation(evaluator, ((StatementExit*)statement)->exitCode);
+            return EVALUATION_EXIT;
+        default:
+            giveUpEvaluation(evaluator);
+            return EVALUATION_UNKNOWN;
+    }
+}
+
+/**
+ * @brief Creates single write call with the collected output, neighbouring strings and ints are merged, floats and nulls are written by their constants
+ */
+Statement * createOutputWrite(Evaluator * evaluator, int outputCount) {
+    Expression__FunctionCall * write = Expression__FunctionCall__init();
+    write->name = "write";
+    StringBuilder sb;
+    StringBuilder__init(&sb);
+    for(int i=0; i<outputCount; i++) {
+        EvaluatedValue value = evaluator->output[i];
+        if(value.type.type == TYPE_STRING) {
+            StringBuilder__appendString(&sb, value.value.string);
+            continue;
+        } else if(value.type.type == TYPE_INT) {
+            StringBuilder__appendInt(&sb, value.value.integer);
+            continue;
+        }
+        if(sb.text[0] != '\0') {
+            Expression__FunctionCall__addArgument(write, (Expression*)createConstantFromValue(createStringValue(sb.text)));
+            StringBuilder__init(&sb);
+        }
+        Expression__FunctionCall__addArgument(write, (Expression*)createConstantFromValue(value));
+    }
+    if(sb.text[0] != '\0') {
+        Expression__FunctionCall__addArgument(write, (Expression*)createConstantFromValue(createStringValue(sb.text)));
+    } else {
+        StringBuilder__free(&sb);
+    }
+    return (Statement*)write;
+}
+
+/**
+ * @brief Executes the program during compilation, statements are executed one by one while their result doesnt depend on input
+ * @note executed statements are replaced by write of their output and by assignments of the resulting variable values,
+ * program which ends during the execution is replaced by its output and exit
+ *
+ * @param program
+ * @param functionTable
+ * @return true if any statement was executed
+ */
+bool evaluateProgram(StatementList * program, Table * functionTable) {
+    Evaluator evaluator = {0};
+    evaluator.functionTable = functionTable;
+    evaluator.program = program;
+    evaluator.resultTable = pointer_table_init();
+    evaluator.variables = table_init();
+    evaluator.fuel = EVALUATION_FUEL;
+    evaluator.state = EVALUATION_NEXT;
+    int executedCount = 0;
+    int outputCount = 0;
+    Table * variables = copyVariables(evaluator.variables);
+    while(executedCount < program->listSize) {
+        EvaluationState state = executeStatement(&evaluator, program->statements[executedCount]);
+        if(state == EVALUATION_UNKNOWN || state == EVALUATION_BREAK || state == EVALUATION_CONTINUE || state == EVALUATION_RETURN) break;
+        executedCount++;
+        outputCount = evaluator.outputCount;
+        freeVariables(variables);
+        variables = copyVariables(evaluator.variables);
+        if(state == EVALUATION_EXIT) break;
+    }
+    bool changed = executedCount > 0;
+    if(changed) {
+        StatementList * result = StatementList__init();
+        if(outputCount > 0) StatementList__addStatement(result, createOutputWrite(&evaluator, outputCount));
+        if(evaluator.state == EVALUATION_EXIT) {
+            StatementExit * exit = StatementExit__init();
+            exit->exitCode = evaluator.exitCode;
+            StatementList__addStatement(result, (Statement*)exit);
+        } else {
+            // state of the unfinished program is restored by assignments
+            for(int i=0; i<TB_SIZE; i++) {
+                for(TableItem * item = variables->tb[i]; item != NULL; item = item->next) {
+                    Expression__Variable * variable = Expression__Variable__init();
+                    variable->name = item->name;
+                    Expression__BinaryOperator * assignment = Expression__BinaryOperator__init();
+                    assignment->operator = TOKEN_ASSIGN;
+                    assignment->lSide = (Expression*)variable;
+                    assignment->rSide = (Expression*)createConstantFromValue(*(EvaluatedValue*)item->data);
+                    StatementList__addStatement(result, (Statement*)assignment);
+                }
+            }
+            for(int i=executedCount; i<program->listSize; i++) {
+                StatementList__addStatement(result, program->statements[i]);
+            }
+        }
+        program->listSize = result->listSize;
+        program->statements = result->statements;
+        free(result);
+        invalidateResultsType(evaluator.resultTable, (Statement*)program);
+    }
+    free(evaluator.output);
+    freeVariables(variables);
+    freeVariables(evaluator.variables);
+    pointer_table_free(evaluator.resultTable);
+    return changed;
+}
+
+/**
+ * @brief Creates key of the call for cache of evaluated calls, strings are prefixed by their length, so keys of different calls differ
+ */
+char * createEvaluatedCallKey(char * name, EvaluatedValue * arguments, int arity) {
+    StringBuilder sb;
+    StringBuilder__init(&sb);
+    StringBuilder__appendString(&sb, name);
+    char buffer[64];
+    for(int i=0; i<arity; i++) {
+        switch(arguments[i].type.type) {
+            case TYPE_INT:
+                snprintf(buffer, sizeof(buffer), "|i%lld", arguments[i].value.integer);
+                break;
+            case TYPE_FLOAT:
+                snprintf(buffer, sizeof(buffer), "|f%a", arguments[i].value.real);
+                break;
+            case TYPE_STRING:
+                snprintf(buffer, sizeof(buffer), "|s%zu:", strlen(arguments[i].value.string));
+                break;
+            case TYPE_BOOL:
+                snprintf(buffer, sizeof(buffer), "|b%d", arguments[i].value.boolean);
+                break;
+            default:
+                snprintf(buffer, sizeof(buffer), "|n");
+                break;
+        }
+        StringBuilder__appendString(&sb, buffer);
+        if(arguments[i].type.type == TYPE_STRING) StringBuilder__appendString(&sb, arguments[i].value.string);
+    }
+    return sb.text;
+}
+
+/**
+ * @brief Evaluates call with constant arguments, call succeeds only if it doesnt write, read or end the program
+ *
+ * @return value of the call or NULL if it cant be evaluated, results are cached in evaluatedCalls
+ */
+EvaluatedValue * evaluateConstantCall(Expression__FunctionCall * call, Function * function, Table * functionTable, StatementList * program, Table * evaluatedCalls) {
+    EvaluatedValue * arguments = malloc(sizeof(EvaluatedValue) * (call->arity + 1));
+    for(int i=0; i<call->arity; i++) {
+        Expression__Constant * constant = (Expression__Constant*)call->arguments[i];
+        arguments[i].type = constant->type;
+        switch(constant->type.type) {
+            case TYPE_INT:
+                arguments[i].value.integer = constant->value.integer;
+                break;
+            case TYPE_FLOAT:
+                arguments[i].value.real = constant->value.real;
+                break;
+            case TYPE_STRING:
+                arguments[i].value.string = constant->value.string;
+                break;
+            case TYPE_BOOL:
+                arguments[i].value.boolean = constant->value.boolean;
+                break;
+            default:
+                arguments[i] = createNullValue();
+                break;
+        }
+    }
+    char * key = createEvaluatedCallKey(call->name, arguments, call->arity);
+    TableItem * item = table_find(evaluatedCalls, key);
+    if(item != NULL) {
+        free(key);
+        free(arguments);
+        return (EvaluatedValue*)item->data;
+    }
+    Evaluator evaluator = {0};
+    evaluator.functionTable = functionTable;
+    evaluator.program = program;
+    evaluator.resultTable = pointer_table_init();
+    evaluator.variables = table_init();
+    evaluator.fuel = EVALUATION_CALL_FUEL;
+    evaluator.state = EVALUATION_NEXT;
+    EvaluatedValue value;
+    bool success;
+    if(function->body == NULL) {
+        success = evaluateBuiltinCall(&evaluator, function, arguments, call->arity, &value);
+    } else {
+        success = evaluateUserCall(&evaluator, function, arguments, call->arity, &value);
+    }
+    EvaluatedValue * result = NULL;
+    if(success && evaluator.outputCount == 0) {
+        result = malloc(sizeof(EvaluatedValue));
+        *result = value;
+    }
+    table_insert(evaluatedCalls, key, result);
+    free(evaluator.output);
+    freeVariables(evaluator.variables);
+    pointer_table_free(evaluator.resultTable);
+    free(arguments);
+    return result;
+}
+
+bool foldConstantCallsInStatement(Statement ** slot, Table * functionTable, StatementList * program, Table * evaluatedCalls) {
+    if(slot == NULL || *slot == NULL) return false;
+    Statement * statement = *slot;
+    bool changed = false;
+    int childrenCount = 0;
+    Statement *** children = statement->getChildren(statement, &childrenCount);
+    for(int i=0; i<childrenCount; i++) {
+        changed |= foldConstantCallsInStatement(children[i], functionTable, program, evaluatedCalls);
+    }
+    free(children);
+    if(statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_FUNCTION_CALL) return changed;
+    Expression__FunctionCall * call = (Expression__FunctionCall*)statement;
+    TableItem * item = table_find(functionTable, call->name);
+    if(item == NULL || strcmp(call->name, "write") == 0) return changed;
+    Function * function = (Function*)item->data;
+    if(function->body == NULL && !isPureBuiltinFunction(call->name)) return changed;
+    for(int i=0; i<call->arity; i++) {
+        if(call->arguments[i]->expressionType != EXPRESSION_CONSTANT) return changed;
+    }
+    EvaluatedValue * value = evaluateConstantCall(call, function, functionTable, program, evaluatedCalls);
+    if(value == NULL) return changed;
+    EvaluatedValue copy = *value;
+    if(copy.type.type == TYPE_STRING) copy.value.string = strdup(copy.value.string);
+    *slot = (Statement*)createConstantFromValue(copy);
+    return true;
+}
+
+/**
+ * @brief Replaces calls of functions with constant arguments by their result, evaluated functions cant write, read or end the program
+ * @note functions are evaluated with limited fuel, results and failures are cached by function name and arguments
+ *
+ * @param body
+ * @param function function owning the body, NULL for main program
+ * @param functionTable
+ * @param program
+ * @param resultTable
+ * @param evaluatedCalls cache of evaluated calls shared by all bodies
+ * @return true if the body was changed
+ */
+bool foldConstantCalls(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable, Table * evaluatedCalls) {
+    if(!foldConstantCallsInStatement(body, functionTable, program, evaluatedCalls)) return false;
+    invalidateResultsType(resultTable, function != NULL ? (Statement*)function : (Statement*)program);
+    return true;
+}
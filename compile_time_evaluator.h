@@ -0,0 +1,18 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file compile_time_evaluator.h
+ * @brief Header file for compile time execution of the program
+ */
+
+#ifndef __COMPILE_TIME_EVALUATOR_H__
+#define __COMPILE_TIME_EVALUATOR_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+#include "pointer_hashtable.h"
+
+bool evaluateProgram(StatementList * program, Table * functionTable);
+bool foldConstantCalls(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable, Table * evaluatedCalls);
+
+#endif // __COMPILE_TIME_EVALUATOR_H__
@@ -0,0 +1,266 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file control_flow.c
+ * @brief Cleanup of jumps and labels in generated code
+ */
+
+#include <stdbool.h>
+#include "control_flow.h"
+#include "symtable.h"
+
+#define FLOW_MAX_THREADED_JUMPS 64 /*<Maximum number of jumps followed when target of a jump is threaded>*/
+
+typedef struct {
+    int index; /*<Index of the LABEL instruction>*/
+    int referenceCount;
+} FlowLabel;
+
+/**
+ * @brief Gets label operand of label, jump or call instruction
+ *
+ * @return char* interned label, NULL if the instruction doesnt have it
+ */
+char * getFlowLabel(IRInstruction * instruction) {
+    if(instruction->opcode == IR_LABEL || instruction->opcode == IR_CALL || isIRJump(instruction->opcode)) {
+        return instruction->operands[0].value.label;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Checks if the instruction isnt executed, that is it is removed, comment or label
+ */
+bool isFlowSkipped(IRInstruction * instruction) {
+    return instruction->opcode == IR_NOP || instruction->opcode == IR_COMMENT || instruction->opcode == IR_LABEL;
+}
+
+/**
+ * @brief Gets index of the first instruction from the index which is executed
+ */
+int getNextExecutedInstruction(IRList * program, int index) {
+    while(index < program->count && isFlowSkipped(&program->instructions[index])) {
+        index++;
+    }
+    return index;
+}
+
+/**
+ * @brief Checks if the label is placed between the instruction and the next executed instruction
+ */
+bool isLabelFollowing(IRList * program, int index, char * label) {
+    for(int i=index+1; i<program->count; i++) {
+        IRInstruction * instruction = &program->instructions[i];
+        if(instruction->opcode == IR_NOP || instruction->opcode == IR_COMMENT) continue;
+        if(instruction->opcode != IR_LABEL) return false;
+        if(getFlowLabel(instruction) == label) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Decides conditional jump comparing two constants
+ *
+ * @return 1 if the jump is always taken, 0 if it is never taken, -1 if it isnt known
+ */
+int evaluateFlowCondition(IRInstruction * instruction) {
+    if(instruction->opcode != IR_JUMPIFEQ && instruction->opcode != IR_JUMPIFNEQ) return -1;
+    IROperand * first = &instruction->operands[1];
+    IROperand * second = &instruction->operands[2];
+    if(first->value.symb.type == Type_variable || second->value.symb.type == Type_variable) return -1;
+    bool isEqual;
+    if(first->value.symb.type == second->value.symb.type) {
+        isEqual = IROperand__equals(first, second);
+    } else if(first->value.symb.type == Type_null || second->value.symb.type == Type_null) {
+        isEqual = false;
+    } else {
+        // comparison of different types is runtime error which has to stay
+        return -1;
+    }
+    return isEqual == (instruction->opcode == IR_JUMPIFEQ);
+}
+
+/**
+ * @brief Gets opcode of conditional jump with negated condition
+ */
+IROpcode invertFlowCondition(IROpcode opcode) {
+    switch(opcode) {
+        case IR_JUMPIFEQ: return IR_JUMPIFNEQ;
+        case IR_JUMPIFNEQ: return IR_JUMPIFEQ;
+        case IR_JUMPIFEQS: return IR_JUMPIFNEQS;
+        default: return IR_JUMPIFEQS;
+    }
+}
+
+/**
+ * @brief Creates table of labels with counts of jumps and calls referencing them
+ */
+Table * collectFlowLabels(IRList * program, FlowLabel * labelInfos) {
+    Table * labels = table_init();
+    for(int i=0; i<program->count; i++) {
+        if(program->instructions[i].opcode != IR_LABEL) continue;
+        labelInfos[i] = (FlowLabel){.index = i, .referenceCount = 0};
+        table_insert(labels, getFlowLabel(&program->instructions[i]), &labelInfos[i]);
+    }
+    for(int i=0; i<program->count; i++) {
+        char * label = getFlowLabel(&program->instructions[i]);
+        if(label == NULL || program->instructions[i].opcode == IR_LABEL) continue;
+        TableItem * item = table_find(labels, label);
+        if(item != NULL) ((FlowLabel*)item->data)->referenceCount++;
+    }
+    return labels;
+}
+
+/**
+ * @brief Retargets jump to the final target of chain of unconditional jumps
+ */
+bool threadFlowJump(IRList * program, Table * labels, IRInstruction * jump) {
+    // labels of cycle of jumps arent visited twice, otherwise the target would change in every round
+    char * visited[FLOW_MAX_THREADED_JUMPS + 1];
+    int visitedCount = 0;
+    char * target = getFlowLabel(jump);
+    visited[visitedCount++] = target;
+    while(visitedCount <= FLOW_MAX_THREADED_JUMPS) {
+        TableItem * item = table_find(labels, target);
+        if(item == NULL) break;
+        int next = getNextExecutedInstruction(program, ((FlowLabel*)item->data)->index);
+        if(next >= program->count || program->instructions[next].opcode != IR_JUMP || &program->instructions[next] == jump) break;
+        char * nextTarget = getFlowLabel(&program->instructions[next]);
+        bool isVisited = false;
+        for(int i=0; i<visitedCount; i++) {
+            if(visited[i] == nextTarget) isVisited = true;
+        }
+        if(isVisited) break;
+        target = nextTarget;
+        visited[visitedCount++] = target;
+    }
+    if(target == getFlowLabel(jump)) return false;
+    jump->operands[0] = IROperand__label(target);
+    return true;
+}
+
+/**
+ * @brief Removes basic blocks which arent reachable from the start of the program
+ * by falling through, jumps or calls
+ *
+ * @return true if any instruction was removed
+ */
+bool removeUnreachableBlocks(IRList * program, Table * labels) {
+    int blockCount;
+    IRBlock * blocks = IRList__getBlocks(program, &blockCount);
+    if(blockCount == 0) {
+        free(blocks);
+        return false;
+    }
+    int * blockIndexes = malloc(sizeof(int) * program->count);
+    for(int i=0; i<blockCount; i++) {
+        for(int j=blocks[i].start; j<blocks[i].end; j++) blockIndexes[j] = i;
+    }
+    bool * isReachable = calloc(blockCount, sizeof(bool));
+    int * worklist = malloc(sizeof(int) * blockCount);
+    int worklistSize = 0;
+    isReachable[0] = true;
+    worklist[worklistSize++] = 0;
+    while(worklistSize > 0) {
+        IRBlock * block = &blocks[worklist[--worklistSize]];
+        bool isFallingThrough = true;
+        for(int i=block->start; i<block->end; i++) {
+            IRInstruction * instruction = &program->instructions[i];
+            if(isFlowSkipped(instruction)) continue;
+            IROpcode opcode = instruction->opcode;
+            isFallingThrough = opcode != IR_JUMP && opcode != IR_EXIT && opcode != IR_RETURN;
+            if(opcode != IR_CALL && !isIRJump(opcode)) continue;
+            TableItem * item = table_find(labels, getFlowLabel(instruction));
+            if(item == NULL) continue;
+            int target = blockIndexes[((FlowLabel*)item->data)->index];
+            if(!isReachable[target]) {
+                isReachable[target] = true;
+                worklist[worklistSize++] = target;
+            }
+        }
+        int next = block - blocks + 1;
+        if(isFallingThrough && next < blockCount && !isReachable[next]) {
+            isReachable[next] = true;
+            worklist[worklistSize++] = next;
+        }
+    }
+    bool changed = false;
+    for(int i=0; i<blockCount; i++) {
+        if(isReachable[i]) continue;
+        for(int j=blocks[i].start; j<blocks[i].end; j++) {
+            if(program->instructions[j].opcode == IR_NOP) continue;
+            program->instructions[j].opcode = IR_NOP;
+            changed = true;
+        }
+    }
+    free(worklist);
+    free(isReachable);
+    free(blockIndexes);
+    free(blocks);
+    return changed;
+}
+
+/**
+ * @brief Performs one round of all cleanups
+ *
+ * @return true if anything changed
+ */
+bool cleanupFlowRound(IRList * program, FlowLabel * labelInfos) {
+    bool changed = false;
+    Table * labels = collectFlowLabels(program, labelInfos);
+    for(int i=0; i<program->count; i++) {
+        IRInstruction * instruction = &program->instructions[i];
+        if(instruction->opcode == IR_LABEL && ((FlowLabel*)table_find(labels, getFlowLabel(instruction))->data)->referenceCount == 0) {
+            instruction->opcode = IR_NOP;
+            changed = true;
+            continue;
+        }
+        if(isIRConditionalJump(instruction->opcode)) {
+            int result = evaluateFlowCondition(instruction);
+            if(result == 0) {
+                instruction->opcode = IR_NOP;
+                changed = true;
+                continue;
+            } else if(result == 1) {
+                instruction->opcode = IR_JUMP;
+                instruction->operands[1] = instruction->operands[2] = (IROperand){.kind = IR_OPERAND_NONE};
+                changed = true;
+            }
+        }
+        if(!isIRJump(instruction->opcode)) continue;
+        changed |= threadFlowJump(program, labels, instruction);
+        if(instruction->opcode == IR_JUMP && isLabelFollowing(program, i, getFlowLabel(instruction))) {
+            instruction->opcode = IR_NOP;
+            changed = true;
+            continue;
+        }
+        // conditional jump over unconditional jump is inverted so the code falls through
+        int next = getNextExecutedInstruction(program, i + 1);
+        if(isIRConditionalJump(instruction->opcode) && next < program->count && program->instructions[next].opcode == IR_JUMP && isLabelFollowing(program, next, getFlowLabel(instruction))) {
+            bool isLabelBetween = false;
+            for(int j=i+1; j<next; j++) {
+                if(program->instructions[j].opcode == IR_LABEL) isLabelBetween = true;
+            }
+            if(!isLabelBetween) {
+                instruction->opcode = invertFlowCondition(instruction->opcode);
+                instruction->operands[0] = program->instructions[next].operands[0];
+                program->instructions[next].opcode = IR_NOP;
+                changed = true;
+            }
+        }
+    }
+    changed |= removeUnreachableBlocks(program, labels);
+    table_free(labels);
+    return changed;
+}
+
+/**
+ * @brief Threads jumps through unconditional jumps, removes jumps to the next instruction,
+ * unreachable blocks and labels which arent referenced
+ *
+ * @param program generated code, removed instructions are replaced by IR_NOP
+ */
+void cleanupControlFlow(IRList * program) {
+    FlowLabel * labelInfos = malloc(sizeof(FlowLabel) * (program->count + 1));
+    while(cleanupFlowRound(program, labelInfos));
+    free(labelInfos);
+}
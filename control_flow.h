@@ -0,0 +1,14 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file control_flow.h
+ * @brief Header file for cleanup of jumps and labels in generated code
+ */
+
+#ifndef __CONTROL_FLOW_H__
+#define __CONTROL_FLOW_H__
+
+#include "ir.h"
+
+void cleanupControlFlow(IRList * program);
+
+#endif // __CONTROL_FLOW_H__
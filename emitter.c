@@ -8,505 +8,294 @@
 
 #include <stddef.h>
 #include <stdio.h>
-#include <ctype.h>
+#include <stdlib.h>
 #include "emitter.h"
-#include "string_builder.h"
+#include "ir.h"
+#include "control_flow.h"
+
+IRList programList;
+IRList instructionList;
+IRList defVarList;
 
 void emit_header() {
-	printf(".IFJcode22\n");
+	IRList__init(&programList);
+	IRList__init(&instructionList);
+	IRList__init(&defVarList);
 }
 
-StringBuilder instructionBuilder;
-
-void emit_instruction_start() {
-	StringBuilder__init(&instructionBuilder);
+/**
+ * @brief Marks that the next chunk of instructions belongs to a new function
+ */
+void emit_function_start() {
+	IRList__startFunction(&programList);
 }
 
-void emit_instruction_end() {
-	printf("%s", instructionBuilder.text);
-	StringBuilder__free(&instructionBuilder);
-}
-
-void emit_type(StorageType type) {
-	char * typeName = NULL;
-	switch(type) {
-		case Type_int:		typeName = "int";	break;
-		case Type_bool:		typeName = "bool";	break;
-		case Type_float:	typeName = "float";	break;
-		case Type_string:	typeName = "string";	break;
-		case Type_null: 	typeName = "nil";	break;
-		case Type_variable:	typeName = "variable";	break;
-	}
-	StringBuilder__appendString(&instructionBuilder, typeName);
+/**
+ * @brief Prints the whole generated code after cleanup of its jumps and labels
+ */
+void emit_close() {
+	cleanupControlFlow(&programList);
+	char * code = IRList__toString(&programList);
+	printf("%s", code);
+	free(code);
+	IRList__free(&programList);
+	IRList__free(&instructionList);
+	IRList__free(&defVarList);
+	freeIRStrings();
 }
 
-void emit_var(Var var) {
-	char * frameName = NULL;
-	switch(var.frameType) {
-		case LF: frameName = "LF"; break;
-		case TF: frameName = "TF"; break;
-		case GF: frameName = "GF"; break;
-	}
-	StringBuilder__appendString(&instructionBuilder, frameName);
-	StringBuilder__appendChar(&instructionBuilder, '@');
-	StringBuilder__appendString(&instructionBuilder, var.name);;
-}
-
-void emit_string(char * string) {
-	StringBuilder__appendString(&instructionBuilder, "string@");
-	while(*string) {
-		if(isspace(*string) || *string == '#' || *string == '\\' || *string < 32) {
-			unsigned int c = (unsigned int)(unsigned char)*string;
-			StringBuilder__appendChar(&instructionBuilder, '\\');
-			StringBuilder__appendInt(&instructionBuilder, c/100);
-			c %= 100;
-			StringBuilder__appendInt(&instructionBuilder, c/10);
-			c %= 10;
-			StringBuilder__appendInt(&instructionBuilder, c);
-		} else {
-			StringBuilder__appendChar(&instructionBuilder, *string);
-		}
-		string++;
-	}
+void emit_instruction_start() {
+	instructionList.count = 0;
 }
 
-void emit_symb(Symb symb) {
-	switch(symb.type) {
-		case Type_int: {
-			StringBuilder__appendString(&instructionBuilder, "int@");
-			StringBuilder__appendInt(&instructionBuilder, symb.value.i);
-			break;
-		}
-		case Type_bool:	{
-			StringBuilder__appendString(&instructionBuilder, "bool@");
-			StringBuilder__appendString(&instructionBuilder, symb.value.b ? "true" : "false");
-			break;
-		}
-		case Type_float: {
-			StringBuilder__appendString(&instructionBuilder, "float@");
-			StringBuilder__appendFloat(&instructionBuilder, symb.value.f);
-			break;
-		}
-		case Type_string: {
-			emit_string(symb.value.s);
-			break;
-		}
-		case Type_null: {
-			StringBuilder__appendString(&instructionBuilder, "nil@nil");
-			break;
-		}
-		case Type_variable:	{
-			emit_var(symb.value.v);
-			break;
-		}
-	}
+void emit_instruction_end() {
+	IRList__addList(&programList, &instructionList);
+	instructionList.count = 0;
 }
 
-void emit_label(char * label) {
-	StringBuilder__appendString(&instructionBuilder, label);
+IROperand noOperand = {.kind = IR_OPERAND_NONE};
+
+void emit_instruction(IROpcode opcode, IROperand first, IROperand second, IROperand third) {
+	IRList__add(&instructionList, opcode, first, second, third);
 }
 
 void emit_MOVE(Var var, Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "MOVE ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_MOVE, IROperand__var(var), IROperand__symb(symb), noOperand);
 }
 
 void emit_CREATEFRAME() {
-	StringBuilder__appendString(&instructionBuilder, "CREATEFRAME\n");
+	emit_instruction(IR_CREATEFRAME, noOperand, noOperand, noOperand);
 }
 
 void emit_PUSHFRAME() {
-	StringBuilder__appendString(&instructionBuilder, "PUSHFRAME\n");
+	emit_instruction(IR_PUSHFRAME, noOperand, noOperand, noOperand);
 }
 
 void emit_POPFRAME() {
-	StringBuilder__appendString(&instructionBuilder, "POPFRAME\n");
+	emit_instruction(IR_POPFRAME, noOperand, noOperand, noOperand);
 }
 
-StringBuilder defVarBuilder;
-
 void emit_DEFVAR_start() {
-	StringBuilder__init(&defVarBuilder);
+	defVarList.count = 0;
 }
 
 void emit_DEFVAR(Var var) {
 	if(var.frameType != TF) {
-		StringBuilder__appendString(&defVarBuilder, "DEFVAR ");
-		char * frameName = NULL;
-		switch(var.frameType) {
-			case LF: frameName = "LF"; break;
-			case TF: frameName = "TF"; break;
-			case GF: frameName = "GF"; break;
-		}
-		StringBuilder__appendString(&defVarBuilder, frameName);
-		StringBuilder__appendChar(&defVarBuilder, '@');
-		StringBuilder__appendString(&defVarBuilder, var.name);
-		StringBuilder__appendString(&defVarBuilder, "\n");
+		IRList__add(&defVarList, IR_DEFVAR, IROperand__var(var), noOperand, noOperand);
 	} else {
-		StringBuilder__appendString(&instructionBuilder, "DEFVAR TF@");
-		StringBuilder__appendString(&instructionBuilder, var.name);
-		StringBuilder__appendString(&instructionBuilder, "\n");
+		emit_instruction(IR_DEFVAR, IROperand__var(var), noOperand, noOperand);
 	}
 }
 
 void emit_DEFVAR_end() {
-	printf("%s", defVarBuilder.text);
-	StringBuilder__free(&defVarBuilder);
+	IRList__addList(&programList, &defVarList);
+	defVarList.count = 0;
 }
 
 void emit_CALL(char * label) {
-	StringBuilder__appendString(&instructionBuilder, "CALL ");
-	StringBuilder__appendString(&instructionBuilder, label);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_CALL, IROperand__label(label), noOperand, noOperand);
 }
 
 void emit_RETURN() {
-	StringBuilder__appendString(&instructionBuilder, "RETURN\n");
+	emit_instruction(IR_RETURN, noOperand, noOperand, noOperand);
 }
 
 void emit_PUSHS(Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "PUSHS ");
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_PUSHS, IROperand__symb(symb), noOperand, noOperand);
 }
 
 void emit_POPS(Var var) {
-	StringBuilder__appendString(&instructionBuilder, "POPS ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_POPS, IROperand__var(var), noOperand, noOperand);
 }
 
 void emit_CLEARS() {
-	StringBuilder__appendString(&instructionBuilder, "CLEARS\n");
+	emit_instruction(IR_CLEARS, noOperand, noOperand, noOperand);
 }
 
 void emit_ADD(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "ADD ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_ADD, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_SUB(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "SUB ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_SUB, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_MUL(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "MUL ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_MUL, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_DIV(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "DIV ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_DIV, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_IDIV(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "IDIV ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_IDIV, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_ADDS() {
-	StringBuilder__appendString(&instructionBuilder, "ADDS\n");
+	emit_instruction(IR_ADDS, noOperand, noOperand, noOperand);
 }
 
 void emit_SUBS() {
-	StringBuilder__appendString(&instructionBuilder, "SUBS\n");
+	emit_instruction(IR_SUBS, noOperand, noOperand, noOperand);
 }
 
 void emit_MULS() {
-	StringBuilder__appendString(&instructionBuilder, "MULS\n");
+	emit_instruction(IR_MULS, noOperand, noOperand, noOperand);
 }
 
 void emit_DIVS() {
-	StringBuilder__appendString(&instructionBuilder, "DIVS\n");
+	emit_instruction(IR_DIVS, noOperand, noOperand, noOperand);
 }
 
 void emit_IDIVS() {
-	StringBuilder__appendString(&instructionBuilder, "IDIVS\n");
+	emit_instruction(IR_IDIVS, noOperand, noOperand, noOperand);
 }
 
 void emit_LT(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "LT ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_LT, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_GT(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "GT ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_GT, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_EQ(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "EQ ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_EQ, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_LTS() {
-	StringBuilder__appendString(&instructionBuilder, "LTS\n");
+	emit_instruction(IR_LTS, noOperand, noOperand, noOperand);
 }
 
 void emit_GTS() {
-	StringBuilder__appendString(&instructionBuilder, "GTS\n");
+	emit_instruction(IR_GTS, noOperand, noOperand, noOperand);
 }
 
 void emit_EQS() {
-	StringBuilder__appendString(&instructionBuilder, "EQS\n");
+	emit_instruction(IR_EQS, noOperand, noOperand, noOperand);
 }
 
 void emit_AND(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "AND ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_AND, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_OR(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "OR ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_OR, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_NOT(Var var, Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "NOT ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_NOT, IROperand__var(var), IROperand__symb(symb), noOperand);
 }
 
 void emit_ANDS() {
-	StringBuilder__appendString(&instructionBuilder, "ANDS\n");
+	emit_instruction(IR_ANDS, noOperand, noOperand, noOperand);
 }
 
 void emit_ORS() {
-	StringBuilder__appendString(&instructionBuilder, "ORS\n");
+	emit_instruction(IR_ORS, noOperand, noOperand, noOperand);
 }
 
 void emit_NOTS() {
-	StringBuilder__appendString(&instructionBuilder, "NOTS\n");
+	emit_instruction(IR_NOTS, noOperand, noOperand, noOperand);
 }
 
 void emit_INT2FLOAT(Var var, Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "INT2FLOAT ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_INT2FLOAT, IROperand__var(var), IROperand__symb(symb), noOperand);
 }
 
 void emit_FLOAT2INT(Var var, Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "FLOAT2INT ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_FLOAT2INT, IROperand__var(var), IROperand__symb(symb), noOperand);
 }
 
 void emit_INT2CHAR(Var var, Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "INT2CHAR ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_INT2CHAR, IROperand__var(var), IROperand__symb(symb), noOperand);
 }
 
 void emit_STRI2INT(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "STRI2INT ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_STRI2INT, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_INT2FLOATS() {
-	StringBuilder__appendString(&instructionBuilder, "INT2FLOATS\n");
+	emit_instruction(IR_INT2FLOATS, noOperand, noOperand, noOperand);
 }
 
 void emit_FLOAT2INTS() {
-	StringBuilder__appendString(&instructionBuilder, "FLOAT2INTS\n");
+	emit_instruction(IR_FLOAT2INTS, noOperand, noOperand, noOperand);
 }
 
 void emit_INT2CHARS() {
-	StringBuilder__appendString(&instructionBuilder, "INT2CHARS\n");
+	emit_instruction(IR_INT2CHARS, noOperand, noOperand, noOperand);
 }
 
 void emit_STRI2INTS() {
-	StringBuilder__appendString(&instructionBuilder, "STRI2INTS\n");
+	emit_instruction(IR_STRI2INTS, noOperand, noOperand, noOperand);
 }
 
 void emit_READ(Var var, StorageType type) {
-	StringBuilder__appendString(&instructionBuilder, "READ ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_type(type);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_READ, IROperand__var(var), IROperand__type(type), noOperand);
 }
 
 void emit_WRITE(Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "WRITE ");
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_WRITE, IROperand__symb(symb), noOperand, noOperand);
 }
 
 void emit_CONCAT(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "CONCAT ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_CONCAT, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_STRLEN(Var var, Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "STRLEN ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_STRLEN, IROperand__var(var), IROperand__symb(symb), noOperand);
 }
 
 void emit_GETCHAR(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "GETCHAR ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_GETCHAR, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_SETCHAR(Var var, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "SETCHAR ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_SETCHAR, IROperand__var(var), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_TYPE(Var var, Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "TYPE ");
-	emit_var(var);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_TYPE, IROperand__var(var), IROperand__symb(symb), noOperand);
 }
 
-void emit_LABEL(char *label) {
-	StringBuilder__appendString(&instructionBuilder, "LABEL ");
-	StringBuilder__appendString(&instructionBuilder, label);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+void emit_LABEL(char * label) {
+	emit_instruction(IR_LABEL, IROperand__label(label), noOperand, noOperand);
 }
 
-void emit_JUMP(char *label) {
-	StringBuilder__appendString(&instructionBuilder, "JUMP ");
-	StringBuilder__appendString(&instructionBuilder, label);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+void emit_JUMP(char * label) {
+	emit_instruction(IR_JUMP, IROperand__label(label), noOperand, noOperand);
 }
 
-void emit_JUMPIFEQ(char *label, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "JUMPIFEQ ");
-	emit_label(label);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+void emit_JUMPIFEQ(char * label, Symb symb1, Symb symb2) {
+	emit_instruction(IR_JUMPIFEQ, IROperand__label(label), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
-void emit_JUMPIFNEQ(char *label, Symb symb1, Symb symb2) {
-	StringBuilder__appendString(&instructionBuilder, "JUMPIFNEQ ");
-	emit_label(label);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb1);
-	StringBuilder__appendChar(&instructionBuilder, ' ');
-	emit_symb(symb2);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+void emit_JUMPIFNEQ(char * label, Symb symb1, Symb symb2) {
+	emit_instruction(IR_JUMPIFNEQ, IROperand__label(label), IROperand__symb(symb1), IROperand__symb(symb2));
 }
 
 void emit_JUMPIFEQS(char * label) {
-	StringBuilder__appendString(&instructionBuilder, "JUMPIFEQS ");
-	emit_label(label);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_JUMPIFEQS, IROperand__label(label), noOperand, noOperand);
 }
 
 void emit_JUMPIFNEQS(char * label) {
-	StringBuilder__appendString(&instructionBuilder, "JUMPIFNEQS ");
-	emit_label(label);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_JUMPIFNEQS, IROperand__label(label), noOperand, noOperand);
 }
 
 void emit_EXIT(Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "EXIT ");
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_EXIT, IROperand__symb(symb), noOperand, noOperand);
 }
 
 void emit_BREAK() {
-	StringBuilder__appendString(&instructionBuilder, "BREAK\n");
+	emit_instruction(IR_BREAK, noOperand, noOperand, noOperand);
 }
 
 void emit_DPRINT(Symb symb) {
-	StringBuilder__appendString(&instructionBuilder, "DPRINT ");
-	emit_symb(symb);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
+	emit_instruction(IR_DPRINT, IROperand__symb(symb), noOperand, noOperand);
 }
 
-void emit_COMMENT(char *comment) {
-	StringBuilder__appendString(&instructionBuilder, "# ");
-	StringBuilder__appendString(&instructionBuilder, comment);
-	StringBuilder__appendChar(&instructionBuilder, '\n');
-}
\ No newline at end of file
+void emit_COMMENT(char * comment) {
+	emit_instruction(IR_COMMENT, IROperand__text(comment), noOperand, noOperand);
+}
@@ -106,6 +106,7 @@ void emit_DPRINT(Symb symb);
 void emit_COMMENT(char * comment);
 
 void emit_init();
+void emit_function_start();
 void emit_close();
 
 #endif // __EMITTER_H__
\ No newline at end of file
@@ -0,0 +1,568 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file induction_variables.c
+ * @brief Induction variable recognition and strength reduction of while and for loops
+ */
+
+#include "induction_variables.h"
+#include "string_builder.h"
+
+#define INDUCTION_MAX_CONSTANT 1000000 /*<Bigger steps and coefficients arent reduced to avoid overflow>*/
+
+typedef struct {
+    bool isValid; /*<Variable is changed only by updates with constant step>*/
+    bool isUpdatedByIncrement; /*<Updated by increment of for loop, derived variables are updated at the start of body then>*/
+    long long incrementStep;
+} BasicInductionVariable;
+
+typedef struct {
+    Statement * statement; /*<Update statement, $i++ or $i = $i + c>*/
+    StatementList * list; /*<List containing the statement, NULL for increment of for loop>*/
+    char * name;
+    long long step;
+    Expression * read; /*<Read of the variable in the update>*/
+} InductionUpdate;
+
+typedef struct {
+    char * basicName; /*<Basic induction variable the value is derived from>*/
+    long long coefficient; /*<Change of the value when the basic variable changes by one>*/
+    char * key; /*<Serialized derived expression, equal expressions share one variable>*/
+    Expression__Variable * variable;
+} DerivedInductionVariable;
+
+typedef struct {
+    char * name; /*<Basic induction variable of the expression, NULL if the expression is invariant>*/
+    int operationCount;
+    bool hasTypeDispatch; /*<Some operand isnt known to be int, so the operation checks its type at runtime>*/
+} AffineForm;
+
+typedef struct {
+    Expression ** slot;
+    char * key; /*<Serialized expression>*/
+    char * basicName;
+    long long coefficient;
+    int cost; /*<Estimated number of instructions saved by one replacement of the expression>*/
+} InductionCandidate;
+
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    Function * function;
+    PointerTable * resultTable;
+    Table * variables; /*<BasicInductionVariable of every variable assigned in the processed loop>*/
+    InductionUpdate * updates;
+    int updateCount;
+    DerivedInductionVariable * derived;
+    int derivedCount;
+    InductionCandidate * candidates;
+    int candidateCount;
+    StatementList * preheader; /*<Initializations of derived variables, placed before the processed loop>*/
+    int reducedCount;
+} InductionReduction;
+
+/**
+ * @brief Get the next unique id of derived induction variable
+ *
+ * @return size_t
+ */
+size_t getNextInductionUID() {
+    static size_t inductionUID = 0;
+    return inductionUID++;
+}
+
+UnionType getInductionType(InductionReduction * reduction, Expression * expression) {
+    return expression->getType(expression, reduction->functionTable, reduction->program, reduction->function, reduction->resultTable);
+}
+
+/**
+ * @brief Checks if the value is int or converts to int without errors in arithmetic operations, null and bool do
+ */
+bool isIntCompatible(UnionType type) {
+    return type.isInt && !type.isFloat && !type.isString && !type.isUndefined;
+}
+
+bool isIntConstant(Expression * expression) {
+    return expression->expressionType == EXPRESSION_CONSTANT && ((Expression__Constant*)expression)->type.type == TYPE_INT;
+}
+
+long long getIntConstant(Expression * expression) {
+    return ((Expression__Constant*)expression)->value.integer;
+}
+
+/**
+ * @brief Recognizes $i++, ++$i, $i--, --$i, $i = $i +- c and $i = c + $i
+ *
+ * @param expression
+ * @param name name of the updated variable
+ * @param step
+ * @param read read of the variable used by the update
+ * @return true if the expression is update of induction variable
+ */
+bool getInductionUpdate(Expression * expression, char ** name, long long * step, Expression ** read) {
+    switch(expression->expressionType) {
+        case EXPRESSION_POSTFIX_OPERATOR: {
+            Expression__PostfixOperator * op = (Expression__PostfixOperator*)expression;
+            if(op->operand->expressionType != EXPRESSION_VARIABLE) return false;
+            *name = ((Expression__Variable*)op->operand)->name;
+            *step = op->operator == TOKEN_INCREMENT ? 1 : -1;
+            *read = op->operand;
+            return true;
+        }
+        case EXPRESSION_PREFIX_OPERATOR: {
+            Expression__PrefixOperator * op = (Expression__PrefixOperator*)expression;
+            if((op->operator != TOKEN_INCREMENT && op->operator != TOKEN_DECREMENT) || op->rSide->expressionType != EXPRESSION_VARIABLE) return false;
+            *name = ((Expression__Variable*)op->rSide)->name;
+            *step = op->operator == TOKEN_INCREMENT ? 1 : -1;
+            *read = op->rSide;
+            return true;
+        }
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * assignment = (Expression__BinaryOperator*)expression;
+            if(assignment->operator != TOKEN_ASSIGN || assignment->lSide->expressionType != EXPRESSION_VARIABLE) return false;
+            if(assignment->rSide->expressionType != EXPRESSION_BINARY_OPERATOR) return false;
+            *name = ((Expression__Variable*)assignment->lSide)->name;
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)assignment->rSide;
+            Expression * variable;
+            Expression * constant;
+            if(op->operator == TOKEN_PLUS && isIntConstant(op->lSide)) {
+                variable = op->rSide;
+                constant = op->lSide;
+            } else if(op->operator == TOKEN_PLUS || op->operator == TOKEN_MINUS) {
+                variable = op->lSide;
+                constant = op->rSide;
+            } else {
+                return false;
+            }
+            if(variable->expressionType != EXPRESSION_VARIABLE || strcmp(((Expression__Variable*)variable)->name, *name) != 0 || !isIntConstant(constant)) return false;
+            *step = op->operator == TOKEN_MINUS ? -getIntConstant(constant) : getIntConstant(constant);
+            *read = variable;
+            return *step >= -INDUCTION_MAX_CONSTANT && *step <= INDUCTION_MAX_CONSTANT;
+        }
+        default:
+            return false;
+    }
+}
+
+void addInductionUpdate(InductionReduction * reduction, Statement * statement, StatementList * list) {
+    if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION) return;
+    InductionUpdate update = {.statement = statement, .list = list};
+    if(!getInductionUpdate((Expression*)statement, &update.name, &update.step, &update.read)) return;
+    reduction->updates = realloc(reduction->updates, sizeof(InductionUpdate) * (reduction->updateCount + 1));
+    reduction->updates[reduction->updateCount++] = update;
+}
+
+/**
+ * @brief Finds update statements of the loop body, updates inside expressions arent recognized
+ */
+void collectInductionUpdates(InductionReduction * reduction, Statement * statement) {
+    if(statement == NULL || statement->statementType == STATEMENT_EXPRESSION) return;
+    if(statement->statementType == STATEMENT_LIST) {
+        StatementList * list = (StatementList*)statement;
+        for(int i=0; i<list->listSize; i++) {
+            addInductionUpdate(reduction, list->statements[i], list);
+        }
+    }
+    int childrenCount = 0;
+    Statement *** children = statement->getChildren(statement, &childrenCount);
+    for(int i=0; i<childrenCount; i++) {
+        collectInductionUpdates(reduction, *children[i]);
+    }
+    free(children);
+}
+
+InductionUpdate * findInductionUpdate(InductionReduction * reduction, Statement * statement) {
+    for(int i=0; i<reduction->updateCount; i++) {
+        if(reduction->updates[i].statement == statement) return &reduction->updates[i];
+    }
+    return NULL;
+}
+
+BasicInductionVariable * getBasicInductionVariable(InductionReduction * reduction, char * name) {
+    TableItem * item = table_find(reduction->variables, name);
+    if(item != NULL) return (BasicInductionVariable*)item->data;
+    BasicInductionVariable * variable = malloc(sizeof(BasicInductionVariable));
+    *variable = (BasicInductionVariable){.isValid = true, .isUpdatedByIncrement = false, .incrementStep = 0};
+    table_insert(reduction->variables, name, variable);
+    return variable;
+}
+
+void markAssignedVariable(InductionReduction * reduction, Statement * statement) {
+    if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION) return;
+    Expression * expression = (Expression*)statement;
+    Expression * target = NULL;
+    if(expression->expressionType == EXPRESSION_BINARY_OPERATOR && ((Expression__BinaryOperator*)expression)->operator == TOKEN_ASSIGN) {
+        target = ((Expression__BinaryOperator*)expression)->lSide;
+    } else if(expression->expressionType == EXPRESSION_POSTFIX_OPERATOR) {
+        target = ((Expression__PostfixOperator*)expression)->operand;
+    } else if(expression->expressionType == EXPRESSION_PREFIX_OPERATOR) {
+        target = ((Expression__PrefixOperator*)expression)->rSide;
+    }
+    if(target == NULL || target->expressionType != EXPRESSION_VARIABLE) return;
+    BasicInductionVariable * variable = getBasicInductionVariable(reduction, ((Expression__Variable*)target)->name);
+    // every other assignment makes the value unpredictable
+    if(findInductionUpdate(reduction, statement) == NULL) variable->isValid = false;
+}
+
+void markAssignedVariables(InductionReduction * reduction, Statement * statement) {
+    if(statement == NULL) return;
+    markAssignedVariable(reduction, statement);
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(statement, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        markAssignedVariable(reduction, *allStatements[i]);
+    }
+    free(allStatements);
+}
+
+/**
+ * @brief Checks if the expression is a * $i + b, where $i is basic induction variable, a is constant and b is invariant
+ *
+ * @param reduction
+ * @param expression
+ * @param form basic variable and cost of the expression
+ * @param coefficient a
+ * @return true if the expression has the form and its value is always int
+ */
+bool getAffineForm(InductionReduction * reduction, Expression * expression, AffineForm * form, long long * coefficient) {
+    switch(expression->expressionType) {
+        case EXPRESSION_CONSTANT:
+            *coefficient = 0;
+            return isIntConstant(expression);
+        case EXPRESSION_VARIABLE: {
+            char * name = ((Expression__Variable*)expression)->name;
+            UnionType type = getInductionType(reduction, expression);
+            TableItem * item = table_find(reduction->variables, name);
+            if(!isIntCompatible(type)) return false;
+            form->hasTypeDispatch |= type.isNull || type.isBool;
+            if(item == NULL) {
+                *coefficient = 0;
+                return true;
+            }
+            if(!((BasicInductionVariable*)item->data)->isValid) return false;
+            if(form->name != NULL && strcmp(form->name, name) != 0) return false;
+            form->name = name;
+            *coefficient = 1;
+            return true;
+        }
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            if(op->operator != TOKEN_PLUS && op->operator != TOKEN_MINUS && op->operator != TOKEN_MULTIPLY) return false;
+            long long lCoefficient, rCoefficient;
+            if(!getAffineForm(reduction, op->lSide, form, &lCoefficient) || !getAffineForm(reduction, op->rSide, form, &rCoefficient)) return false;
+            form->operationCount++;
+            if(op->operator == TOKEN_PLUS) {
+                *coefficient = lCoefficient + rCoefficient;
+            } else if(op->operator == TOKEN_MINUS) {
+                *coefficient = lCoefficient - rCoefficient;
+            } else {
+                if(lCoefficient == 0 && rCoefficient == 0) {
+                    *coefficient = 0;
+                } else if(isIntConstant(op->rSide) && llabs(getIntConstant(op->rSide)) <= INDUCTION_MAX_CONSTANT) {
+                    *coefficient = lCoefficient * getIntConstant(op->rSide);
+                } else if(isIntConstant(op->lSide) && llabs(getIntConstant(op->lSide)) <= INDUCTION_MAX_CONSTANT) {
+                    *coefficient = rCoefficient * getIntConstant(op->lSide);
+                } else {
+                    return false;
+                }
+            }
+            return *coefficient >= -INDUCTION_MAX_CONSTANT && *coefficient <= INDUCTION_MAX_CONSTANT;
+        }
+        default:
+            return false;
+    }
+}
+
+char * serializeExpression(Expression * expression) {
+    StringBuilder sb;
+    StringBuilder__init(&sb);
+    expression->super.serialize((Statement*)expression, &sb);
+    return sb.text;
+}
+
+Expression__BinaryOperator * createInductionOperation(Expression * lSide, TokenType operator, Expression * rSide) {
+    Expression__BinaryOperator * op = Expression__BinaryOperator__init();
+    op->operator = operator;
+    op->lSide = lSide;
+    op->rSide = rSide;
+    return op;
+}
+
+/**
+ * @brief Creates $v + c or $v - c
+ */
+Expression * createInductionStep(Expression * value, long long step) {
+    Expression__Constant * constant = Expression__Constant__init();
+    constant->type = (Type){.type = TYPE_INT, .isRequired = true};
+    constant->value.integer = step < 0 ? -step : step;
+    return (Expression*)createInductionOperation(value, step < 0 ? TOKEN_MINUS : TOKEN_PLUS, (Expression*)constant);
+}
+
+Expression * duplicateInductionVariable(DerivedInductionVariable * derived) {
+    return (Expression*)derived->variable->super.super.duplicate((Statement*)derived->variable);
+}
+
+/**
+ * @brief Replaces the expression by derived induction variable, equal expressions share the same variable
+ */
+void replaceByDerivedVariable(InductionReduction * reduction, Expression ** slot, char * key, char * basicName, long long coefficient) {
+    for(int i=0; i<reduction->derivedCount; i++) {
+        if(strcmp(reduction->derived[i].key, key) == 0) {
+            *slot = duplicateInductionVariable(&reduction->derived[i]);
+            reduction->reducedCount++;
+            return;
+        }
+    }
+    StringBuilder sb;
+    StringBuilder__init(&sb);
+    StringBuilder__appendString(&sb, "$&induction&");
+    StringBuilder__appendInt(&sb, (int)getNextInductionUID());
+    DerivedInductionVariable derived = {.basicName = basicName, .coefficient = coefficient, .key = key, .variable = Expression__Variable__init()};
+    derived.variable->name = sb.text;
+    BasicInductionVariable * basic = (BasicInductionVariable*)table_find(reduction->variables, basicName)->data;
+    Expression * initialValue = *slot;
+    // update at the start of the body runs before the first iteration too
+    if(basic->isUpdatedByIncrement) initialValue = createInductionStep(initialValue, -coefficient * basic->incrementStep);
+    StatementList__addStatement(reduction->preheader, (Statement*)createInductionOperation(duplicateInductionVariable(&derived), TOKEN_ASSIGN, initialValue));
+    reduction->derived = realloc(reduction->derived, sizeof(DerivedInductionVariable) * (reduction->derivedCount + 1));
+    reduction->derived[reduction->derivedCount++] = derived;
+    *slot = duplicateInductionVariable(&derived);
+    reduction->reducedCount++;
+}
+
+/**
+ * @brief Finds maximal affine expressions of induction variables, which can be replaced by derived induction variables
+ *
+ * @param reduction
+ * @param slot
+ * @param isInHeader expression is in condition or increment of the loop, derived variables updated at the start of body cant be used there
+ */
+void collectInductionCandidates(InductionReduction * reduction, Expression ** slot, bool isInHeader) {
+    Expression * expression = *slot;
+    if(expression == NULL) return;
+    if(expression->expressionType == EXPRESSION_BINARY_OPERATOR && ((Expression__BinaryOperator*)expression)->operator != TOKEN_ASSIGN) {
+        AffineForm form = {.name = NULL, .operationCount = 0, .hasTypeDispatch = false};
+        long long coefficient = 0;
+        if(getAffineForm(reduction, expression, &form, &coefficient) && form.name != NULL && coefficient != 0) {
+            BasicInductionVariable * basic = (BasicInductionVariable*)table_find(reduction->variables, form.name)->data;
+            if(!isInHeader || !basic->isUpdatedByIncrement) {
+                // casts of operands with unknown type take several instructions
+                InductionCandidate candidate = {.slot = slot, .key = serializeExpression(expression), .basicName = form.name, .coefficient = coefficient,
+                    .cost = form.operationCount + (form.hasTypeDispatch ? 2 : 0)};
+                reduction->candidates = realloc(reduction->candidates, sizeof(InductionCandidate) * (reduction->candidateCount + 1));
+                reduction->candidates[reduction->candidateCount++] = candidate;
+                return;
+            }
+        }
+    }
+    switch(expression->expressionType) {
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            if(op->operator != TOKEN_ASSIGN) collectInductionCandidates(reduction, &op->lSide, isInHeader);
+            collectInductionCandidates(reduction, &op->rSide, isInHeader);
+            break;
+        }
+        case EXPRESSION_PREFIX_OPERATOR:
+            collectInductionCandidates(reduction, &((Expression__PrefixOperator*)expression)->rSide, isInHeader);
+            break;
+        case EXPRESSION_FUNCTION_CALL: {
+            Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+            for(int i=0; i<call->arity; i++) {
+                collectInductionCandidates(reduction, &call->arguments[i], isInHeader);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Replaces candidates whose evaluation costs more than the updates of the derived variable
+ * @note single addition or multiplication costs the same as the update, so it is replaced only when the expression repeats
+ */
+void replaceInductionCandidates(InductionReduction * reduction) {
+    for(int i=0; i<reduction->candidateCount; i++) {
+        InductionCandidate * candidate = &reduction->candidates[i];
+        int cost = 0;
+        for(int j=0; j<reduction->candidateCount; j++) {
+            if(strcmp(reduction->candidates[j].key, candidate->key) == 0) cost += reduction->candidates[j].cost;
+        }
+        int updateCount = 0;
+        for(int j=0; j<reduction->updateCount; j++) {
+            if(strcmp(reduction->updates[j].name, candidate->basicName) == 0) updateCount++;
+        }
+        if(cost > updateCount) replaceByDerivedVariable(reduction, candidate->slot, candidate->key, candidate->basicName, candidate->coefficient);
+    }
+}
+
+void collectStatementInductionCandidates(InductionReduction * reduction, Statement ** slot) {
+    Statement * statement = *slot;
+    if(statement == NULL || statement->statementType == STATEMENT_FUNCTION) return;
+    if(statement->statementType == STATEMENT_EXPRESSION) {
+        // updates must stay in the same form
+        if(findInductionUpdate(reduction, statement) == NULL) collectInductionCandidates(reduction, (Expression**)slot, false);
+        return;
+    }
+    int childrenCount = 0;
+    Statement *** children = statement->getChildren(statement, &childrenCount);
+    for(int i=0; i<childrenCount; i++) {
+        collectStatementInductionCandidates(reduction, children[i]);
+    }
+    free(children);
+}
+
+void insertAfterStatement(StatementList * list, Statement * statement, Statement * inserted) {
+    StatementList__addStatement(list, inserted);
+    int index = list->listSize - 1;
+    while(index > 0 && list->statements[index - 1] != statement) {
+        list->statements[index] = list->statements[index - 1];
+        index--;
+    }
+    list->statements[index] = inserted;
+}
+
+/**
+ * @brief Adds update of every derived variable next to each update of its basic variable
+ */
+void insertDerivedUpdates(InductionReduction * reduction, Statement * loop) {
+    for(int i=0; i<reduction->derivedCount; i++) {
+        DerivedInductionVariable * derived = &reduction->derived[i];
+        for(int j=0; j<reduction->updateCount; j++) {
+            InductionUpdate * update = &reduction->updates[j];
+            if(strcmp(update->name, derived->basicName) != 0) continue;
+            Statement * statement = (Statement*)createInductionOperation(duplicateInductionVariable(derived), TOKEN_ASSIGN,
+                createInductionStep(duplicateInductionVariable(derived), derived->coefficient * update->step));
+            if(update->list != NULL) {
+                insertAfterStatement(update->list, update->statement, statement);
+                continue;
+            }
+            StatementFor * forStatement = (StatementFor*)loop;
+            if(forStatement->body == NULL || forStatement->body->statementType != STATEMENT_LIST) {
+                StatementList * body = StatementList__init();
+                if(forStatement->body != NULL) StatementList__addStatement(body, forStatement->body);
+                forStatement->body = (Statement*)body;
+            }
+            StatementList * body = (StatementList*)forStatement->body;
+            StatementList__addStatement(body, statement);
+            for(int k=body->listSize-1; k>0; k--) {
+                body->statements[k] = body->statements[k - 1];
+            }
+            body->statements[0] = statement;
+        }
+    }
+}
+
+void freeBasicInductionVariables(Table * variables) {
+    for(int i=0; i<TB_SIZE; i++) {
+        for(TableItem * item = variables->tb[i]; item != NULL; item = item->next) {
+            free(item->data);
+        }
+    }
+    table_free(variables);
+}
+
+/**
+ * @brief Replaces affine expressions of basic induction variables in the loop by variables updated by addition
+ * @note derived variables are initialized before the loop, for loop initialization is moved before them
+ */
+void reduceLoopInductionVariables(InductionReduction * reduction, Statement ** slot) {
+    Statement * loop = *slot;
+    Expression ** condition;
+    Statement ** body;
+    Expression ** increment = NULL;
+    if(loop->statementType == STATEMENT_WHILE) {
+        condition = &((StatementWhile*)loop)->condition;
+        body = &((StatementWhile*)loop)->body;
+    } else {
+        condition = &((StatementFor*)loop)->condition;
+        body = &((StatementFor*)loop)->body;
+        increment = &((StatementFor*)loop)->increment;
+    }
+    reduction->variables = table_init();
+    reduction->updates = NULL;
+    reduction->updateCount = 0;
+    reduction->derived = NULL;
+    reduction->derivedCount = 0;
+    reduction->candidates = NULL;
+    reduction->candidateCount = 0;
+    collectInductionUpdates(reduction, *body);
+    if(increment != NULL && *increment != NULL) addInductionUpdate(reduction, (Statement*)*increment, NULL);
+    markAssignedVariables(reduction, (Statement*)*condition);
+    markAssignedVariables(reduction, *body);
+    if(increment != NULL) markAssignedVariables(reduction, (Statement*)*increment);
+    for(int i=0; i<reduction->updateCount; i++) {
+        InductionUpdate * update = &reduction->updates[i];
+        BasicInductionVariable * basic = getBasicInductionVariable(reduction, update->name);
+        if(!isIntCompatible(getInductionType(reduction, update->read))) basic->isValid = false;
+        if(update->list == NULL) {
+            basic->isUpdatedByIncrement = true;
+            basic->incrementStep = update->step;
+        }
+    }
+    reduction->preheader = StatementList__init();
+    collectInductionCandidates(reduction, condition, true);
+    collectStatementInductionCandidates(reduction, body);
+    if(increment != NULL && (*increment == NULL || findInductionUpdate(reduction, (Statement*)*increment) == NULL)) {
+        collectInductionCandidates(reduction, increment, true);
+    }
+    replaceInductionCandidates(reduction);
+    insertDerivedUpdates(reduction, loop);
+    for(int i=0; i<reduction->candidateCount; i++) {
+        free(reduction->candidates[i].key);
+    }
+    free(reduction->candidates);
+    free(reduction->derived);
+    free(reduction->updates);
+    freeBasicInductionVariables(reduction->variables);
+    reduction->variables = NULL;
+    if(reduction->preheader->listSize == 0) {
+        free(reduction->preheader);
+        return;
+    }
+    StatementList * list = StatementList__init();
+    if(loop->statementType == STATEMENT_FOR && ((StatementFor*)loop)->init != NULL) {
+        StatementList__addStatement(list, (Statement*)((StatementFor*)loop)->init);
+        ((StatementFor*)loop)->init = NULL;
+    }
+    for(int i=0; i<reduction->preheader->listSize; i++) {
+        StatementList__addStatement(list, reduction->preheader->statements[i]);
+    }
+    StatementList__addStatement(list, loop);
+    free(reduction->preheader->statements);
+    free(reduction->preheader);
+    *slot = (Statement*)list;
+}
+
+void reduceNestedInductionVariables(InductionReduction * reduction, Statement ** slot) {
+    if(slot == NULL || *slot == NULL) return;
+    Statement * statement = *slot;
+    if(statement->statementType == STATEMENT_EXPRESSION || statement->statementType == STATEMENT_FUNCTION) return;
+    int childrenCount = 0;
+    Statement *** children = statement->getChildren(statement, &childrenCount);
+    for(int i=0; i<childrenCount; i++) {
+        reduceNestedInductionVariables(reduction, children[i]);
+    }
+    free(children);
+    if(statement->statementType == STATEMENT_WHILE || statement->statementType == STATEMENT_FOR) {
+        reduceLoopInductionVariables(reduction, slot);
+    }
+}
+
+/**
+ * @brief Strength reduction of induction variables in all loops of the body
+ * @note int type of basic and derived variables is inferred by the type analysis, so the code generator emits no type checks for them
+ *
+ * @param body
+ * @param function function owning the body, NULL for main program
+ * @param functionTable
+ * @param program
+ * @param resultTable
+ * @return true if the body was changed
+ */
+bool reduceInductionVariables(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    InductionReduction reduction = {.functionTable = functionTable, .program = program, .function = function, .resultTable = resultTable, .reducedCount = 0};
+    reduceNestedInductionVariables(&reduction, body);
+    if(reduction.reducedCount == 0) return false;
+    invalidateResultsType(resultTable, function != NULL ? (Statement*)function : (Statement*)program);
+    return true;
+}
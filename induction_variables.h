@@ -0,0 +1,18 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file induction_variables.h
+ * @brief Header file for induction variable strength reduction
+ */
+
+#ifndef __INDUCTION_VARIABLES_H__
+#define __INDUCTION_VARIABLES_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+#include "pointer_hashtable.h"
+
+char * serializeExpression(Expression * expression);
+bool reduceInductionVariables(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable);
+
+#endif // __INDUCTION_VARIABLES_H__
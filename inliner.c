@@ -0,0 +1,448 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file inliner.c
+ * @brief Inlining of user functions
+ */
+
+#include "inliner.h"
+#include "call_graph.h"
+#include "ssa.h"
+#include "string_builder.h"
+
+#define INLINE_SMALL_FUNCTION_SIZE 40 /*<Functions up to this number of nodes are inlined everywhere>*/
+#define INLINE_SINGLE_CALL_FUNCTION_SIZE 600 /*<Functions with one call site up to this number of nodes are inlined>*/
+#define INLINE_MAX_CALLER_GROWTH 500 /*<Maximum number of nodes inlined into one caller, type analysis of bigger bodies gets slow>*/
+
+typedef enum {
+    INLINE_DISCARD, /*<f(...);>*/
+    INLINE_ASSIGN, /*<$x = f(...);>*/
+    INLINE_RETURN /*<return f(...);>*/
+} InlineMode;
+
+typedef enum {
+    INLINE_TAIL_INVALID, /*<Return which cant be rewritten to structured control flow>*/
+    INLINE_TAIL_RETURNS, /*<All paths end with return or exit>*/
+    INLINE_TAIL_FALLS_THROUGH /*<Some path reaches end of the statement>*/
+} InlineTail;
+
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    PointerTable * resultTable;
+    CallGraph * graph;
+    int * callCounts; /*<Number of call sites of every function>*/
+    bool * isInlinable;
+    PointerTable * compatibleCalls; /*<Calls of the current caller whose arguments pass type checks of the parameters>*/
+    int callerGrowth; /*<Number of nodes already inlined into the current caller>*/
+    int nextSiteId;
+    bool changed;
+} Inliner;
+
+bool containsReturn(Statement * statement) {
+    if(statement == NULL) return false;
+    if(statement->statementType == STATEMENT_RETURN) return true;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(statement, &statementCount);
+    bool result = false;
+    for(size_t i=0; i<statementCount; i++) {
+        if(*allStatements[i] != NULL && (*allStatements[i])->statementType == STATEMENT_RETURN) {
+            result = true;
+            break;
+        }
+    }
+    free(allStatements);
+    return result;
+}
+
+/**
+ * @brief Checks if value of the type always passes type check of the required type, so the check isnt generated
+ */
+bool isTypeStaticallyCompatible(Type requiredType, UnionType unionType) {
+    Type type = unionTypeToType(unionType);
+    if(type.type == TYPE_UNKNOWN) return false;
+    if(requiredType.type == type.type && (requiredType.isRequired == type.isRequired || !requiredType.isRequired)) return true;
+    return !requiredType.isRequired && type.type == TYPE_NULL;
+}
+
+Expression__BinaryOperator * createInlineAssignment(Expression * lSide, Expression * rSide) {
+    Expression__BinaryOperator * assignment = Expression__BinaryOperator__init();
+    assignment->operator = TOKEN_ASSIGN;
+    assignment->lSide = lSide;
+    assignment->rSide = rSide;
+    return assignment;
+}
+
+/**
+ * @brief Rewrites returns in tail positions of inlined body, returns not in tail position make the body invalid
+ * @note if statement returning in one branch is followed by other statements, they are moved to the other branch
+ */
+InlineTail rewriteInlinedReturns(Statement ** slot, InlineMode mode, Expression * target) {
+    if(*slot == NULL) return INLINE_TAIL_FALLS_THROUGH;
+    switch((*slot)->statementType) {
+        case STATEMENT_RETURN: {
+            Expression * expression = ((StatementReturn*)*slot)->expression;
+            if(mode == INLINE_DISCARD) {
+                *slot = expression != NULL ? (Statement*)expression : (Statement*)StatementList__init();
+            } else if(mode == INLINE_ASSIGN) {
+                if(expression == NULL) {
+                    Expression__Constant * null = Expression__Constant__init();
+                    null->type = (Type){.type = TYPE_NULL, .isRequired = false};
+                    expression = (Expression*)null;
+                }
+                *slot = (Statement*)createInlineAssignment((Expression*)target->super.duplicate((Statement*)target), expression);
+            }
+            return INLINE_TAIL_RETURNS;
+        }
+        case STATEMENT_EXIT:
+            return INLINE_TAIL_RETURNS;
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)*slot;
+            if(list->listSize == 0) return INLINE_TAIL_FALLS_THROUGH;
+            for(int i=0; i<list->listSize - 1; i++) {
+                if(!containsReturn(list->statements[i])) continue;
+                if(list->statements[i]->statementType != STATEMENT_IF) return INLINE_TAIL_INVALID;
+                StatementIf * ifStatement = (StatementIf*)list->statements[i];
+                bool ifReturns = containsReturn(ifStatement->ifBody);
+                bool elseReturns = containsReturn(ifStatement->elseBody);
+                if(ifReturns && elseReturns) return INLINE_TAIL_INVALID;
+                Statement ** returningBranch = ifReturns ? &ifStatement->ifBody : &ifStatement->elseBody;
+                Statement ** otherBranch = ifReturns ? &ifStatement->elseBody : &ifStatement->ifBody;
+                if(rewriteInlinedReturns(returningBranch, mode, target) != INLINE_TAIL_RETURNS) return INLINE_TAIL_INVALID;
+                StatementList * rest = StatementList__init();
+                if(*otherBranch != NULL) StatementList__addStatement(rest, *otherBranch);
+                for(int j=i+1; j<list->listSize; j++) {
+                    StatementList__addStatement(rest, list->statements[j]);
+                }
+                *otherBranch = (Statement*)rest;
+                list->listSize = i + 1;
+                InlineTail tail = rewriteInlinedReturns(otherBranch, mode, target);
+                return tail;
+            }
+            return rewriteInlinedReturns(&list->statements[list->listSize - 1], mode, target);
+        }
+        case STATEMENT_IF: {
+            StatementIf * ifStatement = (StatementIf*)*slot;
+            InlineTail ifTail = rewriteInlinedReturns(&ifStatement->ifBody, mode, target);
+            InlineTail elseTail = rewriteInlinedReturns(&ifStatement->elseBody, mode, target);
+            if(ifTail == INLINE_TAIL_INVALID || elseTail == INLINE_TAIL_INVALID) return INLINE_TAIL_INVALID;
+            if(ifTail == INLINE_TAIL_RETURNS && elseTail == INLINE_TAIL_RETURNS) return INLINE_TAIL_RETURNS;
+            return INLINE_TAIL_FALLS_THROUGH;
+        }
+        default:
+            return containsReturn(*slot) ? INLINE_TAIL_INVALID : INLINE_TAIL_FALLS_THROUGH;
+    }
+}
+
+/**
+ * @brief Checks properties of the function which dont depend on the call site
+ */
+bool canFunctionBeInlined(Inliner * inliner, int index) {
+    CallGraph * graph = inliner->graph;
+    Function * function = graph->functions[index];
+    for(int i=0; i<graph->calleeCounts[index]; i++) {
+        // recursion guard, functions in recursive components are never inlined
+        if(graph->callees[index][i] == index) return false;
+    }
+    for(int scc=0; scc<graph->sccCount; scc++) {
+        for(int i=graph->sccStarts[scc]; i<graph->sccStarts[scc + 1]; i++) {
+            if(graph->sccMembers[i] == index && graph->sccStarts[scc + 1] - graph->sccStarts[scc] > 1) return false;
+        }
+    }
+    int size = getStatementSize(function->body);
+    if(size > INLINE_SMALL_FUNCTION_SIZE && (inliner->callCounts[index] != 1 || size > INLINE_SINGLE_CALL_FUNCTION_SIZE)) return false;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(function->body, &statementCount);
+    bool result = true;
+    for(size_t i=0; i<statementCount && result; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_RETURN) continue;
+        Expression * expression = ((StatementReturn*)statement)->expression;
+        if(function->returnType.type == TYPE_VOID) {
+            result = expression == NULL;
+        } else {
+            // type check of returned value would be lost
+            result = expression != NULL && isTypeStaticallyCompatible(function->returnType, expression->getType(expression, inliner->functionTable, inliner->program, function, inliner->resultTable));
+        }
+    }
+    free(allStatements);
+    if(!result) return false;
+    // locals keep their values between calls after inlining, so they must be always assigned before use
+    if(mayReadUndefinedVariable(&function->body, inliner->functionTable, inliner->program, function, inliner->resultTable)) return false;
+    Statement * body = function->body->duplicate(function->body);
+    Expression__Variable * target = Expression__Variable__init();
+    target->name = "$";
+    InlineTail tail = rewriteInlinedReturns(&body, function->returnType.type == TYPE_VOID ? INLINE_DISCARD : INLINE_ASSIGN, (Expression*)target);
+    if(tail == INLINE_TAIL_INVALID) return false;
+    // falling through end of non void function is runtime error
+    return function->returnType.type == TYPE_VOID || tail == INLINE_TAIL_RETURNS;
+}
+
+char * getInlinedVariableName(char * name, Function * function, int siteId) {
+    StringBuilder sb;
+    StringBuilder__init(&sb);
+    StringBuilder__appendString(&sb, name);
+    StringBuilder__appendChar(&sb, '&');
+    StringBuilder__appendString(&sb, function->name);
+    StringBuilder__appendChar(&sb, '&');
+    StringBuilder__appendInt(&sb, siteId);
+    return sb.text;
+}
+
+/**
+ * @brief Checks if the call can be replaced by body of the called function
+ */
+bool canInlineCall(Inliner * inliner, Expression__FunctionCall * call, InlineMode mode, Function * caller) {
+    int index = CallGraph__getIndex(inliner->graph, call->name);
+    if(index < 0 || !inliner->isInlinable[index]) return false;
+    Function * function = inliner->graph->functions[index];
+    if(function == caller || call->arity != function->arity) return false;
+    if(function->returnType.type == TYPE_VOID && mode != INLINE_DISCARD) return false;
+    if(inliner->callerGrowth + getStatementSize(function->body) > INLINE_MAX_CALLER_GROWTH) return false;
+    // type checks of arguments would be lost
+    return pointer_table_find(inliner->compatibleCalls, call) != NULL;
+}
+
+/**
+ * @brief Starts inlining into the caller, collects its calls whose argument types statically pass the type checks of the parameters
+ * @note types are computed once before any call of the caller is inlined, inlined body assigns only its own variables
+ * and the result, whose type passes the return type check, so types of the later arguments can only get narrower
+ */
+void collectCompatibleCalls(Inliner * inliner, Statement * body, Function * caller) {
+    pointer_table_free(inliner->compatibleCalls);
+    inliner->compatibleCalls = pointer_table_init();
+    inliner->callerGrowth = 0;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(body, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_FUNCTION_CALL) continue;
+        Expression__FunctionCall * call = (Expression__FunctionCall*)statement;
+        int index = CallGraph__getIndex(inliner->graph, call->name);
+        if(index < 0 || !inliner->isInlinable[index] || call->arity != inliner->graph->functions[index]->arity) continue;
+        bool isCompatible = true;
+        for(int j=0; j<call->arity && isCompatible; j++) {
+            UnionType argumentType = call->arguments[j]->getType(call->arguments[j], inliner->functionTable, inliner->program, caller, inliner->resultTable);
+            isCompatible = isTypeStaticallyCompatible(inliner->graph->functions[index]->parameterTypes[j], argumentType);
+        }
+        if(isCompatible) pointer_table_insert(inliner->compatibleCalls, call, NULL);
+    }
+    free(allStatements);
+}
+
+void inlineCallsInStatement(Inliner * inliner, Statement ** slot, Function * caller);
+
+/**
+ * @brief Replaces statement containing call of the function with its body, canInlineCall has to be checked before
+ */
+void inlineCall(Inliner * inliner, Statement ** slot, Expression__FunctionCall * call, InlineMode mode, Expression * target, Function * caller) {
+    Function * function = inliner->graph->functions[CallGraph__getIndex(inliner->graph, call->name)];
+    int siteId = inliner->nextSiteId++;
+    inliner->callerGrowth += getStatementSize(function->body);
+    Statement * body = function->body->duplicate(function->body);
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(body, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_VARIABLE) continue;
+        Expression__Variable * variable = (Expression__Variable*)statement;
+        variable->name = getInlinedVariableName(variable->name, function, siteId);
+    }
+    free(allStatements);
+    rewriteInlinedReturns(&body, mode, target);
+    StatementList * inlined = StatementList__init();
+    // variable arguments are read only after all other arguments are evaluated
+    for(int pass=0; pass<2; pass++) {
+        for(int i=0; i<call->arity; i++) {
+            if((call->arguments[i]->expressionType == EXPRESSION_VARIABLE) != (pass == 1)) continue;
+            Expression__Variable * parameter = Expression__Variable__init();
+            parameter->name = getInlinedVariableName(function->parameterNames[i], function, siteId);
+            StatementList__addStatement(inlined, (Statement*)createInlineAssignment((Expression*)parameter, call->arguments[i]));
+        }
+    }
+    StatementList__addStatement(inlined, body);
+    *slot = (Statement*)inlined;
+    invalidateResultsType(inliner->resultTable, caller != NULL ? (Statement*)caller : (Statement*)inliner->program);
+    inliner->changed = true;
+    // arguments can contain other calls
+    for(int i=0; i<call->arity; i++) {
+        inlineCallsInStatement(inliner, &inlined->statements[i], caller);
+    }
+}
+
+/**
+ * @brief Checks if expression can be evaluated later without changing behaviour
+ */
+bool canEvaluationBeDelayed(Expression * expression) {
+    if(expression->expressionType == EXPRESSION_CONSTANT) return true;
+    // results of hoisted calls are always defined
+    return expression->expressionType == EXPRESSION_VARIABLE && strncmp(((Expression__Variable*)expression)->name, "$&", 2) == 0;
+}
+
+/**
+ * @brief Finds inlinable call which is evaluated before anything else with observable behaviour in the expression
+ */
+Expression ** findFirstInlinableCall(Inliner * inliner, Expression ** slot, Function * caller) {
+    Expression * expression = *slot;
+    switch(expression->expressionType) {
+        case EXPRESSION_FUNCTION_CALL: {
+            Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+            if(canInlineCall(inliner, call, INLINE_ASSIGN, caller)) return slot;
+            for(int i=0; i<call->arity; i++) {
+                Expression ** found = findFirstInlinableCall(inliner, &call->arguments[i], caller);
+                if(found != NULL) return found;
+                if(!canEvaluationBeDelayed(call->arguments[i])) return NULL;
+            }
+            return NULL;
+        }
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            if(op->operator == TOKEN_ASSIGN) {
+                if(op->lSide->expressionType != EXPRESSION_VARIABLE) return NULL;
+                return findFirstInlinableCall(inliner, &op->rSide, caller);
+            }
+            Expression ** found = findFirstInlinableCall(inliner, &op->lSide, caller);
+            if(found != NULL) return found;
+            // right side of these operators isnt always evaluated
+            if(op->operator == TOKEN_AND || op->operator == TOKEN_OR || op->operator == TOKEN_NULL_COALESCING) return NULL;
+            if(!canEvaluationBeDelayed(op->lSide)) return NULL;
+            return findFirstInlinableCall(inliner, &op->rSide, caller);
+        }
+        case EXPRESSION_PREFIX_OPERATOR:
+            return findFirstInlinableCall(inliner, &((Expression__PrefixOperator*)expression)->rSide, caller);
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Inlines calls evaluated first in the statement, calls inside expressions are hoisted to temporary variable
+ *
+ * @param statementSlot slot of the whole statement
+ * @param expressionSlot expression evaluated first by the statement
+ * @param caller
+ */
+void inlineFirstCalls(Inliner * inliner, Statement ** statementSlot, Expression ** expressionSlot, Function * caller) {
+    Expression * expression = *expressionSlot;
+    if(expression == NULL) return;
+    if((Statement*)expression == *statementSlot && expression->expressionType == EXPRESSION_FUNCTION_CALL && canInlineCall(inliner, (Expression__FunctionCall*)expression, INLINE_DISCARD, caller)) {
+        inlineCall(inliner, statementSlot, (Expression__FunctionCall*)expression, INLINE_DISCARD, NULL, caller);
+        return;
+    }
+    if((*statementSlot)->statementType == STATEMENT_RETURN && expression->expressionType == EXPRESSION_FUNCTION_CALL && canInlineCall(inliner, (Expression__FunctionCall*)expression, INLINE_RETURN, caller)) {
+        inlineCall(inliner, statementSlot, (Expression__FunctionCall*)expression, INLINE_RETURN, NULL, caller);
+        return;
+    }
+    if((Statement*)expression == *statementSlot && expression->expressionType == EXPRESSION_BINARY_OPERATOR) {
+        Expression__BinaryOperator * assignment = (Expression__BinaryOperator*)expression;
+        if(assignment->operator == TOKEN_ASSIGN && assignment->lSide->expressionType == EXPRESSION_VARIABLE && assignment->rSide->expressionType == EXPRESSION_FUNCTION_CALL &&
+            canInlineCall(inliner, (Expression__FunctionCall*)assignment->rSide, INLINE_ASSIGN, caller)) {
+            inlineCall(inliner, statementSlot, (Expression__FunctionCall*)assignment->rSide, INLINE_ASSIGN, assignment->lSide, caller);
+            return;
+        }
+    }
+    Expression ** callSlot = findFirstInlinableCall(inliner, expressionSlot, caller);
+    if(callSlot == NULL) return;
+    Expression__FunctionCall * call = (Expression__FunctionCall*)*callSlot;
+    Expression__Variable * result = Expression__Variable__init();
+    result->name = getInlinedVariableName("$", (Function*)table_find(inliner->functionTable, call->name)->data, inliner->nextSiteId++);
+    *callSlot = (Expression*)result;
+    StatementList * hoisted = StatementList__init();
+    StatementList__addStatement(hoisted, (Statement*)createInlineAssignment((Expression*)result->super.super.duplicate((Statement*)result), (Expression*)call));
+    StatementList__addStatement(hoisted, *statementSlot);
+    *statementSlot = (Statement*)hoisted;
+    Expression__BinaryOperator * assignment = (Expression__BinaryOperator*)hoisted->statements[0];
+    inlineCall(inliner, &hoisted->statements[0], call, INLINE_ASSIGN, assignment->lSide, caller);
+    // other calls can follow the inlined one
+    if(hoisted->statements[1]->statementType == STATEMENT_RETURN) {
+        inlineFirstCalls(inliner, &hoisted->statements[1], &((StatementReturn*)hoisted->statements[1])->expression, caller);
+    } else if(hoisted->statements[1]->statementType == STATEMENT_IF) {
+        inlineFirstCalls(inliner, &hoisted->statements[1], &((StatementIf*)hoisted->statements[1])->condition, caller);
+    } else {
+        inlineFirstCalls(inliner, &hoisted->statements[1], (Expression**)&hoisted->statements[1], caller);
+    }
+}
+
+void inlineCallsInStatement(Inliner * inliner, Statement ** slot, Function * caller) {
+    if(slot == NULL || *slot == NULL) return;
+    Statement * statement = *slot;
+    switch(statement->statementType) {
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)statement;
+            for(int i=0; i<list->listSize; i++) {
+                inlineCallsInStatement(inliner, &list->statements[i], caller);
+            }
+            break;
+        }
+        case STATEMENT_IF: {
+            StatementIf * ifStatement = (StatementIf*)statement;
+            inlineCallsInStatement(inliner, &ifStatement->ifBody, caller);
+            inlineCallsInStatement(inliner, &ifStatement->elseBody, caller);
+            inlineFirstCalls(inliner, slot, &ifStatement->condition, caller);
+            break;
+        }
+        case STATEMENT_WHILE:
+            inlineCallsInStatement(inliner, &((StatementWhile*)statement)->body, caller);
+            break;
+        case STATEMENT_FOR:
+            inlineCallsInStatement(inliner, &((StatementFor*)statement)->body, caller);
+            break;
+        case STATEMENT_RETURN:
+            inlineFirstCalls(inliner, slot, &((StatementReturn*)statement)->expression, caller);
+            break;
+        case STATEMENT_EXPRESSION:
+            inlineFirstCalls(inliner, slot, (Expression**)slot, caller);
+            break;
+        default:
+            break;
+    }
+}
+
+void countCallSites(Inliner * inliner, Statement * body) {
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(body, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_FUNCTION_CALL) continue;
+        int index = CallGraph__getIndex(inliner->graph, ((Expression__FunctionCall*)statement)->name);
+        if(index >= 0) inliner->callCounts[index]++;
+    }
+    free(allStatements);
+}
+
+/**
+ * @brief Inlines small functions and functions called only once into their callers
+ * @note functions are processed bottom up, so inlined bodies already contain inlined calls
+ *
+ * @param program
+ * @param functionTable
+ * @return true if any call was inlined
+ */
+bool inlineFunctions(StatementList * program, Table * functionTable) {
+    Inliner inliner = {0};
+    inliner.functionTable = functionTable;
+    inliner.program = program;
+    inliner.resultTable = pointer_table_init();
+    inliner.graph = CallGraph__build(functionTable);
+    inliner.callCounts = calloc(inliner.graph->functionCount + 1, sizeof(int));
+    inliner.isInlinable = calloc(inliner.graph->functionCount + 1, sizeof(bool));
+    countCallSites(&inliner, (Statement*)program);
+    for(int i=0; i<inliner.graph->functionCount; i++) {
+        countCallSites(&inliner, inliner.graph->functions[i]->body);
+    }
+    for(int i=0; i<inliner.graph->sccStarts[inliner.graph->sccCount]; i++) {
+        int index = inliner.graph->sccMembers[i];
+        Function * function = inliner.graph->functions[index];
+        collectCompatibleCalls(&inliner, function->body, function);
+        inlineCallsInStatement(&inliner, &function->body, function);
+        inliner.isInlinable[index] = canFunctionBeInlined(&inliner, index);
+    }
+    Statement * programStatement = (Statement*)program;
+    collectCompatibleCalls(&inliner, programStatement, NULL);
+    inlineCallsInStatement(&inliner, &programStatement, NULL);
+    free(inliner.callCounts);
+    free(inliner.isInlinable);
+    pointer_table_free(inliner.compatibleCalls);
+    CallGraph__free(inliner.graph);
+    pointer_table_free(inliner.resultTable);
+    return inliner.changed;
+}
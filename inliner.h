@@ -0,0 +1,17 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file inliner.h
+ * @brief Header file for inlining of user functions
+ */
+
+#ifndef __INLINER_H__
+#define __INLINER_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+
+bool isTypeStaticallyCompatible(Type requiredType, UnionType unionType);
+bool inlineFunctions(StatementList * program, Table * functionTable);
+
+#endif // __INLINER_H__
@@ -0,0 +1,352 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file ir.c
+ * @brief In-memory representation of IFJcode22
+ */
+
+#include <ctype.h>
+#include "ir.h"
+#include "symtable.h"
+#include "string_builder.h"
+
+#define IR_STRING_CHUNK_SIZE 65536 /*<Size of chunk of memory for interned strings>*/
+
+/**
+ * @brief Chunk of memory for interned strings, chunks are freed all at once at the end
+ */
+typedef struct IRStringChunk {
+    struct IRStringChunk * previous;
+    size_t used;
+    size_t capacity;
+    char text[];
+} IRStringChunk;
+
+IRStringChunk * irStringChunk = NULL;
+Table * irStrings = NULL;
+
+char * irOpcodeNames[] = {
+    [IR_NOP] = "",
+    [IR_COMMENT] = "#",
+    [IR_MOVE] = "MOVE",
+    [IR_CREATEFRAME] = "CREATEFRAME",
+    [IR_PUSHFRAME] = "PUSHFRAME",
+    [IR_POPFRAME] = "POPFRAME",
+    [IR_DEFVAR] = "DEFVAR",
+    [IR_CALL] = "CALL",
+    [IR_RETURN] = "RETURN",
+    [IR_PUSHS] = "PUSHS",
+    [IR_POPS] = "POPS",
+    [IR_CLEARS] = "CLEARS",
+    [IR_ADD] = "ADD",
+    [IR_SUB] = "SUB",
+    [IR_MUL] = "MUL",
+    [IR_DIV] = "DIV",
+    [IR_IDIV] = "IDIV",
+    [IR_ADDS] = "ADDS",
+    [IR_SUBS] = "SUBS",
+    [IR_MULS] = "MULS",
+    [IR_DIVS] = "DIVS",
+    [IR_IDIVS] = "IDIVS",
+    [IR_LT] = "LT",
+    [IR_GT] = "GT",
+    [IR_EQ] = "EQ",
+    [IR_LTS] = "LTS",
+    [IR_GTS] = "GTS",
+    [IR_EQS] = "EQS",
+    [IR_AND] = "AND",
+    [IR_OR] = "OR",
+    [IR_NOT] = "NOT",
+    [IR_ANDS] = "ANDS",
+    [IR_ORS] = "ORS",
+    [IR_NOTS] = "NOTS",
+    [IR_INT2FLOAT] = "INT2FLOAT",
+    [IR_FLOAT2INT] = "FLOAT2INT",
+    [IR_INT2CHAR] = "INT2CHAR",
+    [IR_STRI2INT] = "STRI2INT",
+    [IR_INT2FLOATS] = "INT2FLOATS",
+    [IR_FLOAT2INTS] = "FLOAT2INTS",
+    [IR_INT2CHARS] = "INT2CHARS",
+    [IR_STRI2INTS] = "STRI2INTS",
+    [IR_READ] = "READ",
+    [IR_WRITE] = "WRITE",
+    [IR_CONCAT] = "CONCAT",
+    [IR_STRLEN] = "STRLEN",
+    [IR_GETCHAR] = "GETCHAR",
+    [IR_SETCHAR] = "SETCHAR",
+    [IR_TYPE] = "TYPE",
+    [IR_LABEL] = "LABEL",
+    [IR_JUMP] = "JUMP",
+    [IR_JUMPIFEQ] = "JUMPIFEQ",
+    [IR_JUMPIFNEQ] = "JUMPIFNEQ",
+    [IR_JUMPIFEQS] = "JUMPIFEQS",
+    [IR_JUMPIFNEQS] = "JUMPIFNEQS",
+    [IR_EXIT] = "EXIT",
+    [IR_BREAK] = "BREAK",
+    [IR_DPRINT] = "DPRINT",
+};
+
+/**
+ * @brief Gets the only copy of the string, copies are stored in chunks until freeIRStrings is called
+ */
+char * internIRString(char * string) {
+    if(irStrings == NULL) irStrings = table_init();
+    TableItem * item = table_find(irStrings, string);
+    if(item != NULL) return item->name;
+    size_t length = strlen(string) + 1;
+    if(irStringChunk == NULL || irStringChunk->capacity - irStringChunk->used < length) {
+        size_t capacity = length > IR_STRING_CHUNK_SIZE ? length : IR_STRING_CHUNK_SIZE;
+        IRStringChunk * chunk = malloc(sizeof(IRStringChunk) + capacity);
+        chunk->previous = irStringChunk;
+        chunk->used = 0;
+        chunk->capacity = capacity;
+        irStringChunk = chunk;
+    }
+    char * copy = irStringChunk->text + irStringChunk->used;
+    memcpy(copy, string, length);
+    irStringChunk->used += length;
+    table_insert(irStrings, copy, NULL);
+    return copy;
+}
+
+void freeIRStrings() {
+    while(irStringChunk != NULL) {
+        IRStringChunk * previous = irStringChunk->previous;
+        free(irStringChunk);
+        irStringChunk = previous;
+    }
+    table_free(irStrings);
+    irStrings = NULL;
+}
+
+IROperand IROperand__symb(Symb symb) {
+    if(symb.type == Type_string) {
+        symb.value.s = internIRString(symb.value.s);
+    } else if(symb.type == Type_variable) {
+        symb.value.v.name = internIRString(symb.value.v.name);
+    }
+    return (IROperand){.kind = IR_OPERAND_SYMB, .value.symb = symb};
+}
+
+IROperand IROperand__var(Var var) {
+    return IROperand__symb((Symb){.type = Type_variable, .value.v = var});
+}
+
+IROperand IROperand__label(char * label) {
+    return (IROperand){.kind = IR_OPERAND_LABEL, .value.label = internIRString(label)};
+}
+
+IROperand IROperand__type(StorageType type) {
+    return (IROperand){.kind = IR_OPERAND_TYPE, .value.type = type};
+}
+
+IROperand IROperand__text(char * text) {
+    return (IROperand){.kind = IR_OPERAND_TEXT, .value.text = internIRString(text)};
+}
+
+/**
+ * @brief Checks if operands are the same, floats are compared by value
+ */
+bool IROperand__equals(IROperand * this, IROperand * other) {
+    if(this->kind != other->kind) return false;
+    switch(this->kind) {
+        case IR_OPERAND_NONE: return true;
+        case IR_OPERAND_LABEL: return this->value.label == other->value.label;
+        case IR_OPERAND_TYPE: return this->value.type == other->value.type;
+        case IR_OPERAND_TEXT: return this->value.text == other->value.text;
+        case IR_OPERAND_SYMB: break;
+    }
+    Symb * first = &this->value.symb;
+    Symb * second = &other->value.symb;
+    if(first->type != second->type) return false;
+    switch(first->type) {
+        case Type_int: return first->value.i == second->value.i;
+        case Type_bool: return first->value.b == second->value.b;
+        case Type_float: return first->value.f == second->value.f;
+        case Type_string: return first->value.s == second->value.s;
+        case Type_null: return true;
+        case Type_variable: return first->value.v.frameType == second->value.v.frameType && first->value.v.name == second->value.v.name;
+    }
+    return false;
+}
+
+void IRList__init(IRList * this) {
+    this->instructions = NULL;
+    this->count = 0;
+    this->capacity = 0;
+    this->functionStarts = NULL;
+    this->functionCount = 0;
+}
+
+void IRList__free(IRList * this) {
+    free(this->instructions);
+    free(this->functionStarts);
+    IRList__init(this);
+}
+
+void IRList__add(IRList * this, IROpcode opcode, IROperand first, IROperand second, IROperand third) {
+    if(this->count == this->capacity) {
+        this->capacity = this->capacity == 0 ? 256 : this->capacity * 2;
+        this->instructions = realloc(this->instructions, sizeof(IRInstruction) * this->capacity);
+    }
+    this->instructions[this->count++] = (IRInstruction){.opcode = opcode, .operands = {first, second, third}};
+}
+
+/**
+ * @brief Appends copy of instructions of the other list
+ */
+void IRList__addList(IRList * this, IRList * other) {
+    if(this->count + other->count > this->capacity) {
+        while(this->count + other->count > this->capacity) {
+            this->capacity = this->capacity == 0 ? 256 : this->capacity * 2;
+        }
+        this->instructions = realloc(this->instructions, sizeof(IRInstruction) * this->capacity);
+    }
+    if(other->count > 0) memcpy(this->instructions + this->count, other->instructions, sizeof(IRInstruction) * other->count);
+    this->count += other->count;
+}
+
+/**
+ * @brief Marks that the next added instruction starts a new function
+ */
+void IRList__startFunction(IRList * this) {
+    this->functionStarts = realloc(this->functionStarts, sizeof(int) * (this->functionCount + 1));
+    this->functionStarts[this->functionCount++] = this->count;
+}
+
+bool isIRConditionalJump(IROpcode opcode) {
+    return opcode == IR_JUMPIFEQ || opcode == IR_JUMPIFNEQ || opcode == IR_JUMPIFEQS || opcode == IR_JUMPIFNEQS;
+}
+
+bool isIRJump(IROpcode opcode) {
+    return opcode == IR_JUMP || isIRConditionalJump(opcode);
+}
+
+/**
+ * @brief Splits instructions into basic blocks, blocks start at labels, function starts
+ * and after jumps, EXIT and RETURN
+ *
+ * @param blockCount output number of blocks
+ * @return IRBlock* array of blocks ordered by their start
+ */
+IRBlock * IRList__getBlocks(IRList * this, int * blockCount) {
+    IRBlock * blocks = malloc(sizeof(IRBlock) * (this->count + 1));
+    int count = 0;
+    int function = 0;
+    bool isLeader = true;
+    for(int i=0; i<this->count; i++) {
+        while(function < this->functionCount && this->functionStarts[function] <= i) {
+            function++;
+            isLeader = true;
+        }
+        IROpcode opcode = this->instructions[i].opcode;
+        if(opcode == IR_LABEL) isLeader = true;
+        if(isLeader || count == 0) {
+            if(count > 0) blocks[count-1].end = i;
+            blocks[count++] = (IRBlock){.start = i, .end = this->count, .function = function};
+            isLeader = false;
+        }
+        if(isIRJump(opcode) || opcode == IR_EXIT || opcode == IR_RETURN) isLeader = true;
+    }
+    *blockCount = count;
+    return blocks;
+}
+
+void appendIRString(StringBuilder * builder, char * string) {
+    StringBuilder__appendString(builder, "string@");
+    while(*string) {
+        if(isspace(*string) || *string == '#' || *string == '\\' || *string < 32) {
+            unsigned int c = (unsigned int)(unsigned char)*string;
+            StringBuilder__appendChar(builder, '\\');
+            StringBuilder__appendInt(builder, c/100);
+            c %= 100;
+            StringBuilder__appendInt(builder, c/10);
+            c %= 10;
+            StringBuilder__appendInt(builder, c);
+        } else {
+            StringBuilder__appendChar(builder, *string);
+        }
+        string++;
+    }
+}
+
+void appendIROperand(StringBuilder * builder, IROperand * operand) {
+    switch(operand->kind) {
+        case IR_OPERAND_NONE: return;
+        case IR_OPERAND_LABEL: StringBuilder__appendString(builder, operand->value.label); return;
+        case IR_OPERAND_TEXT: StringBuilder__appendString(builder, operand->value.text); return;
+        case IR_OPERAND_TYPE: {
+            char * typeName = NULL;
+            switch(operand->value.type) {
+                case Type_int: typeName = "int"; break;
+                case Type_bool: typeName = "bool"; break;
+                case Type_float: typeName = "float"; break;
+                case Type_string: typeName = "string"; break;
+                case Type_null: typeName = "nil"; break;
+                case Type_variable: typeName = "variable"; break;
+            }
+            StringBuilder__appendString(builder, typeName);
+            return;
+        }
+        case IR_OPERAND_SYMB: break;
+    }
+    Symb * symb = &operand->value.symb;
+    switch(symb->type) {
+        case Type_int: {
+            StringBuilder__appendString(builder, "int@");
+            StringBuilder__appendInt(builder, symb->value.i);
+            break;
+        }
+        case Type_bool: {
+            StringBuilder__appendString(builder, "bool@");
+            StringBuilder__appendString(builder, symb->value.b ? "true" : "false");
+            break;
+        }
+        case Type_float: {
+            StringBuilder__appendString(builder, "float@");
+            StringBuilder__appendFloat(builder, symb->value.f);
+            break;
+        }
+        case Type_string: {
+            appendIRString(builder, symb->value.s);
+            break;
+        }
+        case Type_null: {
+            StringBuilder__appendString(builder, "nil@nil");
+            break;
+        }
+        case Type_variable: {
+            char * frameName = NULL;
+            switch(symb->value.v.frameType) {
+                case LF: frameName = "LF"; break;
+                case TF: frameName = "TF"; break;
+                case GF: frameName = "GF"; break;
+            }
+            StringBuilder__appendString(builder, frameName);
+            StringBuilder__appendChar(builder, '@');
+            StringBuilder__appendString(builder, symb->value.v.name);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Serializes instructions into IFJcode22 including its header, removed instructions are skipped
+ *
+ * @return char* code which has to be freed
+ */
+char * IRList__toString(IRList * this) {
+    StringBuilder builder;
+    StringBuilder__init(&builder);
+    StringBuilder__appendString(&builder, ".IFJcode22\n");
+    for(int i=0; i<this->count; i++) {
+        IRInstruction * instruction = &this->instructions[i];
+        if(instruction->opcode == IR_NOP) continue;
+        StringBuilder__appendString(&builder, irOpcodeNames[instruction->opcode]);
+        for(int j=0; j<3 && instruction->operands[j].kind != IR_OPERAND_NONE; j++) {
+            StringBuilder__appendChar(&builder, ' ');
+            appendIROperand(&builder, &instruction->operands[j]);
+        }
+        StringBuilder__appendChar(&builder, '\n');
+    }
+    return builder.text;
+}
@@ -0,0 +1,144 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file ir.h
+ * @brief Header file for in-memory representation of IFJcode22
+ */
+
+#ifndef __IR_H__
+#define __IR_H__
+
+#include <stdbool.h>
+#include "emitter.h"
+
+/**
+ * @brief Opcodes of IFJcode22 instructions
+ */
+typedef enum {
+    IR_NOP, /*<Removed instruction, it isnt printed>*/
+    IR_COMMENT,
+    IR_MOVE,
+    IR_CREATEFRAME,
+    IR_PUSHFRAME,
+    IR_POPFRAME,
+    IR_DEFVAR,
+    IR_CALL,
+    IR_RETURN,
+    IR_PUSHS,
+    IR_POPS,
+    IR_CLEARS,
+    IR_ADD,
+    IR_SUB,
+    IR_MUL,
+    IR_DIV,
+    IR_IDIV,
+    IR_ADDS,
+    IR_SUBS,
+    IR_MULS,
+    IR_DIVS,
+    IR_IDIVS,
+    IR_LT,
+    IR_GT,
+    IR_EQ,
+    IR_LTS,
+    IR_GTS,
+    IR_EQS,
+    IR_AND,
+    IR_OR,
+    IR_NOT,
+    IR_ANDS,
+    IR_ORS,
+    IR_NOTS,
+    IR_INT2FLOAT,
+    IR_FLOAT2INT,
+    IR_INT2CHAR,
+    IR_STRI2INT,
+    IR_INT2FLOATS,
+    IR_FLOAT2INTS,
+    IR_INT2CHARS,
+    IR_STRI2INTS,
+    IR_READ,
+    IR_WRITE,
+    IR_CONCAT,
+    IR_STRLEN,
+    IR_GETCHAR,
+    IR_SETCHAR,
+    IR_TYPE,
+    IR_LABEL,
+    IR_JUMP,
+    IR_JUMPIFEQ,
+    IR_JUMPIFNEQ,
+    IR_JUMPIFEQS,
+    IR_JUMPIFNEQS,
+    IR_EXIT,
+    IR_BREAK,
+    IR_DPRINT,
+} IROpcode;
+
+typedef enum {
+    IR_OPERAND_NONE,
+    IR_OPERAND_SYMB, /*<Variable or constant*/
+    IR_OPERAND_LABEL,
+    IR_OPERAND_TYPE, /*<Type read by READ>*/
+    IR_OPERAND_TEXT, /*<Text of comment>*/
+} IROperandKind;
+
+/**
+ * @brief Operand of instruction, all strings are interned so they can be compared by pointers
+ */
+typedef struct {
+    IROperandKind kind;
+    union {
+        Symb symb;
+        char * label;
+        StorageType type;
+        char * text;
+    } value;
+} IROperand;
+
+typedef struct {
+    IROpcode opcode;
+    IROperand operands[3];
+} IRInstruction;
+
+/**
+ * @brief Sequence of instructions
+ */
+typedef struct {
+    IRInstruction * instructions;
+    int count;
+    int capacity;
+    int * functionStarts; /*<Indexes of the first instructions of functions, main program starts at 0>*/
+    int functionCount;
+} IRList;
+
+/**
+ * @brief Basic block, only its first instruction can be label and only its last instruction can be jump
+ */
+typedef struct {
+    int start; /*<Index of the first instruction>*/
+    int end; /*<Index after the last instruction>*/
+    int function; /*<Index of the function containing the block, 0 is the main program>*/
+} IRBlock;
+
+char * internIRString(char * string);
+void freeIRStrings();
+
+IROperand IROperand__symb(Symb symb);
+IROperand IROperand__var(Var var);
+IROperand IROperand__label(char * label);
+IROperand IROperand__type(StorageType type);
+IROperand IROperand__text(char * text);
+bool IROperand__equals(IROperand * this, IROperand * other);
+
+void IRList__init(IRList * this);
+void IRList__free(IRList * this);
+void IRList__add(IRList * this, IROpcode opcode, IROperand first, IROperand second, IROperand third);
+void IRList__addList(IRList * this, IRList * other);
+void IRList__startFunction(IRList * this);
+IRBlock * IRList__getBlocks(IRList * this, int * blockCount);
+char * IRList__toString(IRList * this);
+
+bool isIRJump(IROpcode opcode);
+bool isIRConditionalJump(IROpcode opcode);
+
+#endif // __IR_H__
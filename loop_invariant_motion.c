@@ -0,0 +1,461 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file loop_invariant_motion.c
+ * @brief Hoisting of loop invariant expressions out of while and for loops
+ */
+
+#include "loop_invariant_motion.h"
+#include "optimizer.h"
+#include "inliner.h"
+#include "common_subexpressions.h"
+#include "string_builder.h"
+
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    Function * function;
+    PointerTable * resultTable;
+    Table * assignedVariables; /*<Variables assigned anywhere in the processed loop>*/
+    StatementList * preheader; /*<Assignments of hoisted expressions, placed before the processed loop>*/
+    Expression ** narrowingReads; /*<Reads after which type of the variable is narrowed, compared variables and checked arguments>*/
+    int narrowingReadCount;
+    Table * undefinedVariables; /*<Variables which can be undefined at some read in the loop>*/
+    int hoistedCount;
+} LoopInvariantMotion;
+
+/**
+ * @brief Get the next unique id of variable holding hoisted expression
+ *
+ * @return size_t
+ */
+size_t getNextInvariantUID() {
+    static size_t invariantUID = 0;
+    return invariantUID++;
+}
+
+UnionType getInvariantType(Expression * expression, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    return expression->getType(expression, functionTable, program, function, resultTable);
+}
+
+void addAssignedVariable(Table * assignedVariables, Expression * expression) {
+    if(expression == NULL || expression->expressionType != EXPRESSION_VARIABLE) return;
+    char * name = ((Expression__Variable*)expression)->name;
+    if(table_find(assignedVariables, name) == NULL) table_insert(assignedVariables, name, NULL);
+}
+
+void collectAssignedVariable(Table * assignedVariables, Statement * statement) {
+    if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION) return;
+    Expression * expression = (Expression*)statement;
+    if(expression->expressionType == EXPRESSION_BINARY_OPERATOR && ((Expression__BinaryOperator*)expression)->operator == TOKEN_ASSIGN) {
+        addAssignedVariable(assignedVariables, ((Expression__BinaryOperator*)expression)->lSide);
+    } else if(expression->expressionType == EXPRESSION_POSTFIX_OPERATOR) {
+        addAssignedVariable(assignedVariables, ((Expression__PostfixOperator*)expression)->operand);
+    } else if(expression->expressionType == EXPRESSION_PREFIX_OPERATOR) {
+        addAssignedVariable(assignedVariables, ((Expression__PrefixOperator*)expression)->rSide);
+    }
+}
+
+void collectAssignedVariables(Table * assignedVariables, Statement * statement) {
+    if(statement == NULL) return;
+    collectAssignedVariable(assignedVariables, statement);
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(statement, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        collectAssignedVariable(assignedVariables, *allStatements[i]);
+    }
+    free(allStatements);
+}
+
+/**
+ * @brief Checks if the expression has no side effects and doesnt read any of the assigned variables
+ * @note user functions can write output or never return, so their calls are never invariant
+ *
+ * @param assignedVariables variables assigned in the loop, NULL if only side effects are checked
+ * @param expression
+ */
+bool isInvariantExpression(Table * assignedVariables, Expression * expression) {
+    switch(expression->expressionType) {
+        case EXPRESSION_CONSTANT:
+            return true;
+        case EXPRESSION_VARIABLE:
+            return assignedVariables == NULL || table_find(assignedVariables, ((Expression__Variable*)expression)->name) == NULL;
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            return op->operator != TOKEN_ASSIGN && isInvariantExpression(assignedVariables, op->lSide) && isInvariantExpression(assignedVariables, op->rSide);
+        }
+        case EXPRESSION_PREFIX_OPERATOR: {
+            Expression__PrefixOperator * op = (Expression__PrefixOperator*)expression;
+            return op->operator == TOKEN_NEGATE && isInvariantExpression(assignedVariables, op->rSide);
+        }
+        case EXPRESSION_FUNCTION_CALL: {
+            Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+            if(!isPureBuiltinFunction(call->name)) return false;
+            for(int i=0; i<call->arity; i++) {
+                if(!isInvariantExpression(assignedVariables, call->arguments[i])) return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Checks if evaluation of the expression can end with runtime error
+ * @note conservative, unknown types are expected to fail
+ */
+bool canExpressionFail(Expression * expression, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    switch(expression->expressionType) {
+        case EXPRESSION_CONSTANT:
+            return false;
+        case EXPRESSION_VARIABLE:
+            return getInvariantType(expression, function, functionTable, program, resultTable).isUndefined;
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            if(op->operator == TOKEN_ASSIGN) return true;
+            if(canExpressionFail(op->lSide, function, functionTable, program, resultTable) || canExpressionFail(op->rSide, function, functionTable, program, resultTable)) return true;
+            UnionType lType = getInvariantType(op->lSide, function, functionTable, program, resultTable);
+            UnionType rType = getInvariantType(op->rSide, function, functionTable, program, resultTable);
+            switch(op->operator) {
+                case TOKEN_PLUS:
+                case TOKEN_MINUS:
+                case TOKEN_MULTIPLY:
+                    // non numeric strings cant be converted to numbers
+                    return lType.isString || rType.isString;
+                case TOKEN_DIVIDE: {
+                    if(lType.isString || rType.isString || op->rSide->expressionType != EXPRESSION_CONSTANT) return true;
+                    Expression__Constant * divisor = performConstantCast((Expression__Constant*)op->rSide, (Type){.type = TYPE_FLOAT, .isRequired = true}, false);
+                    return divisor == NULL || divisor->value.real == 0;
+                }
+                default:
+                    return false;
+            }
+        }
+        case EXPRESSION_PREFIX_OPERATOR: {
+            Expression__PrefixOperator * op = (Expression__PrefixOperator*)expression;
+            return op->operator != TOKEN_NEGATE || canExpressionFail(op->rSide, function, functionTable, program, resultTable);
+        }
+        case EXPRESSION_FUNCTION_CALL: {
+            Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+            if(!isPureBuiltinFunction(call->name)) return true;
+            Function * builtin = (Function*)table_find(functionTable, call->name)->data;
+            if(call->arity != builtin->arity) return true;
+            for(int i=0; i<call->arity; i++) {
+                if(canExpressionFail(call->arguments[i], function, functionTable, program, resultTable)) return true;
+                if(builtin->parameterTypes[i].type == TYPE_UNKNOWN) continue;
+                if(!isTypeStaticallyCompatible(builtin->parameterTypes[i], getInvariantType(call->arguments[i], function, functionTable, program, resultTable))) return true;
+            }
+            if(strcmp(call->name, "chr") == 0) {
+                // only ascii values can be converted
+                if(call->arguments[0]->expressionType != EXPRESSION_CONSTANT) return true;
+                long long value = ((Expression__Constant*)call->arguments[0])->value.integer;
+                return value < 0 || value > 255;
+            }
+            return false;
+        }
+        default:
+            return true;
+    }
+}
+
+void addNarrowingRead(LoopInvariantMotion * motion, Expression * expression) {
+    if(expression->expressionType != EXPRESSION_VARIABLE) return;
+    motion->narrowingReads = realloc(motion->narrowingReads, sizeof(Expression*) * (motion->narrowingReadCount + 1));
+    motion->narrowingReads[motion->narrowingReadCount++] = expression;
+}
+
+/**
+ * @brief Collects reads which narrow types of the following reads in the loop, types at such reads dont hold in the preheader
+ */
+void collectNarrowingReads(LoopInvariantMotion * motion, Statement * statement) {
+    if(statement == NULL) return;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(statement, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * child = *allStatements[i];
+        if(child == NULL) continue;
+        Expression * condition = NULL;
+        if(child->statementType == STATEMENT_IF) condition = ((StatementIf*)child)->condition;
+        if(child->statementType == STATEMENT_WHILE) condition = ((StatementWhile*)child)->condition;
+        if(child->statementType == STATEMENT_FOR) condition = ((StatementFor*)child)->condition;
+        if(isTypeNarrowingCondition(condition)) {
+            addNarrowingRead(motion, ((Expression__BinaryOperator*)condition)->lSide);
+            addNarrowingRead(motion, ((Expression__BinaryOperator*)condition)->rSide);
+        }
+        if(child->statementType != STATEMENT_EXPRESSION) continue;
+        Expression * expression = (Expression*)child;
+        if(expression->expressionType == EXPRESSION_FUNCTION_CALL) {
+            Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+            TableItem * item = table_find(motion->functionTable, call->name);
+            if(item == NULL || !areArgumentsTypeChecked((Function*)item->data)) continue;
+            for(int j=0; j<call->arity; j++) {
+                addNarrowingRead(motion, call->arguments[j]);
+            }
+        } else if(expression->expressionType == EXPRESSION_VARIABLE) {
+            // only reads of variables which arent assigned in the loop are checked
+            char * name = ((Expression__Variable*)expression)->name;
+            if(table_find(motion->assignedVariables, name) != NULL || table_find(motion->undefinedVariables, name) != NULL) continue;
+            if(getInvariantType(expression, motion->function, motion->functionTable, motion->program, motion->resultTable).isUndefined) table_insert(motion->undefinedVariables, name, NULL);
+        }
+    }
+    free(allStatements);
+}
+
+/**
+ * @brief Checks if the expression can fail when it is evaluated in the preheader
+ * @note reads in the loop can have narrower types than in the preheader, because of earlier reads, comparisons and type checks
+ */
+bool canHoistedExpressionFail(LoopInvariantMotion * motion, Expression * expression) {
+    if(canExpressionFail(expression, motion->function, motion->functionTable, motion->program, motion->resultTable)) return true;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements((Statement*)expression, &statementCount);
+    bool result = false;
+    for(size_t i=0; i<statementCount && !result; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_VARIABLE) continue;
+        char * name = ((Expression__Variable*)statement)->name;
+        if(table_find(motion->undefinedVariables, name) != NULL) {
+            result = true;
+            break;
+        }
+        for(int j=0; j<motion->narrowingReadCount && !result; j++) {
+            if(strcmp(((Expression__Variable*)motion->narrowingReads[j])->name, name) != 0) continue;
+            // the read narrows only types of reads evaluated after it
+            bool isInExpression = false;
+            for(size_t k=0; k<statementCount; k++) {
+                if(*allStatements[k] == (Statement*)motion->narrowingReads[j]) isInExpression = true;
+            }
+            if(!isInExpression) result = true;
+        }
+    }
+    free(allStatements);
+    return result;
+}
+
+/**
+ * @brief Checks if the expression does some work, constants and variables are left in the loop
+ */
+bool isHoistingWorthwhile(Expression * expression) {
+    if(expression->expressionType == EXPRESSION_CONSTANT || expression->expressionType == EXPRESSION_VARIABLE) return false;
+    // expressions of constants are folded by the optimizer
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements((Statement*)expression, &statementCount);
+    bool containsVariable = false;
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement != NULL && statement->statementType == STATEMENT_EXPRESSION && ((Expression*)statement)->expressionType == EXPRESSION_VARIABLE) {
+            containsVariable = true;
+            break;
+        }
+    }
+    free(allStatements);
+    return containsVariable;
+}
+
+void hoistExpression(LoopInvariantMotion * motion, Expression ** slot) {
+    StringBuilder sb;
+    StringBuilder__init(&sb);
+    StringBuilder__appendString(&sb, "$&invariant&");
+    StringBuilder__appendInt(&sb, (int)getNextInvariantUID());
+    Expression__Variable * variable = Expression__Variable__init();
+    variable->name = sb.text;
+    Expression__BinaryOperator * assignment = Expression__BinaryOperator__init();
+    assignment->operator = TOKEN_ASSIGN;
+    assignment->lSide = (Expression*)variable->super.super.duplicate((Statement*)variable);
+    assignment->rSide = *slot;
+    StatementList__addStatement(motion->preheader, (Statement*)assignment);
+    *slot = (Expression*)variable;
+    motion->hoistedCount++;
+}
+
+/**
+ * @brief Hoists maximal invariant subexpressions of the expression into the preheader
+ *
+ * @param motion
+ * @param slot
+ * @param isEvaluatedFirst true while the expression is evaluated on loop entry before any side effect or possible runtime error,
+ *  expressions which can fail are hoisted only then, so the error is raised at the same point; cleared when that stops to hold
+ */
+void hoistInvariantSubexpressions(LoopInvariantMotion * motion, Expression ** slot, bool * isEvaluatedFirst) {
+    Expression * expression = *slot;
+    if(expression == NULL) return;
+    if(isInvariantExpression(motion->assignedVariables, expression) && isHoistingWorthwhile(expression)) {
+        if(*isEvaluatedFirst || !canHoistedExpressionFail(motion, expression)) {
+            hoistExpression(motion, slot);
+            return;
+        }
+    }
+    bool isSafe = isInvariantExpression(NULL, expression) && !canExpressionFail(expression, motion->function, motion->functionTable, motion->program, motion->resultTable);
+    bool isConditional = false;
+    switch(expression->expressionType) {
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            if(op->operator != TOKEN_ASSIGN) hoistInvariantSubexpressions(motion, &op->lSide, isEvaluatedFirst);
+            // right side of short circuit operators isnt evaluated every time
+            if(op->operator == TOKEN_AND || op->operator == TOKEN_OR || op->operator == TOKEN_NULL_COALESCING) {
+                hoistInvariantSubexpressions(motion, &op->rSide, &isConditional);
+            } else {
+                hoistInvariantSubexpressions(motion, &op->rSide, isEvaluatedFirst);
+            }
+            break;
+        }
+        case EXPRESSION_PREFIX_OPERATOR: {
+            Expression__PrefixOperator * op = (Expression__PrefixOperator*)expression;
+            if(op->operator == TOKEN_NEGATE) hoistInvariantSubexpressions(motion, &op->rSide, isEvaluatedFirst);
+            break;
+        }
+        case EXPRESSION_FUNCTION_CALL: {
+            Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+            for(int i=0; i<call->arity; i++) {
+                hoistInvariantSubexpressions(motion, &call->arguments[i], isEvaluatedFirst);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    if(!isSafe) *isEvaluatedFirst = false;
+}
+
+/**
+ * @brief Hoists invariant expressions of statements executed in the loop, nested loops were already processed
+ */
+void hoistInvariantsOfStatement(LoopInvariantMotion * motion, Statement * statement) {
+    if(statement == NULL) return;
+    bool isEvaluatedFirst = false;
+    switch(statement->statementType) {
+        case STATEMENT_EXPRESSION: {
+            // the statement itself stays, only its operands are hoisted
+            Expression * expression = (Expression*)statement;
+            if(expression->expressionType == EXPRESSION_BINARY_OPERATOR) {
+                Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+                if(op->operator != TOKEN_ASSIGN) hoistInvariantSubexpressions(motion, &op->lSide, &isEvaluatedFirst);
+                if(op->operator != TOKEN_AND && op->operator != TOKEN_OR && op->operator != TOKEN_NULL_COALESCING) {
+                    hoistInvariantSubexpressions(motion, &op->rSide, &isEvaluatedFirst);
+                }
+            } else if(expression->expressionType == EXPRESSION_FUNCTION_CALL) {
+                Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+                for(int i=0; i<call->arity; i++) {
+                    hoistInvariantSubexpressions(motion, &call->arguments[i], &isEvaluatedFirst);
+                }
+            }
+            break;
+        }
+        case STATEMENT_IF: {
+            StatementIf * ifStatement = (StatementIf*)statement;
+            hoistInvariantSubexpressions(motion, &ifStatement->condition, &isEvaluatedFirst);
+            hoistInvariantsOfStatement(motion, ifStatement->ifBody);
+            hoistInvariantsOfStatement(motion, ifStatement->elseBody);
+            break;
+        }
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)statement;
+            for(int i=0; i<list->listSize; i++) {
+                hoistInvariantsOfStatement(motion, list->statements[i]);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Moves invariant expressions of the loop into assignments placed before it
+ * @note for loop initialization is moved before the hoisted assignments, so they see its result
+ */
+void hoistInvariantsOfLoop(LoopInvariantMotion * motion, Statement ** slot) {
+    Statement * loop = *slot;
+    Expression ** condition;
+    Statement * body;
+    Expression ** increment = NULL;
+    if(loop->statementType == STATEMENT_WHILE) {
+        condition = &((StatementWhile*)loop)->condition;
+        body = ((StatementWhile*)loop)->body;
+    } else {
+        condition = &((StatementFor*)loop)->condition;
+        body = ((StatementFor*)loop)->body;
+        increment = &((StatementFor*)loop)->increment;
+    }
+    motion->assignedVariables = table_init();
+    collectAssignedVariables(motion->assignedVariables, (Statement*)*condition);
+    collectAssignedVariables(motion->assignedVariables, body);
+    if(increment != NULL) collectAssignedVariables(motion->assignedVariables, (Statement*)*increment);
+    motion->narrowingReads = NULL;
+    motion->narrowingReadCount = 0;
+    motion->undefinedVariables = table_init();
+    // condition of the loop narrows types in its body
+    if(isTypeNarrowingCondition(*condition)) {
+        addNarrowingRead(motion, ((Expression__BinaryOperator*)*condition)->lSide);
+        addNarrowingRead(motion, ((Expression__BinaryOperator*)*condition)->rSide);
+    }
+    collectNarrowingReads(motion, (Statement*)*condition);
+    collectNarrowingReads(motion, body);
+    if(increment != NULL) collectNarrowingReads(motion, (Statement*)*increment);
+    motion->preheader = StatementList__init();
+    // condition is always evaluated at least once, right after the preheader
+    bool isEvaluatedFirst = true;
+    hoistInvariantSubexpressions(motion, condition, &isEvaluatedFirst);
+    hoistInvariantsOfStatement(motion, body);
+    if(increment != NULL) {
+        isEvaluatedFirst = false;
+        hoistInvariantSubexpressions(motion, increment, &isEvaluatedFirst);
+    }
+    table_free(motion->assignedVariables);
+    motion->assignedVariables = NULL;
+    table_free(motion->undefinedVariables);
+    motion->undefinedVariables = NULL;
+    free(motion->narrowingReads);
+    motion->narrowingReads = NULL;
+    if(motion->preheader->listSize == 0) {
+        free(motion->preheader->statements);
+        free(motion->preheader);
+        return;
+    }
+    StatementList * list = StatementList__init();
+    if(loop->statementType == STATEMENT_FOR && ((StatementFor*)loop)->init != NULL) {
+        StatementList__addStatement(list, (Statement*)((StatementFor*)loop)->init);
+        ((StatementFor*)loop)->init = NULL;
+    }
+    for(int i=0; i<motion->preheader->listSize; i++) {
+        StatementList__addStatement(list, motion->preheader->statements[i]);
+    }
+    StatementList__addStatement(list, loop);
+    free(motion->preheader->statements);
+    free(motion->preheader);
+    *slot = (Statement*)list;
+}
+
+void hoistNestedLoopInvariants(LoopInvariantMotion * motion, Statement ** slot) {
+    if(slot == NULL || *slot == NULL) return;
+    Statement * statement = *slot;
+    if(statement->statementType == STATEMENT_EXPRESSION || statement->statementType == STATEMENT_FUNCTION) return;
+    // inner loops first, their preheaders can be hoisted further by the outer loop
+    int childrenCount = 0;
+    Statement *** children = statement->getChildren(statement, &childrenCount);
+    for(int i=0; i<childrenCount; i++) {
+        hoistNestedLoopInvariants(motion, children[i]);
+    }
+    free(children);
+    if(statement->statementType == STATEMENT_WHILE || statement->statementType == STATEMENT_FOR) {
+        hoistInvariantsOfLoop(motion, slot);
+    }
+}
+
+/**
+ * @brief Hoists pure loop invariant expressions of all loops of the body into preheaders
+ *
+ * @param body
+ * @param function function owning the body, NULL for main program
+ * @param functionTable
+ * @param program
+ * @param resultTable
+ * @return true if the body was changed
+ */
+bool hoistLoopInvariants(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    LoopInvariantMotion motion = {.functionTable = functionTable, .program = program, .function = function, .resultTable = resultTable, .assignedVariables = NULL, .preheader = NULL, .narrowingReads = NULL, .narrowingReadCount = 0, .undefinedVariables = NULL, .hoistedCount = 0};
+    hoistNestedLoopInvariants(&motion, body);
+    if(motion.hoistedCount == 0) return false;
+    invalidateResultsType(resultTable, function != NULL ? (Statement*)function : (Statement*)program);
+    return true;
+}
@@ -0,0 +1,21 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file loop_invariant_motion.h
+ * @brief Header file for hoisting of loop invariant expressions
+ */
+
+#ifndef __LOOP_INVARIANT_MOTION_H__
+#define __LOOP_INVARIANT_MOTION_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+#include "pointer_hashtable.h"
+
+void collectAssignedVariables(Table * assignedVariables, Statement * statement);
+bool isInvariantExpression(Table * assignedVariables, Expression * expression);
+bool canExpressionFail(Expression * expression, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable);
+bool isHoistingWorthwhile(Expression * expression);
+bool hoistLoopInvariants(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable);
+
+#endif // __LOOP_INVARIANT_MOTION_H__
@@ -0,0 +1,689 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file loop_unroller.c
+ * @brief Unrolling of while and for loops
+ */
+
+#include "loop_unroller.h"
+#include "optimizer.h"
+
+#define LOOP_FULL_UNROLL_SIZE 300 /*<Maximum number of nodes of all copies of fully unrolled body>*/
+#define LOOP_PARTIAL_UNROLL_SIZE 160 /*<Maximum number of nodes of all copies of partially unrolled body>*/
+#define LOOP_PARTIAL_UNROLL_FACTOR 4 /*<Maximum number of body copies in partially unrolled loop>*/
+#define LOOP_MAX_TRIP_COUNT 100000 /*<Loops with more iterations are treated as loops with unknown trip count>*/
+#define LOOP_MAX_STEP 1000000000 /*<Bigger steps of counter arent simulated to avoid overflow>*/
+#define LOOP_DUPLICATED_REST_SIZE 30 /*<Maximum size of statements copied to both branches of if when jumps are rewritten>*/
+#define LOOP_MAX_BODY_SIZE 50000 /*<Loops in bigger bodies arent expanded anymore>*/
+#define LOOP_TYPE_PEEL_SIZE 200 /*<Maximum size of body peeled only to make types of the remaining loop monomorphic>*/
+#define LOOP_MAX_PEEL_COUNT 8 /*<Maximum number of iterations peeled off one loop>*/
+
+typedef struct {
+    Statement ** slot;
+    Statement * loop; /*<Original loop, restored if condition of the peeled iteration isnt known>*/
+    StatementIf * peel;
+    Statement * remainingLoop; /*<Loop following the peeled iteration, NULL if no path continues to the next iteration>*/
+    int polymorphicReads; /*<Number of polymorphic reads in the loop before peeling, 0 if peeling for types isnt considered>*/
+} LoopPeel;
+
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    Function * function;
+    PointerTable * resultTable;
+    LoopPeel * peels; /*<Iterations peeled during this pass>*/
+    int peelCount;
+    int unrolledCount; /*<Number of fully or partially unrolled loops during this pass>*/
+} LoopExpansion;
+
+typedef struct {
+    bool isValid;
+    int breakCount;
+    int endCount; /*<Number of paths which continue with next iteration>*/
+    StatementList * end; /*<List ending the last path which continues with next iteration>*/
+} LoopJumpRewrite;
+
+Expression * getLoopCondition(Statement * loop) {
+    if(loop->statementType == STATEMENT_WHILE) return ((StatementWhile*)loop)->condition;
+    return ((StatementFor*)loop)->condition;
+}
+
+Statement * getLoopBody(Statement * loop) {
+    if(loop->statementType == STATEMENT_WHILE) return ((StatementWhile*)loop)->body;
+    return ((StatementFor*)loop)->body;
+}
+
+int * getLoopPeelCount(Statement * loop) {
+    if(loop->statementType == STATEMENT_WHILE) return &((StatementWhile*)loop)->peelCount;
+    return &((StatementFor*)loop)->peelCount;
+}
+
+/**
+ * @brief Checks if the statement contains break or continue leaving the loop
+ *
+ * @param statement
+ * @param depth depth of jump which leaves the loop from the statement
+ * @param isContinueOnly breaks are ignored
+ */
+bool containsLoopJump(Statement * statement, int depth, bool isContinueOnly) {
+    if(statement == NULL) return false;
+    switch(statement->statementType) {
+        case STATEMENT_BREAK:
+            return !isContinueOnly && ((StatementBreak*)statement)->depth >= depth;
+        case STATEMENT_CONTINUE:
+            return ((StatementContinue*)statement)->depth >= depth;
+        case STATEMENT_WHILE:
+            return containsLoopJump(((StatementWhile*)statement)->body, depth + 1, isContinueOnly);
+        case STATEMENT_FOR:
+            return containsLoopJump(((StatementFor*)statement)->body, depth + 1, isContinueOnly);
+        case STATEMENT_IF:
+            return containsLoopJump(((StatementIf*)statement)->ifBody, depth, isContinueOnly) || containsLoopJump(((StatementIf*)statement)->elseBody, depth, isContinueOnly);
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)statement;
+            for(int i=0; i<list->listSize; i++) {
+                if(containsLoopJump(list->statements[i], depth, isContinueOnly)) return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Checks if no path through the statement continues with the following statement
+ */
+bool isLoopPathTerminated(Statement * statement) {
+    if(statement == NULL) return false;
+    switch(statement->statementType) {
+        case STATEMENT_BREAK:
+        case STATEMENT_CONTINUE:
+        case STATEMENT_RETURN:
+        case STATEMENT_EXIT:
+            return true;
+        case STATEMENT_IF:
+            return isLoopPathTerminated(((StatementIf*)statement)->ifBody) && isLoopPathTerminated(((StatementIf*)statement)->elseBody);
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)statement;
+            for(int i=0; i<list->listSize; i++) {
+                if(isLoopPathTerminated(list->statements[i])) return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+bool isVariableNamed(Expression * expression, char * name) {
+    return expression != NULL && expression->expressionType == EXPRESSION_VARIABLE && strcmp(((Expression__Variable*)expression)->name, name) == 0;
+}
+
+bool isAssignmentOfVariable(Statement * statement, char * name) {
+    if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION) return false;
+    Expression * expression = (Expression*)statement;
+    switch(expression->expressionType) {
+        case EXPRESSION_BINARY_OPERATOR:
+            return ((Expression__BinaryOperator*)expression)->operator == TOKEN_ASSIGN && isVariableNamed(((Expression__BinaryOperator*)expression)->lSide, name);
+        case EXPRESSION_POSTFIX_OPERATOR:
+            return isVariableNamed(((Expression__PostfixOperator*)expression)->operand, name);
+        case EXPRESSION_PREFIX_OPERATOR: {
+            Expression__PrefixOperator * op = (Expression__PrefixOperator*)expression;
+            return (op->operator == TOKEN_INCREMENT || op->operator == TOKEN_DECREMENT) && isVariableNamed(op->rSide, name);
+        }
+        default:
+            return false;
+    }
+}
+
+bool assignsVariable(Statement * statement, char * name) {
+    if(statement == NULL) return false;
+    if(isAssignmentOfVariable(statement, name)) return true;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(statement, &statementCount);
+    bool result = false;
+    for(size_t i=0; i<statementCount; i++) {
+        if(isAssignmentOfVariable(*allStatements[i], name)) {
+            result = true;
+            break;
+        }
+    }
+    free(allStatements);
+    return result;
+}
+
+StatementList * rewriteLoopSequence(LoopJumpRewrite * rewrite, Statement ** statements, int count);
+
+/**
+ * @brief Rewrites branch of if followed by the rest of the sequence, rest is left out if the branch never reaches it
+ */
+Statement * rewriteLoopBranch(LoopJumpRewrite * rewrite, Statement * branch, Statement ** rest, int restCount) {
+    bool isTerminated = isLoopPathTerminated(branch);
+    Statement ** sequence = malloc(sizeof(Statement*) * (restCount + 2));
+    int count = 0;
+    if(branch != NULL) sequence[count++] = branch;
+    for(int i=0; i<restCount && !isTerminated; i++) {
+        sequence[count++] = rest[i]->duplicate(rest[i]);
+    }
+    StatementList * result = rewriteLoopSequence(rewrite, sequence, count);
+    free(sequence);
+    return (Statement*)result;
+}
+
+/**
+ * @brief Removes break and continue statements of the loop from sequence of statements ending the loop body
+ * @note statements following if with jump are moved into its branches, so every path ends in its own list
+ */
+StatementList * rewriteLoopSequence(LoopJumpRewrite * rewrite, Statement ** statements, int count) {
+    StatementList * result = StatementList__init();
+    for(int i=0; i<count && rewrite->isValid; i++) {
+        Statement * statement = statements[i];
+        if(!containsLoopJump(statement, 1, false)) {
+            StatementList__addStatement(result, statement);
+            // rest of the sequence is unreachable
+            if(isLoopPathTerminated(statement)) return result;
+            continue;
+        }
+        switch(statement->statementType) {
+            case STATEMENT_BREAK:
+                if(((StatementBreak*)statement)->depth != 1) {
+                    rewrite->isValid = false;
+                } else {
+                    rewrite->breakCount++;
+                }
+                return result;
+            case STATEMENT_CONTINUE:
+                if(((StatementContinue*)statement)->depth != 1) {
+                    rewrite->isValid = false;
+                } else {
+                    rewrite->endCount++;
+                    rewrite->end = result;
+                }
+                return result;
+            case STATEMENT_LIST: {
+                // nested list is flattened into the rest of the sequence
+                StatementList * list = (StatementList*)statement;
+                int flattenedCount = list->listSize + count - i - 1;
+                Statement ** flattened = malloc(sizeof(Statement*) * (flattenedCount + 1));
+                memcpy(flattened, list->statements, sizeof(Statement*) * list->listSize);
+                memcpy(flattened + list->listSize, statements + i + 1, sizeof(Statement*) * (count - i - 1));
+                StatementList__addStatement(result, (Statement*)rewriteLoopSequence(rewrite, flattened, flattenedCount));
+                free(flattened);
+                return result;
+            }
+            case STATEMENT_IF: {
+                StatementIf * ifStatement = (StatementIf*)statement;
+                Statement ** rest = statements + i + 1;
+                int restCount = count - i - 1;
+                if(!isLoopPathTerminated(ifStatement->ifBody) && !isLoopPathTerminated(ifStatement->elseBody)) {
+                    int restSize = restCount;
+                    for(int j=0; j<restCount; j++) {
+                        restSize += getStatementSize(rest[j]);
+                    }
+                    if(restSize > LOOP_DUPLICATED_REST_SIZE) {
+                        rewrite->isValid = false;
+                        return result;
+                    }
+                }
+                StatementIf * generated = StatementIf__init();
+                generated->condition = ifStatement->condition;
+                generated->ifBody = rewriteLoopBranch(rewrite, ifStatement->ifBody, rest, restCount);
+                generated->elseBody = rewriteLoopBranch(rewrite, ifStatement->elseBody, rest, restCount);
+                StatementList__addStatement(result, (Statement*)generated);
+                return result;
+            }
+            default:
+                // jump from nested loop to this or outer loop
+                rewrite->isValid = false;
+                return result;
+        }
+    }
+    rewrite->endCount++;
+    rewrite->end = result;
+    return result;
+}
+
+/**
+ * @brief Creates copy of the loop body without its break and continue statements
+ * @note if no path breaks, the next iteration can follow the returned list, otherwise it has to be added to rewrite->end
+ */
+StatementList * rewriteLoopBody(Statement * body, LoopJumpRewrite * rewrite) {
+    *rewrite = (LoopJumpRewrite){.isValid = true, .breakCount = 0, .endCount = 0, .end = NULL};
+    Statement * duplicate = body != NULL ? body->duplicate(body) : NULL;
+    StatementList * result = rewriteLoopSequence(rewrite, &duplicate, duplicate != NULL ? 1 : 0);
+    // continuation would have to be copied to more places
+    if(rewrite->breakCount > 0 && rewrite->endCount > 1) rewrite->isValid = false;
+    return result;
+}
+
+/**
+ * @brief Evaluates expression consisting of constants and variables with known values
+ */
+Expression__Constant * evaluateLoopExpression(LoopExpansion * expansion, Expression * expression) {
+    switch(expression->expressionType) {
+        case EXPRESSION_CONSTANT:
+            return (Expression__Constant*)expression;
+        case EXPRESSION_VARIABLE: {
+            UnionType type = expression->getType(expression, expansion->functionTable, expansion->program, expansion->function, expansion->resultTable);
+            if(type.constant == NULL || type.constant->expressionType != EXPRESSION_CONSTANT) return NULL;
+            return (Expression__Constant*)type.constant;
+        }
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            if(op->operator == TOKEN_ASSIGN) return NULL;
+            Expression__Constant * left = evaluateLoopExpression(expansion, op->lSide);
+            if(left == NULL) return NULL;
+            Expression__Constant * right = evaluateLoopExpression(expansion, op->rSide);
+            if(right == NULL) return NULL;
+            Expression__BinaryOperator * folded = Expression__BinaryOperator__init();
+            folded->operator = op->operator;
+            folded->lSide = (Expression*)left;
+            folded->rSide = (Expression*)right;
+            Expression__Constant * result = performConstantFolding(folded);
+            free(folded);
+            return result;
+        }
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Gets change of the counter done by the statement, only constant int steps are supported
+ */
+bool getLoopStep(Statement * statement, char * counter, long long * step) {
+    if(!isAssignmentOfVariable(statement, counter)) return false;
+    Expression * expression = (Expression*)statement;
+    switch(expression->expressionType) {
+        case EXPRESSION_POSTFIX_OPERATOR:
+            *step = ((Expression__PostfixOperator*)expression)->operator == TOKEN_INCREMENT ? 1 : -1;
+            return true;
+        case EXPRESSION_PREFIX_OPERATOR:
+            *step = ((Expression__PrefixOperator*)expression)->operator == TOKEN_INCREMENT ? 1 : -1;
+            return true;
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression * value = ((Expression__BinaryOperator*)expression)->rSide;
+            if(value->expressionType != EXPRESSION_BINARY_OPERATOR) return false;
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)value;
+            if(op->operator != TOKEN_PLUS && op->operator != TOKEN_MINUS) return false;
+            Expression * other = NULL;
+            if(isVariableNamed(op->lSide, counter)) {
+                other = op->rSide;
+            } else if(op->operator == TOKEN_PLUS && isVariableNamed(op->rSide, counter)) {
+                other = op->lSide;
+            }
+            if(other == NULL || other->expressionType != EXPRESSION_CONSTANT || ((Expression__Constant*)other)->type.type != TYPE_INT) return false;
+            long long change = ((Expression__Constant*)other)->value.integer;
+            if(change > LOOP_MAX_STEP || change < -LOOP_MAX_STEP) return false;
+            *step = op->operator == TOKEN_PLUS ? change : -change;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Finds value of the variable before the statement, only preceding statements of the same list are searched
+ */
+Expression__Constant * getLoopEntryValue(LoopExpansion * expansion, StatementList * parent, int index, char * counter) {
+    if(parent == NULL) return NULL;
+    for(int i=index-1; i>=0; i--) {
+        Statement * statement = parent->statements[i];
+        if(!assignsVariable(statement, counter)) continue;
+        if(statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_BINARY_OPERATOR || !isAssignmentOfVariable(statement, counter)) return NULL;
+        return evaluateLoopExpression(expansion, ((Expression__BinaryOperator*)statement)->rSide);
+    }
+    return NULL;
+}
+
+bool compareLoopCounter(long long value, long long limit, TokenType operator) {
+    switch(operator) {
+        case TOKEN_LESS:
+            return value < limit;
+        case TOKEN_GREATER:
+            return value > limit;
+        case TOKEN_LESS_OR_EQUALS:
+            return value <= limit;
+        case TOKEN_GREATER_OR_EQUALS:
+            return value >= limit;
+        default:
+            return value != limit;
+    }
+}
+
+/**
+ * @brief Computes number of iterations of the loop if the condition compares the counter with the bound
+ *
+ * @return number of iterations or -1 if it isnt known
+ */
+long long computeCounterTripCount(LoopExpansion * expansion, Statement * loop, StatementList * parent, int index, Expression * counterExpression, Expression * bound, TokenType operator) {
+    if(counterExpression->expressionType != EXPRESSION_VARIABLE) return -1;
+    if(bound->expressionType != EXPRESSION_CONSTANT && bound->expressionType != EXPRESSION_VARIABLE) return -1;
+    if(operator != TOKEN_LESS && operator != TOKEN_GREATER && operator != TOKEN_LESS_OR_EQUALS && operator != TOKEN_GREATER_OR_EQUALS && operator != TOKEN_NOT_EQUALS) return -1;
+    char * counter = ((Expression__Variable*)counterExpression)->name;
+    Statement * body = getLoopBody(loop);
+    Expression * init = NULL;
+    long long step = 0;
+    if(loop->statementType == STATEMENT_FOR) {
+        StatementFor * forStatement = (StatementFor*)loop;
+        if(!getLoopStep((Statement*)forStatement->increment, counter, &step) || assignsVariable(body, counter)) return -1;
+        if(bound->expressionType == EXPRESSION_VARIABLE && assignsVariable((Statement*)forStatement->increment, ((Expression__Variable*)bound)->name)) return -1;
+        init = forStatement->init;
+    } else {
+        // step has to be done by top level statement of the body, continue before it would skip it
+        Statement ** statements = &body;
+        int count = body != NULL ? 1 : 0;
+        if(body != NULL && body->statementType == STATEMENT_LIST) {
+            statements = ((StatementList*)body)->statements;
+            count = ((StatementList*)body)->listSize;
+        }
+        int stepIndex = -1;
+        for(int i=0; i<count; i++) {
+            if(!assignsVariable(statements[i], counter)) continue;
+            if(stepIndex >= 0 || !getLoopStep(statements[i], counter, &step)) return -1;
+            stepIndex = i;
+        }
+        if(stepIndex < 0) return -1;
+        for(int i=0; i<stepIndex; i++) {
+            if(containsLoopJump(statements[i], 1, true)) return -1;
+        }
+    }
+    if(step == 0) return -1;
+    if(bound->expressionType == EXPRESSION_VARIABLE && assignsVariable(body, ((Expression__Variable*)bound)->name)) return -1;
+    Expression__Constant * limit = evaluateLoopExpression(expansion, bound);
+    Expression__Constant * start = NULL;
+    if(init != NULL && isAssignmentOfVariable((Statement*)init, counter)) {
+        if(init->expressionType != EXPRESSION_BINARY_OPERATOR) return -1;
+        start = evaluateLoopExpression(expansion, ((Expression__BinaryOperator*)init)->rSide);
+    } else if(!assignsVariable((Statement*)init, counter)) {
+        start = getLoopEntryValue(expansion, parent, index, counter);
+    }
+    if(start == NULL || limit == NULL || start->type.type != TYPE_INT || limit->type.type != TYPE_INT) return -1;
+    if(start->value.integer > LOOP_MAX_STEP * (long long)LOOP_MAX_STEP || start->value.integer < -LOOP_MAX_STEP * (long long)LOOP_MAX_STEP) return -1;
+    long long value = start->value.integer;
+    long long tripCount = 0;
+    while(compareLoopCounter(value, limit->value.integer, operator)) {
+        if(++tripCount > LOOP_MAX_TRIP_COUNT) return -1;
+        value += step;
+    }
+    return tripCount;
+}
+
+/**
+ * @brief Computes number of iterations of counted loop, counter has to be int changed by constant step once per iteration
+ *
+ * @return number of iterations or -1 if it isnt known
+ */
+long long computeLoopTripCount(LoopExpansion * expansion, Statement * loop, StatementList * parent, int index) {
+    Expression * condition = getLoopCondition(loop);
+    if(condition->expressionType != EXPRESSION_BINARY_OPERATOR) return -1;
+    Expression__BinaryOperator * comparison = (Expression__BinaryOperator*)condition;
+    long long tripCount = computeCounterTripCount(expansion, loop, parent, index, comparison->lSide, comparison->rSide, comparison->operator);
+    if(tripCount >= 0) return tripCount;
+    TokenType mirrored = comparison->operator;
+    switch(comparison->operator) {
+        case TOKEN_LESS:
+            mirrored = TOKEN_GREATER;
+            break;
+        case TOKEN_GREATER:
+            mirrored = TOKEN_LESS;
+            break;
+        case TOKEN_LESS_OR_EQUALS:
+            mirrored = TOKEN_GREATER_OR_EQUALS;
+            break;
+        case TOKEN_GREATER_OR_EQUALS:
+            mirrored = TOKEN_LESS_OR_EQUALS;
+            break;
+        default:
+            break;
+    }
+    return computeCounterTripCount(expansion, loop, parent, index, comparison->rSide, comparison->lSide, mirrored);
+}
+
+/**
+ * @brief Replaces loop by copies of its body, jumps have to be rewritable
+ */
+void unrollLoopFully(Statement ** slot, long long tripCount) {
+    Statement * loop = *slot;
+    Expression * init = loop->statementType == STATEMENT_FOR ? ((StatementFor*)loop)->init : NULL;
+    Expression * increment = loop->statementType == STATEMENT_FOR ? ((StatementFor*)loop)->increment : NULL;
+    StatementList * result = StatementList__init();
+    if(init != NULL) StatementList__addStatement(result, (Statement*)init);
+    StatementList * end = result;
+    for(long long i=0; i<tripCount && end != NULL; i++) {
+        LoopJumpRewrite rewrite;
+        StatementList * iteration = rewriteLoopBody(getLoopBody(loop), &rewrite);
+        StatementList__addStatement(end, (Statement*)iteration);
+        if(rewrite.breakCount > 0) end = rewrite.endCount == 1 ? rewrite.end : NULL;
+        if(end != NULL && increment != NULL) StatementList__addStatement(end, increment->super.duplicate((Statement*)increment));
+    }
+    *slot = (Statement*)result;
+}
+
+/**
+ * @brief Replaces loop by loop with multiple copies of its body, loop cant contain jumps
+ * @note iterations which dont fill whole unrolled body are done before the loop
+ */
+void unrollLoopPartially(Statement ** slot, long long tripCount, int factor) {
+    Statement * loop = *slot;
+    Statement * body = getLoopBody(loop);
+    Expression * increment = loop->statementType == STATEMENT_FOR ? ((StatementFor*)loop)->increment : NULL;
+    StatementList * result = StatementList__init();
+    if(loop->statementType == STATEMENT_FOR && ((StatementFor*)loop)->init != NULL) StatementList__addStatement(result, (Statement*)((StatementFor*)loop)->init);
+    for(long long i=0; i<tripCount % factor; i++) {
+        StatementList__addStatement(result, body->duplicate(body));
+        if(increment != NULL) StatementList__addStatement(result, increment->super.duplicate((Statement*)increment));
+    }
+    StatementList * unrolledBody = StatementList__init();
+    for(int i=0; i<factor; i++) {
+        if(i > 0 && increment != NULL) StatementList__addStatement(unrolledBody, increment->super.duplicate((Statement*)increment));
+        StatementList__addStatement(unrolledBody, body->duplicate(body));
+    }
+    if(loop->statementType == STATEMENT_FOR) {
+        StatementFor * unrolled = StatementFor__init();
+        unrolled->condition = getLoopCondition(loop);
+        unrolled->increment = increment;
+        unrolled->body = (Statement*)unrolledBody;
+        unrolled->isUnrolled = true;
+        StatementList__addStatement(result, (Statement*)unrolled);
+    } else {
+        StatementWhile * unrolled = StatementWhile__init();
+        unrolled->condition = getLoopCondition(loop);
+        unrolled->body = (Statement*)unrolledBody;
+        unrolled->isUnrolled = true;
+        StatementList__addStatement(result, (Statement*)unrolled);
+    }
+    *slot = (Statement*)result;
+}
+
+/**
+ * @brief Moves first iteration of the loop in front of it, original loop stays untouched so the peel can be reverted
+ *
+ * @param slot
+ * @param remainingLoop loop which follows the peeled iteration, NULL if it isnt reachable
+ * @return if statement of the peeled iteration or NULL if the jumps cant be rewritten
+ */
+StatementIf * peelLoop(Statement ** slot, Statement ** remainingLoop) {
+    Statement * loop = *slot;
+    LoopJumpRewrite rewrite;
+    StatementList * iteration = rewriteLoopBody(getLoopBody(loop), &rewrite);
+    if(!rewrite.isValid) return NULL;
+    StatementIf * peel = StatementIf__init();
+    Expression * condition = getLoopCondition(loop);
+    peel->condition = (Expression*)condition->super.duplicate((Statement*)condition);
+    peel->ifBody = (Statement*)iteration;
+    peel->elseBody = (Statement*)StatementList__init();
+    StatementList * end = iteration;
+    if(rewrite.breakCount > 0) end = rewrite.endCount == 1 ? rewrite.end : NULL;
+    Statement * result = (Statement*)peel;
+    *remainingLoop = loop;
+    if(loop->statementType == STATEMENT_FOR) {
+        StatementFor * forStatement = (StatementFor*)loop;
+        StatementFor * remaining = StatementFor__init();
+        remaining->condition = forStatement->condition;
+        remaining->increment = forStatement->increment;
+        remaining->body = forStatement->body;
+        *remainingLoop = (Statement*)remaining;
+        if(end != NULL && forStatement->increment != NULL) StatementList__addStatement(end, forStatement->increment->super.duplicate((Statement*)forStatement->increment));
+        if(forStatement->init != NULL) {
+            StatementList * list = StatementList__init();
+            StatementList__addStatement(list, forStatement->init->super.duplicate((Statement*)forStatement->init));
+            StatementList__addStatement(list, (Statement*)peel);
+            result = (Statement*)list;
+        }
+    }
+    if(end != NULL) {
+        StatementList__addStatement(end, *remainingLoop);
+    } else {
+        *remainingLoop = NULL;
+    }
+    *slot = result;
+    return peel;
+}
+
+/**
+ * @brief Checks if the value of the type has to be dispatched at runtime
+ */
+bool isPolymorphicType(UnionType type) {
+    return type.isUndefined || type.isBool + type.isFloat + type.isInt + type.isString + type.isNull > 1;
+}
+
+/**
+ * @brief Counts reads of variables with polymorphic types in the statement
+ */
+int countPolymorphicReads(LoopExpansion * expansion, Statement * statement) {
+    if(statement == NULL) return 0;
+    int count = 0;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(statement, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * child = *allStatements[i];
+        if(child == NULL || child->statementType != STATEMENT_EXPRESSION || ((Expression*)child)->expressionType != EXPRESSION_VARIABLE) continue;
+        Expression * read = (Expression*)child;
+        if(isPolymorphicType(read->getType(read, expansion->functionTable, expansion->program, expansion->function, expansion->resultTable))) count++;
+    }
+    free(allStatements);
+    return count;
+}
+
+/**
+ * @brief Counts polymorphic reads in condition, body and increment of the loop, for loop init runs only once so it isnt counted
+ */
+int countLoopPolymorphicReads(LoopExpansion * expansion, Statement * loop) {
+    int count = countPolymorphicReads(expansion, (Statement*)getLoopCondition(loop)) + countPolymorphicReads(expansion, getLoopBody(loop));
+    if(loop->statementType == STATEMENT_FOR) count += countPolymorphicReads(expansion, (Statement*)((StatementFor*)loop)->increment);
+    return count;
+}
+
+/**
+ * @brief Checks if the peeled iteration made types in the remaining loop less polymorphic
+ * @note types of variables assigned in the loop are joined with their types before the loop,
+ * so variables initialized to null or undefined before the loop stay polymorphic in the whole loop
+ */
+bool isPeelTypeStabilizing(LoopExpansion * expansion, LoopPeel * peel) {
+    if(peel->polymorphicReads == 0 || peel->remainingLoop == NULL) return false;
+    return countLoopPolymorphicReads(expansion, peel->remainingLoop) < peel->polymorphicReads;
+}
+
+/**
+ * @brief Chooses how the loop is expanded
+ * @note counted loops are unrolled fully or partially according to the size of the result,
+ * other loops are peeled one iteration at a time while their condition is known
+ * or while the peeled iteration makes types in the rest of the loop monomorphic,
+ * at most LOOP_MAX_PEEL_COUNT iterations are peeled off one loop
+ */
+bool expandLoop(LoopExpansion * expansion, Statement ** slot, StatementList * parent, int index) {
+    Statement * loop = *slot;
+    if(getLoopCondition(loop) == NULL) return false;
+    if(loop->statementType == STATEMENT_WHILE ? ((StatementWhile*)loop)->isUnrolled : ((StatementFor*)loop)->isUnrolled) return false;
+    Statement * body = getLoopBody(loop);
+    int bodySize = getStatementSize(body) + 1;
+    if(loop->statementType == STATEMENT_FOR && ((StatementFor*)loop)->increment != NULL) bodySize += getStatementSize((Statement*)((StatementFor*)loop)->increment) + 1;
+    long long tripCount = computeLoopTripCount(expansion, loop, parent, index);
+    if(tripCount >= 0) {
+        LoopJumpRewrite rewrite;
+        rewriteLoopBody(body, &rewrite);
+        if(rewrite.isValid && tripCount * bodySize <= LOOP_FULL_UNROLL_SIZE) {
+            unrollLoopFully(slot, tripCount);
+            expansion->unrolledCount++;
+            return true;
+        }
+        if(containsLoopJump(body, 1, false)) return false;
+        for(int factor=LOOP_PARTIAL_UNROLL_FACTOR; factor>=2; factor--) {
+            if(tripCount < 2 * factor || factor * bodySize > LOOP_PARTIAL_UNROLL_SIZE) continue;
+            unrollLoopPartially(slot, tripCount, factor);
+            expansion->unrolledCount++;
+            return true;
+        }
+        return false;
+    }
+    // peel of loop with known condition would be known as well and the loop would be peeled again every pass
+    if(*getLoopPeelCount(loop) >= LOOP_MAX_PEEL_COUNT || evaluateLoopExpression(expansion, getLoopCondition(loop)) != NULL) return false;
+    // types have to be counted before the peel, the peeled copy doesnt have its types computed yet
+    int polymorphicReads = bodySize <= LOOP_TYPE_PEEL_SIZE ? countLoopPolymorphicReads(expansion, loop) : 0;
+    Statement * remainingLoop = NULL;
+    StatementIf * peel = peelLoop(slot, &remainingLoop);
+    if(peel == NULL) return false;
+    expansion->peels = realloc(expansion->peels, sizeof(LoopPeel) * (expansion->peelCount + 1));
+    expansion->peels[expansion->peelCount++] = (LoopPeel){.slot = slot, .loop = loop, .peel = peel, .remainingLoop = remainingLoop, .polymorphicReads = polymorphicReads};
+    return true;
+}
+
+/**
+ * @brief Expands loops starting from the innermost ones, loop is expanded only if nothing inside it changed in this pass
+ */
+bool expandNestedLoops(LoopExpansion * expansion, Statement ** slot, StatementList * parent, int index) {
+    if(slot == NULL || *slot == NULL) return false;
+    Statement * statement = *slot;
+    if(statement->statementType == STATEMENT_EXPRESSION || statement->statementType == STATEMENT_FUNCTION) return false;
+    bool changed = false;
+    if(statement->statementType == STATEMENT_LIST) {
+        StatementList * list = (StatementList*)statement;
+        for(int i=0; i<list->listSize; i++) {
+            changed |= expandNestedLoops(expansion, &list->statements[i], list, i);
+        }
+    } else {
+        int childrenCount = 0;
+        Statement *** children = statement->getChildren(statement, &childrenCount);
+        for(int i=0; i<childrenCount; i++) {
+            changed |= expandNestedLoops(expansion, children[i], NULL, 0);
+        }
+        free(children);
+    }
+    if(!changed && (statement->statementType == STATEMENT_WHILE || statement->statementType == STATEMENT_FOR)) {
+        changed = expandLoop(expansion, slot, parent, index);
+    }
+    return changed;
+}
+
+/**
+ * @brief Unrolls or peels loops of the body, each loop is expanded at most once per call
+ *
+ * @param body
+ * @param function function owning the body, NULL for main program
+ * @param functionTable
+ * @param program
+ * @param resultTable
+ * @return true if the body was changed
+ */
+bool expandLoops(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    if(getStatementSize(*body) > LOOP_MAX_BODY_SIZE) return false;
+    Statement * owner = function != NULL ? (Statement*)function : (Statement*)program;
+    LoopExpansion expansion = {.functionTable = functionTable, .program = program, .function = function, .resultTable = resultTable, .peels = NULL, .peelCount = 0, .unrolledCount = 0};
+    if(!expandNestedLoops(&expansion, body, NULL, 0)) return false;
+    invalidateResultsType(resultTable, owner);
+    // peeled iteration helps only if the optimizer can decide whether it runs or if it stabilizes types of the loop
+    int keptPeels = 0;
+    for(int i=0; i<expansion.peelCount; i++) {
+        LoopPeel * peel = &expansion.peels[i];
+        if(evaluateLoopExpression(&expansion, peel->peel->condition) != NULL || isPeelTypeStabilizing(&expansion, peel)) {
+            if(peel->remainingLoop != NULL) *getLoopPeelCount(peel->remainingLoop) = *getLoopPeelCount(peel->loop) + 1;
+            keptPeels++;
+        } else {
+            *expansion.peels[i].slot = expansion.peels[i].loop;
+        }
+    }
+    if(keptPeels < expansion.peelCount) invalidateResultsType(resultTable, owner);
+    free(expansion.peels);
+    return expansion.unrolledCount > 0 || keptPeels > 0;
+}
@@ -0,0 +1,17 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file loop_unroller.h
+ * @brief Header file for unrolling of while and for loops
+ */
+
+#ifndef __LOOP_UNROLLER_H__
+#define __LOOP_UNROLLER_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+#include "pointer_hashtable.h"
+
+bool expandLoops(Statement ** body, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable);
+
+#endif // __LOOP_UNROLLER_H__
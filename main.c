@@ -8,11 +8,31 @@
 
 #include <unistd.h>
 #include "parser.h"
+#include "optimizer.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 int main(int argc, char ** argv) {
+	// -j N sets number of threads used by the optimizer
+	for(int i=1; i<argc; i++) {
+		char * threadCount = NULL;
+		if(strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			threadCount = argv[++i];
+		} else if(strncmp(argv[i], "-j", 2) == 0 && argv[i][2] != '\0') {
+			threadCount = argv[i] + 2;
+		} else {
+			fprintf(stderr, "Unknown argument %s\n", argv[i]);
+			return 99;
+		}
+		char * end = NULL;
+		long count = strtol(threadCount, &end, 10);
+		if(*end != '\0' || count < 1) {
+			fprintf(stderr, "Invalid thread count %s\n", threadCount);
+			return 99;
+		}
+		setOptimizerThreadCount((int)count);
+	}
 	initParser();
 	if(parse()) {
 		fprintf(stderr, "OK\n");
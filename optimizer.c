@@ -7,7 +7,38 @@
  */
 
 #include "optimizer.h"
+#include "ssa.h"
+#include "call_graph.h"
+#include "inliner.h"
+#include "loop_unroller.h"
+#include "loop_invariant_motion.h"
+#include "induction_variables.h"
+#include "common_subexpressions.h"
+#include "algebraic_simplifier.h"
+#include "tail_recursion.h"
+#include "compile_time_evaluator.h"
+#include "specializer.h"
 #include <time.h>
+#include <pthread.h>
+
+/**
+ * @brief Body optimized during one round
+ */
+typedef struct {
+    Statement ** slot; /*<Slot of the main program or of the function statement>*/
+    Function * function; /*<NULL for the main program>*/
+    PointerTable * resultTable; /*<Cached types of this body only>*/
+    bool changed;
+} OptimizerTask;
+
+typedef struct {
+    OptimizerTask * tasks;
+    int taskCount;
+    int nextTask; /*<First task not taken by any thread>*/
+    pthread_mutex_t lock;
+    Table * functionTable;
+    StatementList * program;
+} OptimizerTaskQueue;
 
 Expression__Constant * performConstantCast(Expression__Constant * in, Type targetType, bool isBuiltin) {
     if(in->type.type == targetType.type) {
@@ -505,10 +536,27 @@ Expression__Constant * performConstantFolding(Expression__BinaryOperator * in) {
     return NULL;
 }
 
+/**
+ * @brief Checks if the statement does nothing, it is missing or contains only empty lists
+ */
+bool isEmptyStatement(Statement * statement) {
+    if(statement == NULL) return true;
+    if(statement->statementType != STATEMENT_LIST) return false;
+    StatementList * list = (StatementList *) statement;
+    for(int i=0; i<list->listSize; i++) {
+        if(!isEmptyStatement(list->statements[i])) return false;
+    }
+    return true;
+}
+
 Statement * performStatementFolding(Statement * in) {
     switch(in->statementType) {
         case STATEMENT_IF: {
             StatementIf* ifStatement = (StatementIf *) in;
+            // both branches were pruned, only evaluation of the condition is left
+            if(isEmptyStatement(ifStatement->ifBody) && isEmptyStatement(ifStatement->elseBody)) {
+                return (Statement *) ifStatement->condition;
+            }
             if(ifStatement->condition->expressionType == EXPRESSION_CONSTANT) {
                 Expression__Constant * condition = (Expression__Constant *) ifStatement->condition;
                 condition = performConstantCastCondition(condition);
@@ -682,6 +730,17 @@ Expression__Constant * performBuiltinFolding(Expression__FunctionCall * in, Func
     return NULL;
 }
 
+/**
+ * @brief Checks if the function is built in function without side effects, so its call can be moved or removed
+ * @note write and read functions are the only built in functions with side effects
+ *
+ * @param name name of the called function
+ */
+bool isPureBuiltinFunction(char * name) {
+    return strcmp(name, "floatval") == 0 || strcmp(name, "intval") == 0 || strcmp(name, "strval") == 0 || strcmp(name, "boolval") == 0 ||
+        strcmp(name, "strlen") == 0 || strcmp(name, "substring") == 0 || strcmp(name, "ord") == 0 || strcmp(name, "chr") == 0;
+}
+
 bool removeCodeAfterReturn(StatementList * in) {
     for(int i = 0; i < in->listSize-1; i++) {
         Statement * statement = in->statements[i];
@@ -803,21 +862,6 @@ bool replaceErrorsWithExit(Statement ** statement, Table * functionTable, Statem
     return false;
 }
 
-void unrollWhile(Statement ** statement, int iterationCount) {
-    if(iterationCount <= 0) return;
-    if((*statement)->statementType != STATEMENT_WHILE) return;
-    StatementWhile * whileStatement = (StatementWhile *) *statement;
-    StatementIf * generatedCondition = StatementIf__init();
-    generatedCondition->condition = (Expression*) whileStatement->condition->super.duplicate(&whileStatement->condition->super);
-    StatementList * generatedBody = StatementList__init();
-    generatedCondition->ifBody = (Statement*)generatedBody;
-    generatedCondition->elseBody = (Statement*)StatementList__init();
-    StatementList__addStatement(generatedBody, whileStatement->body);
-    StatementList__addStatement(generatedBody, (Statement*)whileStatement->super.duplicate(&whileStatement->super));
-    unrollWhile(&generatedBody->statements[generatedBody->listSize-1], iterationCount-1);
-    *statement = (Statement*)generatedCondition;
-}
-
 typedef struct {
     int assigments;
     int uses;
@@ -836,6 +880,27 @@ void clearTable(Table * table) {
     }
 }
 
+/**
+ * @brief Converts postfix increment or decrement whose value isnt used to prefix one, which is then replaced by addition
+ * @note value of postfix operator is the old value, so it cant be replaced by assignment inside other expression
+ *
+ * @param slot slot of whole statement or for loop increment
+ * @return true if the operator was converted
+ */
+bool convertUnusedPostfixOperator(Statement ** slot, Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable) {
+    if(*slot == NULL || (*slot)->statementType != STATEMENT_EXPRESSION || ((Expression *) *slot)->expressionType != EXPRESSION_POSTFIX_OPERATOR) return false;
+    Expression__PostfixOperator * postfix = (Expression__PostfixOperator *) *slot;
+    // code generator supports prefix increment only after its replacement, which is done only for numbers
+    if(postfix->operand->expressionType != EXPRESSION_VARIABLE) return false;
+    UnionType type = postfix->operand->getType(postfix->operand, functionTable, program, currentFunction, resultTable);
+    if(type.isInt == type.isFloat || type.isString || type.isBool || type.isNull || type.isUndefined) return false;
+    Expression__PrefixOperator * prefix = Expression__PrefixOperator__init();
+    prefix->operator = postfix->operator;
+    prefix->rSide = postfix->operand;
+    *slot = (Statement *) prefix;
+    return true;
+}
+
 bool optimizeStatement(Statement ** statement, Table * functionTable, StatementList * program, Function * currentFunction, Table * optimizerVarInfo, PointerTable * resultTable) {
     if(statement == NULL) return false;
     if(*statement == NULL) return false;
@@ -844,6 +909,7 @@ bool optimizeStatement(Statement ** statement, Table * functionTable, StatementL
         *statement = foldedStatement;
         return true;
     }
+    if((*statement)->statementType == STATEMENT_FOR && convertUnusedPostfixOperator((Statement **) &((StatementFor *) *statement)->increment, functionTable, program, currentFunction, resultTable)) return true;
     if((*statement)->statementType == STATEMENT_LIST) {
         // code for unwrapping statement lists, so there arent many nested lists after some optimizations
         if(removeCodeAfterReturn((StatementList *) *statement)) return true;
@@ -872,6 +938,11 @@ bool optimizeStatement(Statement ** statement, Table * functionTable, StatementL
                 return true;
             }
         }
+        bool convertedPostfix = false;
+        for(int i=0; i<((StatementList *) *statement)->listSize; i++) {
+            convertedPostfix |= convertUnusedPostfixOperator(&((StatementList *) *statement)->statements[i], functionTable, program, currentFunction, resultTable);
+        }
+        if(convertedPostfix) return true;
         // code for removing useless assignments, actually speedups optimization by around 13%
         int destIndex = 0;
         bool ret = false;
@@ -945,7 +1016,7 @@ bool optimizeStatement(Statement ** statement, Table * functionTable, StatementL
                         }
                         funcCall->arity -= copied;
                         mergedWrites |= copied > 0 || funcCall->arity == 0;
-                        if(copied == funcCall->arity) {
+                        if(funcCall->arity == 0) {
                             for(int j=i; j<((StatementList *) *statement)->listSize-1; j++) {
                                 ((StatementList *) *statement)->statements[j] = ((StatementList *) *statement)->statements[j+1];
                             }
@@ -978,6 +1049,12 @@ bool optimizeStatement(Statement ** statement, Table * functionTable, StatementL
                     containsUselessStatements = true;
                     break;
                 }
+                // value of the statement isnt used and its evaluation cant be observed, such as condition of pruned if
+                if(isInvariantExpression(NULL, expression) && !canExpressionFail(expression, currentFunction, functionTable, program, resultTable)) {
+                    ((StatementList *) *statement)->statements[i] = (Statement *) StatementList__init();
+                    containsUselessStatements = true;
+                    break;
+                }
             } else if(statementItem->statementType == STATEMENT_LIST && ((StatementList *) statementItem)->listSize == 0) {
                 containsUselessStatements = true;
                 break;
@@ -1013,6 +1090,7 @@ bool optimizeStatement(Statement ** statement, Table * functionTable, StatementL
                 *statement = (Statement *) constant;
                 return true;
             }
+            if(performAlgebraicSimplification((Expression **) statement, functionTable, program, currentFunction, resultTable)) return true;
             if(op->operator == TOKEN_ASSIGN && op->lSide->expressionType == EXPRESSION_VARIABLE) {
                 OptimizerVarInfo * info = table_find(optimizerVarInfo, ((Expression__Variable*)op->lSide)->name)->data;
                 if(info->assigments == info->uses) {
@@ -1020,6 +1098,8 @@ bool optimizeStatement(Statement ** statement, Table * functionTable, StatementL
                     return true;
                 }
             }
+        } else if(expression->expressionType == EXPRESSION_PREFIX_OPERATOR && ((Expression__PrefixOperator *) expression)->operator == TOKEN_NEGATE) {
+            return performAlgebraicSimplification((Expression **) statement, functionTable, program, currentFunction, resultTable);
         } else if(expression->expressionType == EXPRESSION_VARIABLE) {
             UnionType type = expression->getType(expression, functionTable, program, currentFunction, resultTable);
             if(type.constant != NULL) {
@@ -1028,6 +1108,27 @@ bool optimizeStatement(Statement ** statement, Table * functionTable, StatementL
                 *statement = constant;
                 return true;
             }
+        } else if(expression->expressionType == EXPRESSION_PREFIX_OPERATOR &&
+            (((Expression__PrefixOperator *) expression)->operator == TOKEN_INCREMENT || ((Expression__PrefixOperator *) expression)->operator == TOKEN_DECREMENT)) {
+            // increment of number is the same as addition, which is understood by the rest of the optimizer
+            Expression * operand = ((Expression__PrefixOperator *) expression)->rSide;
+            TokenType operator = ((Expression__PrefixOperator *) expression)->operator;
+            if(operand->expressionType != EXPRESSION_VARIABLE) return false;
+            UnionType type = operand->getType(operand, functionTable, program, currentFunction, resultTable);
+            if(type.isInt == type.isFloat || type.isString || type.isBool || type.isNull || type.isUndefined) return false;
+            Expression__Constant * one = Expression__Constant__init();
+            one->type = (Type){.type = TYPE_INT, .isRequired = true};
+            one->value.integer = 1;
+            Expression__BinaryOperator * addition = Expression__BinaryOperator__init();
+            addition->operator = operator == TOKEN_INCREMENT ? TOKEN_PLUS : TOKEN_MINUS;
+            addition->lSide = (Expression *) operand->super.duplicate((Statement *) operand);
+            addition->rSide = (Expression *) one;
+            Expression__BinaryOperator * assignment = Expression__BinaryOperator__init();
+            assignment->operator = TOKEN_ASSIGN;
+            assignment->lSide = operand;
+            assignment->rSide = (Expression *) addition;
+            *statement = (Statement *) assignment;
+            return true;
         } else if(expression->expressionType == EXPRESSION_FUNCTION_CALL) {
             Expression__FunctionCall * call = (Expression__FunctionCall *) expression;
             Function * function = table_find(functionTable, call->name)->data;
@@ -1129,118 +1230,158 @@ bool optimizeNestedStatements(Statement ** parent, Table * functionTable, Statem
     return optimized;
 }
 
-bool expandStatement(Statement ** statement, Table * functionTable, StatementList * program, Function * currentFunction) {
-    if(statement == NULL) return false;
-    if(*statement == NULL) return false;
-    if((*statement)->statementType == STATEMENT_WHILE) {
-        unrollWhile(statement, 1);
-        return true;
+int optimizerThreadCount = 1;
+
+/**
+ * @brief Sets number of threads used for optimizing function bodies
+ * 
+ * @param threadCount 
+ */
+void setOptimizerThreadCount(int threadCount) {
+    optimizerThreadCount = threadCount < 1 ? 1 : threadCount;
+}
+
+float getElapsedTime(struct timespec start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (float)(now.tv_sec - start.tv_sec) + (float)(now.tv_nsec - start.tv_nsec) / 1e9f;
+}
+
+/**
+ * @brief Optimizes single body until no more changes can be done with the same usage info
+ * 
+ * @return true if the body was changed
+ */
+bool optimizeBody(Statement ** slot, Function * function, Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    Statement * owner = function != NULL ? (Statement*)function : (Statement*)program;
+    bool changed = false;
+    Table * optimizerVarInfo = table_init();
+    buildNestedStatementVarUsages(*slot, optimizerVarInfo);
+    bool continueSameTableOptimizing = true;
+    while(continueSameTableOptimizing) {
+        continueSameTableOptimizing = false;
+        continueSameTableOptimizing |= optimizeNestedStatements(slot, functionTable, program, function, optimizerVarInfo, resultTable);
+        continueSameTableOptimizing |= replaceErrorsWithExit(slot, functionTable, program, function, resultTable);
+        if(continueSameTableOptimizing) invalidateResultsType(resultTable, owner);
+        changed |= continueSameTableOptimizing;
     }
-    return false;
+    Statement ** body = function != NULL ? &function->body : slot;
+    if(performSSAOptimizations(body, functionTable, program, function, resultTable)) {
+        invalidateResultsType(resultTable, owner);
+        changed = true;
+    }
+    table_free(optimizerVarInfo);
+    return changed;
 }
 
-bool performNestedStatementsExpansion(Statement ** parent, Table * functionTable, StatementList * program, Function * currentFunction) {
-    if(parent == NULL || *parent == NULL) return false;
-    bool optimized = false;
-    int childrenCount = 0;
-    Statement *** children = (*parent)->getChildren(*parent, &childrenCount);
-    if(childrenCount == 0) return optimized;
-    for(int i=0; i<childrenCount; i++) {
-        optimized |= performNestedStatementsExpansion(children[i], functionTable, program, currentFunction);
+void * optimizerWorker(void * queuePtr) {
+    OptimizerTaskQueue * queue = (OptimizerTaskQueue*)queuePtr;
+    while(true) {
+        pthread_mutex_lock(&queue->lock);
+        int taskIndex = queue->nextTask++;
+        pthread_mutex_unlock(&queue->lock);
+        if(taskIndex >= queue->taskCount) break;
+        OptimizerTask * task = &queue->tasks[taskIndex];
+        task->changed = optimizeBody(task->slot, task->function, queue->functionTable, queue->program, task->resultTable);
     }
-    free(children);
-    optimized |= expandStatement(parent, functionTable, program, currentFunction);
-    return optimized;
+    return NULL;
 }
 
-void optimize(StatementList * program, Table * functionTable) {
-    bool canLoopsBeOptimized = true;
-    size_t count = 0;
-    Statement *** statements = getAllStatements((Statement*)program, &count);
-    for(int i=0; i<count; i++) {
-        if(statements[i] == NULL) continue;
-        if(*statements[i] == NULL) continue;
-        Statement * statement = *statements[i];
-        if(statement->statementType == STATEMENT_BREAK || statement->statementType == STATEMENT_CONTINUE) {
-            canLoopsBeOptimized = false;
-            break;
+/**
+ * @brief Runs one optimization round of all bodies, with more threads the bodies are optimized in parallel
+ * @note every task gets private copy of its cached types, so shared tables are only read during the round
+ * 
+ * @return true if any body was changed
+ */
+bool runOptimizerTasks(OptimizerTask * tasks, int taskCount, Table * functionTable, StatementList * program, PointerTable * resultTable) {
+    for(int i=0; i<taskCount; i++) {
+        Statement * owner = tasks[i].function != NULL ? (Statement*)tasks[i].function : (Statement*)program;
+        tasks[i].resultTable = pointer_table_init();
+        tasks[i].changed = false;
+        PointerTableItem * item = pointer_table_remove(resultTable, owner);
+        if(item != NULL) {
+            pointer_table_insert(tasks[i].resultTable, owner, item->data);
+            free(item);
         }
     }
-    free(statements);
+    OptimizerTaskQueue queue = {.tasks = tasks, .taskCount = taskCount, .nextTask = 0, .functionTable = functionTable, .program = program};
+    pthread_mutex_init(&queue.lock, NULL);
+    int threadCount = optimizerThreadCount < taskCount ? optimizerThreadCount : taskCount;
+    pthread_t * threads = malloc(sizeof(pthread_t) * (threadCount + 1));
+    int startedThreads = 0;
+    for(int i=1; i<threadCount; i++) {
+        if(pthread_create(&threads[startedThreads], NULL, optimizerWorker, &queue) != 0) break;
+        startedThreads++;
+    }
+    optimizerWorker(&queue);
+    for(int i=0; i<startedThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&queue.lock);
+    bool changed = false;
+    for(int i=0; i<taskCount; i++) {
+        Statement * owner = tasks[i].function != NULL ? (Statement*)tasks[i].function : (Statement*)program;
+        PointerTableItem * item = pointer_table_find(tasks[i].resultTable, owner);
+        if(item != NULL) pointer_table_insert(resultTable, owner, item->data);
+        pointer_table_free(tasks[i].resultTable);
+        changed |= tasks[i].changed;
+    }
+    return changed;
+}
+
+void optimize(StatementList * program, Table * functionTable) {
+    evaluateProgram(program, functionTable);
+    eliminateTailRecursion(program, functionTable);
+    inlineFunctions(program, functionTable);
+    // cached variable types are kept between rounds, only changed bodies are analyzed again
+    PointerTable * resultTable = pointer_table_init();
+    // clones have to exist before the tasks are created
+    specializeFunctions(program, functionTable, resultTable);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    float optimizationTime = 0;
+    bool continueOptimizing = true;
+    bool continueUpdatingTypes = true;
+    // program and every function are independent tasks of each round
+    int taskCount = 1;
+    OptimizerTask * tasks = malloc(sizeof(OptimizerTask));
+    tasks[0] = (OptimizerTask){.slot = (Statement**)&program, .function = NULL};
     for(int i = 0; i < TB_SIZE; i++) {
         TableItem* item = functionTable->tb[i];
         while(item != NULL) {
-            Function * function = (Function *) item->data;
-            if(function->body == NULL) {
-                item = item->next;
-                continue;
-            }
-            size_t count = 0;
-            Statement *** statements = getAllStatements(function->body, &count);
-            for(int i=0; i<count; i++) {
-                if(statements[i] == NULL) continue;
-                if(*statements[i] == NULL) continue;
-                Statement * statement = *statements[i];
-                if(statement->statementType == STATEMENT_BREAK || statement->statementType == STATEMENT_CONTINUE) {
-                    canLoopsBeOptimized = false;
-                    break;
-                }
+            if(((Function*)item->data)->body != NULL) {
+                tasks = realloc(tasks, sizeof(OptimizerTask) * (taskCount + 1));
+                tasks[taskCount++] = (OptimizerTask){.slot = (Statement**)&item->data, .function = (Function*)item->data};
             }
-            free(statements);
-            if(!canLoopsBeOptimized) break;
             item = item->next;
         }
-        if(!canLoopsBeOptimized) break;
     }
-    if(canLoopsBeOptimized) {
-        fprintf(stderr, "Loops can be optimized\n");
-    } else {
-        fprintf(stderr, "Loops can not be optimized\n");
-    }
-    clock_t start = clock();
-    float optimizationTime = 0;
-    bool continueOptimizing = true;
-    bool continueUpdatingTypes = true;
+    // calls are evaluated outside of parallel tasks, because the evaluation reads bodies of other functions
+    Table * evaluatedCalls = table_init();
     while(continueUpdatingTypes) {
-        if(canLoopsBeOptimized) performNestedStatementsExpansion((Statement**)&program, functionTable, program, NULL);
         continueUpdatingTypes = false;
+        for(int i=0; i<taskCount; i++) {
+            Statement ** body = tasks[i].function != NULL ? &tasks[i].function->body : tasks[i].slot;
+            continueUpdatingTypes |= foldConstantCalls(body, tasks[i].function, functionTable, program, resultTable, evaluatedCalls);
+            continueUpdatingTypes |= expandLoops(body, tasks[i].function, functionTable, program, resultTable);
+            continueUpdatingTypes |= hoistLoopInvariants(body, tasks[i].function, functionTable, program, resultTable);
+            continueUpdatingTypes |= reduceInductionVariables(body, tasks[i].function, functionTable, program, resultTable);
+            continueUpdatingTypes |= eliminateCommonSubexpressions(body, tasks[i].function, functionTable, program, resultTable);
+        }
         while(continueOptimizing) {
             continueOptimizing = false;
-            PointerTable * resultTable = pointer_table_init();
-            Table * optimizerVarInfo = table_init();
-            buildNestedStatementVarUsages((Statement*)program, optimizerVarInfo);
-            bool continueSameTableOptimizing = true;
-            while(continueSameTableOptimizing) {
-                continueSameTableOptimizing = false;
-                continueSameTableOptimizing |= optimizeNestedStatements((Statement**)&program, functionTable, program, NULL, optimizerVarInfo, resultTable);
-                continueSameTableOptimizing |= replaceErrorsWithExit((Statement**)&program, functionTable, program, NULL, resultTable);
-                continueOptimizing |= continueSameTableOptimizing;
-            }
-            table_free(optimizerVarInfo);
-            pointer_table_free(resultTable);
-            for(int i = 0; i < TB_SIZE; i++) {
-                TableItem* item = functionTable->tb[i];
-                while(item != NULL) {
-                    resultTable = pointer_table_init();
-                    optimizerVarInfo = table_init();
-                    buildNestedStatementVarUsages((Statement*)item->data, optimizerVarInfo);
-                    bool continueSameTableOptimizing = true;
-                    while(continueSameTableOptimizing) {
-                        continueSameTableOptimizing = false;
-                        continueSameTableOptimizing |= optimizeNestedStatements((Statement**)&item->data, functionTable, program, (Function*)item->data, optimizerVarInfo, resultTable);
-                        continueSameTableOptimizing |= replaceErrorsWithExit((Statement**)&item->data, functionTable, program, (Function*)item->data, resultTable);
-                        continueOptimizing |= continueSameTableOptimizing;
-                    }
-                    table_free(optimizerVarInfo);
-                    pointer_table_free(resultTable);
-                    item = item->next;
-                }
-            }
+            if(inferFunctionParameterTypes(functionTable, program, resultTable)) continueOptimizing = true;
+            if(inferFunctionReturnTypes(functionTable, program, resultTable)) continueOptimizing = true;
+            continueOptimizing |= runOptimizerTasks(tasks, taskCount, functionTable, program, resultTable);
             if(continueOptimizing) continueUpdatingTypes = true;
-            optimizationTime = (float)(clock() - start) / CLOCKS_PER_SEC;
+            optimizationTime = getElapsedTime(start);
             if(optimizationTime >= 0.5) break;
         }
         continueOptimizing = true;
         if(optimizationTime >= 0.3) break;
     }
+    free(tasks);
+    pointer_table_free(resultTable);
+    table_free(evaluatedCalls);
 }
\ No newline at end of file
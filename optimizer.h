@@ -18,6 +18,9 @@ Expression__Constant * performConstantCast(Expression__Constant * in, Type targe
 Expression__Constant * performConstantCastCondition(Expression__Constant * in);
 Expression__Constant * performConstantFolding(Expression__BinaryOperator * in);
 Statement * performStatementFolding(Statement * in);
+Expression__Constant * performBuiltinFolding(Expression__FunctionCall * in, Function * function);
+bool isPureBuiltinFunction(char * name);
+void setOptimizerThreadCount(int threadCount);
 void optimize(StatementList * program, Table * functionTable);
 
 #endif // __OPTIMIZER_H__
\ No newline at end of file
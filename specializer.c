@@ -0,0 +1,326 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file specializer.c
+ * @brief Specialization of user functions by argument types
+ */
+
+#include "specializer.h"
+#include "call_graph.h"
+#include "string_builder.h"
+
+#define SPECIALIZE_FUNCTION_SIZE 1000 /*<Only functions up to this number of nodes are cloned>*/
+#define SPECIALIZE_MAX_CLONES 16 /*<Clones created in the whole program>*/
+#define SPECIALIZE_MAX_CONSTANTS 4 /*<Parameters getting more different constants are specialized only by types>*/
+#define SPECIALIZE_MAX_ROUNDS 4 /*<Calls in bodies of new clones are specialized in the next round>*/
+
+typedef struct {
+    Function * origin; /*<Function from the source program>*/
+    Function * function; /*<Function called with the signature, origin itself or its clone>*/
+    UnionType * signature; /*<Types of arguments restricted to the declared parameter types>*/
+} Specialization;
+
+typedef struct {
+    Expression__FunctionCall * call;
+    Function * caller; /*<NULL in the main program>*/
+    Function * origin;
+    UnionType * signature; /*<NULL if some argument always fails the type check>*/
+    bool isRecursive; /*<Caller is the origin or its clone, such calls dont create new specializations>*/
+} SpecializedCall;
+
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    PointerTable * resultTable;
+    Specialization * specializations;
+    int specializationCount;
+    int cloneCount;
+    SpecializedCall * calls;
+    int callCount;
+} Specializer;
+
+bool areSignaturesEqual(UnionType * a, UnionType * b, int arity) {
+    for(int i=0; i<arity; i++) {
+        if(!areUnionTypesEqual(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+Function * getSpecializationOrigin(Specializer * specializer, Function * function) {
+    for(int i=0; i<specializer->specializationCount; i++) {
+        if(specializer->specializations[i].function == function) return specializer->specializations[i].origin;
+    }
+    return function;
+}
+
+/**
+ * @brief Finds function specialized for the signature, origin is returned for its own signature
+ */
+Function * findSpecialization(Specializer * specializer, Function * origin, UnionType * signature) {
+    for(int i=0; i<specializer->specializationCount; i++) {
+        Specialization * specialization = &specializer->specializations[i];
+        if(specialization->origin == origin && areSignaturesEqual(specialization->signature, signature, origin->arity)) return specialization->function;
+    }
+    return NULL;
+}
+
+bool isSpecialized(Specializer * specializer, Function * origin) {
+    for(int i=0; i<specializer->specializationCount; i++) {
+        if(specializer->specializations[i].origin == origin) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Assigns the signature to the function, its parameters get the types of the signature
+ * @note recursive calls are typed with the signature in the next round, inference of parameter types widens the types again if some call doesnt match
+ */
+void addSpecialization(Specializer * specializer, Function * origin, Function * function, UnionType * signature) {
+    specializer->specializations = realloc(specializer->specializations, sizeof(Specialization) * (specializer->specializationCount + 1));
+    UnionType * signatureCopy = malloc(sizeof(UnionType) * (origin->arity + 1));
+    for(int i=0; i<origin->arity; i++) {
+        signatureCopy[i] = signature[i];
+    }
+    specializer->specializations[specializer->specializationCount++] = (Specialization){.origin = origin, .function = function, .signature = signatureCopy};
+    for(int i=0; i<function->arity; i++) {
+        setInferredParameterType(function, i, signature[i]);
+    }
+    invalidateResultsType(specializer->resultTable, (Statement*)function);
+}
+
+/**
+ * @brief Collects calls of user functions together with types of their arguments
+ */
+void collectSpecializedCalls(Specializer * specializer, Statement * body, Function * caller) {
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(body, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_FUNCTION_CALL) continue;
+        Expression__FunctionCall * call = (Expression__FunctionCall*)statement;
+        TableItem * item = table_find(specializer->functionTable, call->name);
+        if(item == NULL) continue;
+        Function * callee = (Function*)item->data;
+        if(callee->body == NULL || callee->arity == 0 || call->arity != callee->arity) continue;
+        UnionType * signature = malloc(sizeof(UnionType) * callee->arity);
+        for(int j=0; j<call->arity; j++) {
+            UnionType type = call->arguments[j]->getType(call->arguments[j], specializer->functionTable, specializer->program, caller, specializer->resultTable);
+            signature[j] = restrictToDeclaredType(type, callee->parameterTypes[j]);
+            if(!signature[j].isInt && !signature[j].isFloat && !signature[j].isString && !signature[j].isBool && !signature[j].isNull) {
+                free(signature);
+                signature = NULL;
+                break;
+            }
+        }
+        specializer->calls = realloc(specializer->calls, sizeof(SpecializedCall) * (specializer->callCount + 1));
+        Function * origin = getSpecializationOrigin(specializer, callee);
+        bool isRecursive = caller != NULL && getSpecializationOrigin(specializer, caller) == origin;
+        specializer->calls[specializer->callCount++] = (SpecializedCall){.call = call, .caller = caller, .origin = origin, .signature = signature, .isRecursive = isRecursive};
+    }
+    free(allStatements);
+}
+
+/**
+ * @brief Drops constants of parameters which get too many different constants, the calls would need too many clones
+ */
+void limitSignatureConstants(Specializer * specializer) {
+    Expression * constants[SPECIALIZE_MAX_CONSTANTS + 1];
+    for(int i=0; i<specializer->callCount; i++) {
+        SpecializedCall * call = &specializer->calls[i];
+        if(call->signature == NULL) continue;
+        for(int j=0; j<call->origin->arity; j++) {
+            if(call->signature[j].constant == NULL) continue;
+            int constantCount = 0;
+            for(int k=0; k<specializer->callCount && constantCount <= SPECIALIZE_MAX_CONSTANTS; k++) {
+                SpecializedCall * other = &specializer->calls[k];
+                if(other->origin != call->origin || other->signature == NULL || other->isRecursive || other->signature[j].constant == NULL) continue;
+                bool isKnown = false;
+                for(int l=0; l<constantCount; l++) {
+                    if(isSameConstant(constants[l], other->signature[j].constant)) isKnown = true;
+                }
+                if(!isKnown) constants[constantCount++] = other->signature[j].constant;
+            }
+            if(constantCount <= SPECIALIZE_MAX_CONSTANTS) continue;
+            for(int k=0; k<specializer->callCount; k++) {
+                SpecializedCall * other = &specializer->calls[k];
+                if(other->origin == call->origin && other->signature != NULL) other->signature[j].constant = NULL;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Checks if the function is called with different argument types and is small enough to be cloned
+ */
+bool shouldSpecialize(Specializer * specializer, Function * origin) {
+    if(isSpecialized(specializer, origin)) return true;
+    if(getStatementSize(origin->body) > SPECIALIZE_FUNCTION_SIZE) return false;
+    UnionType * firstSignature = NULL;
+    for(int i=0; i<specializer->callCount; i++) {
+        SpecializedCall * call = &specializer->calls[i];
+        if(call->origin != origin || call->signature == NULL || call->isRecursive) continue;
+        if(firstSignature == NULL) {
+            firstSignature = call->signature;
+        } else if(!areSignaturesEqual(firstSignature, call->signature, origin->arity)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Creates copy of the function under new name, types of its parameters are inferred from calls redirected to it
+ */
+Function * cloneFunction(Specializer * specializer, Function * origin) {
+    Function * clone = Function__init();
+    StringBuilder sb;
+    StringBuilder__init(&sb);
+    StringBuilder__appendString(&sb, origin->name);
+    StringBuilder__appendChar(&sb, '&');
+    StringBuilder__appendInt(&sb, specializer->cloneCount++);
+    clone->name = sb.text;
+    clone->returnType = origin->returnType;
+    clone->arity = origin->arity;
+    clone->parameterTypes = malloc(sizeof(Type) * origin->arity);
+    clone->parameterNames = malloc(sizeof(char*) * origin->arity);
+    for(int i=0; i<origin->arity; i++) {
+        clone->parameterTypes[i] = origin->parameterTypes[i];
+        clone->parameterNames[i] = origin->parameterNames[i];
+    }
+    clone->body = origin->body->duplicate(origin->body);
+    // recursive calls stay in the clone, otherwise they would widen types of the origin
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(clone->body, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_FUNCTION_CALL) continue;
+        Expression__FunctionCall * call = (Expression__FunctionCall*)statement;
+        if(strcmp(call->name, origin->name) == 0) call->name = clone->name;
+    }
+    free(allStatements);
+    table_insert(specializer->functionTable, clone->name, clone);
+    return clone;
+}
+
+/**
+ * @brief Redirects calls to functions specialized for types of their arguments, missing clones are created within the budget
+ * @note first signature of the function is kept by the function itself
+ *
+ * @return true if any call was redirected
+ */
+bool redirectSpecializedCalls(Specializer * specializer) {
+    bool changed = false;
+    for(int i=0; i<specializer->callCount; i++) {
+        SpecializedCall * call = &specializer->calls[i];
+        if(call->signature == NULL || !shouldSpecialize(specializer, call->origin)) continue;
+        Function * target = findSpecialization(specializer, call->origin, call->signature);
+        if(target == NULL) {
+            // types of recursive calls depend on the types of the caller, which change after redirection
+            if(call->isRecursive) continue;
+            if(!isSpecialized(specializer, call->origin)) {
+                target = call->origin;
+            } else if(specializer->cloneCount < SPECIALIZE_MAX_CLONES) {
+                target = cloneFunction(specializer, call->origin);
+            } else {
+                continue;
+            }
+            addSpecialization(specializer, call->origin, target, call->signature);
+        }
+        if(strcmp(call->call->name, target->name) == 0) continue;
+        call->call->name = target->name;
+        invalidateResultsType(specializer->resultTable, call->caller != NULL ? (Statement*)call->caller : (Statement*)specializer->program);
+        changed = true;
+    }
+    return changed;
+}
+
+/**
+ * @brief Removes clones which arent reachable from the program or from functions of the source program
+ */
+void removeUnreachableClones(Specializer * specializer) {
+    CallGraph * graph = CallGraph__build(specializer->functionTable);
+    bool * isReachable = calloc(graph->functionCount + 1, sizeof(bool));
+    int * stack = malloc(sizeof(int) * (graph->functionCount + 1));
+    int stackSize = 0;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements((Statement*)specializer->program, &statementCount);
+    for(size_t i=0; i<statementCount; i++) {
+        Statement * statement = *allStatements[i];
+        if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_FUNCTION_CALL) continue;
+        int index = CallGraph__getIndex(graph, ((Expression__FunctionCall*)statement)->name);
+        if(index < 0 || isReachable[index]) continue;
+        isReachable[index] = true;
+        stack[stackSize++] = index;
+    }
+    free(allStatements);
+    // functions of the source program are kept even if they arent called, so their calls have to stay valid
+    for(int i=0; i<graph->functionCount; i++) {
+        if(isReachable[i] || getSpecializationOrigin(specializer, graph->functions[i]) != graph->functions[i]) continue;
+        isReachable[i] = true;
+        stack[stackSize++] = i;
+    }
+    while(stackSize > 0) {
+        int function = stack[--stackSize];
+        for(int i=0; i<graph->calleeCounts[function]; i++) {
+            int callee = graph->callees[function][i];
+            if(isReachable[callee]) continue;
+            isReachable[callee] = true;
+            stack[stackSize++] = callee;
+        }
+    }
+    for(int i=0; i<specializer->specializationCount; i++) {
+        Specialization * specialization = &specializer->specializations[i];
+        if(specialization->function == specialization->origin) continue;
+        if(isReachable[CallGraph__getIndex(graph, specialization->function->name)]) continue;
+        free(table_remove(specializer->functionTable, specialization->function->name));
+    }
+    free(isReachable);
+    free(stack);
+    CallGraph__free(graph);
+}
+
+/**
+ * @brief Clones user functions for every distinct combination of argument types and constants seen at their calls
+ * @note soundness doesnt depend on the signatures, types of parameters of every function are still inferred from all its calls
+ *
+ * @return true if any call was redirected
+ */
+bool specializeFunctions(StatementList * program, Table * functionTable, PointerTable * resultTable) {
+    Specializer specializer = {0};
+    specializer.functionTable = functionTable;
+    specializer.program = program;
+    specializer.resultTable = resultTable;
+    bool changedAny = false;
+    for(int round=0; round<SPECIALIZE_MAX_ROUNDS; round++) {
+        inferFunctionParameterTypes(functionTable, program, resultTable);
+        inferFunctionReturnTypes(functionTable, program, resultTable);
+        collectSpecializedCalls(&specializer, (Statement*)program, NULL);
+        for(int i = 0; i < TB_SIZE; i++) {
+            TableItem * item = functionTable->tb[i];
+            while(item != NULL) {
+                Function * function = (Function*)item->data;
+                if(function->body != NULL) collectSpecializedCalls(&specializer, function->body, function);
+                item = item->next;
+            }
+        }
+        limitSignatureConstants(&specializer);
+        bool changed = redirectSpecializedCalls(&specializer);
+        for(int i=0; i<specializer.callCount; i++) {
+            free(specializer.calls[i].signature);
+        }
+        free(specializer.calls);
+        specializer.calls = NULL;
+        specializer.callCount = 0;
+        if(!changed) break;
+        changedAny = true;
+    }
+    if(changedAny) {
+        removeUnreachableClones(&specializer);
+        inferFunctionParameterTypes(functionTable, program, resultTable);
+        inferFunctionReturnTypes(functionTable, program, resultTable);
+    }
+    for(int i=0; i<specializer.specializationCount; i++) {
+        free(specializer.specializations[i].signature);
+    }
+    free(specializer.specializations);
+    return changedAny;
+}
@@ -0,0 +1,17 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file specializer.h
+ * @brief Header file for specialization of user functions by argument types
+ */
+
+#ifndef __SPECIALIZER_H__
+#define __SPECIALIZER_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+#include "pointer_hashtable.h"
+
+bool specializeFunctions(StatementList * program, Table * functionTable, PointerTable * resultTable);
+
+#endif // __SPECIALIZER_H__
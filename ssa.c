@@ -0,0 +1,983 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file ssa.c
+ * @brief SSA form of function bodies and optimizations working on it
+ */
+
+#include "ssa.h"
+#include "optimizer.h"
+#include "loop_invariant_motion.h"
+
+/**
+ * @brief Definitions of all variables at some point of the program
+ */
+typedef struct {
+    SSADefinition ** definitions;
+    SSABlock * block;
+    bool isReachable;
+} SSAState;
+
+/**
+ * @brief States of the program at break and continue statements of a loop
+ */
+typedef struct {
+    int breakCount;
+    SSAState * breakStates;
+    int continueCount;
+    SSAState * continueStates;
+} SSALoop;
+
+typedef struct {
+    SSAForm * form;
+    int loopCount;
+    SSALoop ** loops;
+} SSABuilder;
+
+SSABlock * SSAForm__addBlock(SSAForm * this, SSABlock * parent, Expression * guard, bool guardValue, bool isUnreachable) {
+    SSABlock * block = malloc(sizeof(SSABlock));
+    block->parent = parent;
+    block->guard = guard;
+    block->guardValue = guardValue;
+    block->isUnreachable = isUnreachable;
+    this->blocks = realloc(this->blocks, sizeof(SSABlock*) * (this->blockCount + 1));
+    this->blocks[this->blockCount++] = block;
+    return block;
+}
+
+SSADefinition * SSAForm__addDefinition(SSAForm * this, SSADefinitionType type, int variable, SSABlock * block) {
+    SSADefinition * definition = malloc(sizeof(SSADefinition));
+    *definition = (SSADefinition){0};
+    definition->type = type;
+    definition->variable = variable;
+    definition->block = block;
+    definition->value.state = SSA_VALUE_TOP;
+    this->definitions = realloc(this->definitions, sizeof(SSADefinition*) * (this->definitionCount + 1));
+    this->definitions[this->definitionCount++] = definition;
+    return definition;
+}
+
+void SSADefinition__addOperand(SSADefinition * this, SSADefinition * operand, SSABlock * block) {
+    this->operands = realloc(this->operands, sizeof(SSADefinition*) * (this->operandCount + 1));
+    this->operandBlocks = realloc(this->operandBlocks, sizeof(SSABlock*) * (this->operandCount + 1));
+    this->operands[this->operandCount] = operand;
+    this->operandBlocks[this->operandCount] = block;
+    this->operandCount++;
+}
+
+int getSSAVariableIndex(SSAForm * form, char * name) {
+    TableItem * item = table_find(form->variableIndices, name);
+    if(item == NULL) return -1;
+    return *(int*)item->data;
+}
+
+SSAState copySSAState(SSAForm * form, SSAState * state) {
+    SSAState copy = *state;
+    copy.definitions = malloc(sizeof(SSADefinition*) * (form->variableCount + 1));
+    memcpy(copy.definitions, state->definitions, sizeof(SSADefinition*) * form->variableCount);
+    return copy;
+}
+
+void markSSAStateUnreachable(SSAForm * form, SSAState * state) {
+    state->isReachable = false;
+    state->block = SSAForm__addBlock(form, state->block, NULL, false, true);
+}
+
+/**
+ * @brief Joins states of multiple paths, phi is created for every variable with different definitions
+ */
+SSAState mergeSSAStates(SSAForm * form, SSAState * states, int count, SSABlock * block) {
+    SSAState merged = {0};
+    merged.definitions = malloc(sizeof(SSADefinition*) * (form->variableCount + 1));
+    merged.block = block;
+    merged.isReachable = false;
+    for(int i=0; i<count; i++) {
+        merged.isReachable |= states[i].isReachable;
+    }
+    if(!merged.isReachable) {
+        if(count > 0) memcpy(merged.definitions, states[0].definitions, sizeof(SSADefinition*) * form->variableCount);
+        merged.block = SSAForm__addBlock(form, block, NULL, false, true);
+        return merged;
+    }
+    for(int v=0; v<form->variableCount; v++) {
+        SSADefinition * common = NULL;
+        bool isSame = true;
+        for(int i=0; i<count; i++) {
+            if(!states[i].isReachable) continue;
+            if(common == NULL) {
+                common = states[i].definitions[v];
+            } else if(common != states[i].definitions[v]) {
+                isSame = false;
+            }
+        }
+        if(isSame) {
+            merged.definitions[v] = common;
+            continue;
+        }
+        SSADefinition * phi = SSAForm__addDefinition(form, SSA_DEFINITION_PHI, v, block);
+        for(int i=0; i<count; i++) {
+            if(!states[i].isReachable) continue;
+            SSADefinition__addOperand(phi, states[i].definitions[v], states[i].block);
+        }
+        merged.definitions[v] = phi;
+    }
+    return merged;
+}
+
+void recordSSAUse(SSAForm * form, Expression ** slot, SSAState * state, SSADefinition * owner, bool isReplaceable) {
+    Expression__Variable * variable = (Expression__Variable*)*slot;
+    int index = getSSAVariableIndex(form, variable->name);
+    if(index < 0 || pointer_table_find(form->useTable, variable) != NULL) {
+        // unknown variable or node shared between multiple places of the tree
+        form->isValid = false;
+        return;
+    }
+    SSAUse * use = malloc(sizeof(SSAUse));
+    use->slot = slot;
+    use->definition = state->definitions[index];
+    use->copySource = NULL;
+    use->owner = owner;
+    use->block = state->block;
+    use->isReplaceable = isReplaceable;
+    if(use->definition->type == SSA_DEFINITION_ASSIGNMENT && use->definition->assignment->rSide->expressionType == EXPRESSION_VARIABLE) {
+        int sourceIndex = getSSAVariableIndex(form, ((Expression__Variable*)use->definition->assignment->rSide)->name);
+        if(sourceIndex >= 0) use->copySource = state->definitions[sourceIndex];
+    }
+    if(owner != NULL) {
+        owner->ownedUses = realloc(owner->ownedUses, sizeof(SSAUse*) * (owner->ownedUseCount + 1));
+        owner->ownedUses[owner->ownedUseCount++] = use;
+    }
+    form->uses = realloc(form->uses, sizeof(SSAUse*) * (form->useCount + 1));
+    form->uses[form->useCount++] = use;
+    pointer_table_insert(form->useTable, variable, use);
+}
+
+void walkSSAExpression(SSABuilder * builder, Expression ** slot, SSAState * state, SSADefinition * owner);
+
+/**
+ * @brief Creates definition for assignment, statementSlot is set only if the assignment is whole statement
+ *
+ * @return SSADefinition* created definition or NULL if the form isnt valid
+ */
+SSADefinition * walkSSAAssignment(SSABuilder * builder, Expression__BinaryOperator * assignment, Statement ** statementSlot, bool isExpressionSlot, SSAState * state) {
+    SSAForm * form = builder->form;
+    if(assignment->lSide->expressionType != EXPRESSION_VARIABLE) {
+        form->isValid = false;
+        return NULL;
+    }
+    int index = getSSAVariableIndex(form, ((Expression__Variable*)assignment->lSide)->name);
+    if(index < 0) {
+        form->isValid = false;
+        return NULL;
+    }
+    SSADefinition * definition = SSAForm__addDefinition(form, SSA_DEFINITION_ASSIGNMENT, index, state->block);
+    definition->assignment = assignment;
+    definition->statementSlot = statementSlot;
+    definition->isExpressionSlot = isExpressionSlot;
+    walkSSAExpression(builder, &assignment->rSide, state, statementSlot != NULL ? definition : NULL);
+    definition->block = state->block;
+    state->definitions[index] = definition;
+    return definition;
+}
+
+/**
+ * @brief Creates definition for increment or decrement of the operand
+ *
+ * @param nestedSlot slot of the operator if it can be replaced by the operand when its definition is dead
+ */
+void walkSSAIncrement(SSABuilder * builder, Expression ** operand, TokenType operator, Expression ** nestedSlot, SSAState * state) {
+    SSAForm * form = builder->form;
+    if((*operand)->expressionType != EXPRESSION_VARIABLE) {
+        form->isValid = false;
+        return;
+    }
+    recordSSAUse(form, operand, state, NULL, false);
+    if(!form->isValid) return;
+    int index = getSSAVariableIndex(form, ((Expression__Variable*)*operand)->name);
+    SSADefinition * definition = SSAForm__addDefinition(form, SSA_DEFINITION_CLOBBER, index, state->block);
+    definition->incremented = state->definitions[index];
+    definition->isDecrement = operator == TOKEN_DECREMENT;
+    definition->nestedSlot = nestedSlot;
+    state->definitions[index] = definition;
+}
+
+void walkSSAExpression(SSABuilder * builder, Expression ** slot, SSAState * state, SSADefinition * owner) {
+    SSAForm * form = builder->form;
+    if(!form->isValid || slot == NULL || *slot == NULL) return;
+    Expression * expression = *slot;
+    switch(expression->expressionType) {
+        case EXPRESSION_CONSTANT:
+            break;
+        case EXPRESSION_VARIABLE:
+            recordSSAUse(form, slot, state, owner, true);
+            break;
+        case EXPRESSION_FUNCTION_CALL: {
+            Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+            // code generator reads variable arguments only after all arguments are evaluated
+            for(int i=0; i<call->arity; i++) {
+                if(call->arguments[i]->expressionType != EXPRESSION_VARIABLE) walkSSAExpression(builder, &call->arguments[i], state, owner);
+            }
+            for(int i=0; i<call->arity; i++) {
+                if(call->arguments[i]->expressionType == EXPRESSION_VARIABLE) walkSSAExpression(builder, &call->arguments[i], state, owner);
+            }
+            break;
+        }
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            if(op->operator == TOKEN_ASSIGN) {
+                SSADefinition * definition = walkSSAAssignment(builder, op, NULL, false, state);
+                if(definition != NULL) definition->nestedSlot = slot;
+            } else if(op->operator == TOKEN_AND || op->operator == TOKEN_OR || op->operator == TOKEN_NULL_COALESCING) {
+                walkSSAExpression(builder, &op->lSide, state, owner);
+                // right side doesnt have to be evaluated, so its definitions are joined with the state before it
+                SSAState conditional = copySSAState(form, state);
+                conditional.block = SSAForm__addBlock(form, state->block, NULL, false, false);
+                walkSSAExpression(builder, &op->rSide, &conditional, owner);
+                SSAState states[2] = {*state, conditional};
+                SSAState merged = mergeSSAStates(form, states, 2, state->block);
+                free(state->definitions);
+                free(conditional.definitions);
+                *state = merged;
+            } else if(op->lSide->expressionType == EXPRESSION_VARIABLE) {
+                // variable operand is read by the operator itself, after the other operand is evaluated
+                walkSSAExpression(builder, &op->rSide, state, owner);
+                walkSSAExpression(builder, &op->lSide, state, owner);
+            } else {
+                walkSSAExpression(builder, &op->lSide, state, owner);
+                walkSSAExpression(builder, &op->rSide, state, owner);
+            }
+            break;
+        }
+        case EXPRESSION_PREFIX_OPERATOR: {
+            Expression__PrefixOperator * op = (Expression__PrefixOperator*)expression;
+            if(op->operator == TOKEN_INCREMENT || op->operator == TOKEN_DECREMENT) {
+                // value of prefix operator is the new value, so it cant be replaced by its operand when dead
+                walkSSAIncrement(builder, &op->rSide, op->operator, NULL, state);
+                break;
+            }
+            walkSSAExpression(builder, &op->rSide, state, owner);
+            break;
+        }
+        case EXPRESSION_POSTFIX_OPERATOR: {
+            Expression__PostfixOperator * op = (Expression__PostfixOperator*)expression;
+            walkSSAIncrement(builder, &op->operand, op->operator, slot, state);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Walks expression placed in header of for loop, assignments there can be removed as whole
+ */
+void walkSSAHeaderExpression(SSABuilder * builder, Expression ** slot, SSAState * state) {
+    if(*slot == NULL) return;
+    if((*slot)->expressionType == EXPRESSION_BINARY_OPERATOR && ((Expression__BinaryOperator*)*slot)->operator == TOKEN_ASSIGN) {
+        walkSSAAssignment(builder, (Expression__BinaryOperator*)*slot, (Statement**)slot, true, state);
+    } else {
+        walkSSAExpression(builder, slot, state, NULL);
+    }
+}
+
+void walkSSAStatement(SSABuilder * builder, Statement ** slot, SSAState * state);
+
+void walkSSALoop(SSABuilder * builder, Expression ** init, Expression ** condition, Expression ** increment, Statement ** body, SSAState * state) {
+    SSAForm * form = builder->form;
+    if(init != NULL) walkSSAHeaderExpression(builder, init, state);
+    SSABlock * outerBlock = state->block;
+    SSAState header = copySSAState(form, state);
+    SSADefinition ** phis = malloc(sizeof(SSADefinition*) * (form->variableCount + 1));
+    for(int v=0; v<form->variableCount; v++) {
+        phis[v] = SSAForm__addDefinition(form, SSA_DEFINITION_PHI, v, outerBlock);
+        header.definitions[v] = phis[v];
+    }
+    Expression * guard = NULL;
+    if(condition != NULL && *condition != NULL) {
+        walkSSAExpression(builder, condition, &header, NULL);
+        guard = *condition;
+    }
+    SSABlock * bodyBlock = SSAForm__addBlock(form, header.block, guard, true, false);
+    SSAState bodyState = copySSAState(form, &header);
+    bodyState.block = bodyBlock;
+    SSAState exitState = copySSAState(form, &header);
+    if(guard != NULL) {
+        exitState.block = SSAForm__addBlock(form, header.block, guard, false, false);
+    } else {
+        markSSAStateUnreachable(form, &exitState);
+    }
+
+    SSALoop * loop = malloc(sizeof(SSALoop));
+    *loop = (SSALoop){0};
+    builder->loops = realloc(builder->loops, sizeof(SSALoop*) * (builder->loopCount + 1));
+    builder->loops[builder->loopCount++] = loop;
+    walkSSAStatement(builder, body, &bodyState);
+    builder->loopCount--;
+
+    // continue jumps to the increment, the same place where the body ends
+    SSAState * latchStates = malloc(sizeof(SSAState) * (loop->continueCount + 1));
+    latchStates[0] = bodyState;
+    for(int i=0; i<loop->continueCount; i++) {
+        latchStates[i + 1] = loop->continueStates[i];
+    }
+    SSAState latch = mergeSSAStates(form, latchStates, loop->continueCount + 1, bodyBlock);
+    if(increment != NULL) walkSSAHeaderExpression(builder, increment, &latch);
+    for(int v=0; v<form->variableCount; v++) {
+        SSADefinition__addOperand(phis[v], state->definitions[v], outerBlock);
+        if(latch.isReachable) SSADefinition__addOperand(phis[v], latch.definitions[v], latch.block);
+    }
+
+    SSAState * exitStates = malloc(sizeof(SSAState) * (loop->breakCount + 1));
+    exitStates[0] = exitState;
+    for(int i=0; i<loop->breakCount; i++) {
+        exitStates[i + 1] = loop->breakStates[i];
+    }
+    SSAState merged = mergeSSAStates(form, exitStates, loop->breakCount + 1, outerBlock);
+
+    for(int i=0; i<loop->continueCount; i++) free(loop->continueStates[i].definitions);
+    for(int i=0; i<loop->breakCount; i++) free(loop->breakStates[i].definitions);
+    free(loop->continueStates);
+    free(loop->breakStates);
+    free(loop);
+    free(latchStates);
+    free(exitStates);
+    free(phis);
+    free(header.definitions);
+    free(bodyState.definitions);
+    free(exitState.definitions);
+    free(latch.definitions);
+    free(state->definitions);
+    *state = merged;
+}
+
+void walkSSAStatement(SSABuilder * builder, Statement ** slot, SSAState * state) {
+    SSAForm * form = builder->form;
+    if(!form->isValid || slot == NULL || *slot == NULL) return;
+    Statement * statement = *slot;
+    switch(statement->statementType) {
+        case STATEMENT_EXPRESSION: {
+            Expression * expression = (Expression*)statement;
+            if(expression->expressionType == EXPRESSION_BINARY_OPERATOR && ((Expression__BinaryOperator*)expression)->operator == TOKEN_ASSIGN) {
+                walkSSAAssignment(builder, (Expression__BinaryOperator*)expression, slot, false, state);
+            } else {
+                walkSSAExpression(builder, (Expression**)slot, state, NULL);
+            }
+            break;
+        }
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)statement;
+            for(int i=0; i<list->listSize; i++) {
+                walkSSAStatement(builder, &list->statements[i], state);
+            }
+            break;
+        }
+        case STATEMENT_IF: {
+            StatementIf * ifStatement = (StatementIf*)statement;
+            walkSSAExpression(builder, &ifStatement->condition, state, NULL);
+            SSAState thenState = copySSAState(form, state);
+            thenState.block = SSAForm__addBlock(form, state->block, ifStatement->condition, true, false);
+            SSAState elseState = copySSAState(form, state);
+            elseState.block = SSAForm__addBlock(form, state->block, ifStatement->condition, false, false);
+            walkSSAStatement(builder, &ifStatement->ifBody, &thenState);
+            walkSSAStatement(builder, &ifStatement->elseBody, &elseState);
+            SSAState states[2] = {thenState, elseState};
+            SSAState merged = mergeSSAStates(form, states, 2, state->block);
+            free(thenState.definitions);
+            free(elseState.definitions);
+            free(state->definitions);
+            *state = merged;
+            break;
+        }
+        case STATEMENT_WHILE: {
+            StatementWhile * whileStatement = (StatementWhile*)statement;
+            walkSSALoop(builder, NULL, &whileStatement->condition, NULL, &whileStatement->body, state);
+            break;
+        }
+        case STATEMENT_FOR: {
+            StatementFor * forStatement = (StatementFor*)statement;
+            walkSSALoop(builder, &forStatement->init, &forStatement->condition, &forStatement->increment, &forStatement->body, state);
+            break;
+        }
+        case STATEMENT_RETURN: {
+            StatementReturn * returnStatement = (StatementReturn*)statement;
+            walkSSAExpression(builder, &returnStatement->expression, state, NULL);
+            markSSAStateUnreachable(form, state);
+            break;
+        }
+        case STATEMENT_EXIT:
+            markSSAStateUnreachable(form, state);
+            break;
+        case STATEMENT_BREAK:
+        case STATEMENT_CONTINUE: {
+            int depth = statement->statementType == STATEMENT_BREAK ? ((StatementBreak*)statement)->depth : ((StatementContinue*)statement)->depth;
+            if(depth < 1 || depth > builder->loopCount) {
+                form->isValid = false;
+                return;
+            }
+            SSALoop * loop = builder->loops[builder->loopCount - depth];
+            if(state->isReachable) {
+                if(statement->statementType == STATEMENT_BREAK) {
+                    loop->breakStates = realloc(loop->breakStates, sizeof(SSAState) * (loop->breakCount + 1));
+                    loop->breakStates[loop->breakCount++] = copySSAState(form, state);
+                } else {
+                    loop->continueStates = realloc(loop->continueStates, sizeof(SSAState) * (loop->continueCount + 1));
+                    loop->continueStates[loop->continueCount++] = copySSAState(form, state);
+                }
+            }
+            markSSAStateUnreachable(form, state);
+            break;
+        }
+        case STATEMENT_FUNCTION:
+            form->isValid = false;
+            break;
+    }
+}
+
+/**
+ * @brief Replaces phis which join only one definition (and itself) by that definition
+ */
+void simplifySSAPhis(SSAForm * this) {
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(int i=0; i<this->definitionCount; i++) {
+            SSADefinition * definition = this->definitions[i];
+            if(definition->type != SSA_DEFINITION_PHI || definition->replacement != NULL) continue;
+            SSADefinition * unique = NULL;
+            bool isTrivial = true;
+            for(int j=0; j<definition->operandCount; j++) {
+                SSADefinition * operand = SSAForm__resolve(definition->operands[j]);
+                if(operand == definition) continue;
+                if(unique == NULL) {
+                    unique = operand;
+                } else if(unique != operand) {
+                    isTrivial = false;
+                    break;
+                }
+            }
+            if(isTrivial && unique != NULL) {
+                definition->replacement = unique;
+                changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Builds SSA form of the body
+ *
+ * @param body slot of the function body or main program
+ * @return SSAForm* check isValid before using
+ */
+SSAForm * SSAForm__build(Statement ** body, Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable) {
+    SSAForm * this = malloc(sizeof(SSAForm));
+    *this = (SSAForm){0};
+    this->functionTable = functionTable;
+    this->program = program;
+    this->currentFunction = currentFunction;
+    this->resultTable = resultTable;
+    this->variableIndices = table_init();
+    this->useTable = pointer_table_init();
+    this->isValid = true;
+
+    int capacity = 16;
+    this->variableNames = malloc(sizeof(char*) * capacity);
+    this->isParameter = malloc(sizeof(bool) * capacity);
+    int * indices = NULL;
+    size_t statementCount = 0;
+    Statement *** allStatements = getAllStatements(*body, &statementCount);
+    int parameterCount = currentFunction != NULL ? currentFunction->arity : 0;
+    for(int i=0; i<parameterCount + (int)statementCount; i++) {
+        char * name = NULL;
+        if(i < parameterCount) {
+            name = currentFunction->parameterNames[i];
+        } else {
+            Statement * statement = *allStatements[i - parameterCount];
+            if(statement == NULL || statement->statementType != STATEMENT_EXPRESSION || ((Expression*)statement)->expressionType != EXPRESSION_VARIABLE) continue;
+            name = ((Expression__Variable*)statement)->name;
+        }
+        if(table_find(this->variableIndices, name) != NULL) continue;
+        if(this->variableCount == capacity) {
+            capacity *= 2;
+            this->variableNames = realloc(this->variableNames, sizeof(char*) * capacity);
+            this->isParameter = realloc(this->isParameter, sizeof(bool) * capacity);
+        }
+        this->variableNames[this->variableCount] = name;
+        this->isParameter[this->variableCount] = i < parameterCount;
+        this->variableCount++;
+        // index is assigned once all variables are known
+        table_insert(this->variableIndices, name, NULL);
+    }
+    free(allStatements);
+    indices = malloc(sizeof(int) * (this->variableCount + 1));
+    for(int v=0; v<this->variableCount; v++) {
+        indices[v] = v;
+        table_find(this->variableIndices, this->variableNames[v])->data = &indices[v];
+    }
+
+    SSABuilder builder = {.form = this, .loopCount = 0, .loops = NULL};
+    SSAState state = {0};
+    state.block = SSAForm__addBlock(this, NULL, NULL, false, false);
+    state.isReachable = true;
+    state.definitions = malloc(sizeof(SSADefinition*) * (this->variableCount + 1));
+    for(int v=0; v<this->variableCount; v++) {
+        SSADefinition * entry = SSAForm__addDefinition(this, SSA_DEFINITION_ENTRY, v, NULL);
+        entry->value.state = SSA_VALUE_BOTTOM;
+        state.definitions[v] = entry;
+    }
+    walkSSAStatement(&builder, body, &state);
+    free(state.definitions);
+    free(builder.loops);
+    // indices are referenced from the table, they are freed together with it
+    table_insert(this->variableIndices, "", indices);
+    if(this->isValid) simplifySSAPhis(this);
+    return this;
+}
+
+SSADefinition * SSAForm__resolve(SSADefinition * definition) {
+    while(definition->replacement != NULL) {
+        definition = definition->replacement;
+    }
+    return definition;
+}
+
+SSAValue meetSSAValues(SSAValue a, SSAValue b) {
+    if(a.state == SSA_VALUE_TOP) return b;
+    if(b.state == SSA_VALUE_TOP) return a;
+    if(a.state == SSA_VALUE_BOTTOM || b.state == SSA_VALUE_BOTTOM) return (SSAValue){.state = SSA_VALUE_BOTTOM};
+    if(Expression__Constant__equals(a.constant, b.constant)) return a;
+    return (SSAValue){.state = SSA_VALUE_BOTTOM};
+}
+
+SSAValue constantSSAValue(Expression__Constant * constant) {
+    return (SSAValue){.state = SSA_VALUE_CONSTANT, .constant = constant};
+}
+
+SSAValue boolSSAValue(bool value) {
+    Expression__Constant * constant = Expression__Constant__init();
+    constant->type.type = TYPE_BOOL;
+    constant->type.isRequired = true;
+    constant->value.boolean = value;
+    return constantSSAValue(constant);
+}
+
+bool isSSAValueTrue(SSAValue value) {
+    return performConstantCastCondition(value.constant)->value.boolean;
+}
+
+/**
+ * @brief Folds operator on two constants, only combinations which can not fail at runtime are folded
+ */
+SSAValue foldSSAConstants(TokenType operator, Expression__Constant * left, Expression__Constant * right) {
+    bool isLeftNumber = left->type.type == TYPE_INT || left->type.type == TYPE_FLOAT;
+    bool isRightNumber = right->type.type == TYPE_INT || right->type.type == TYPE_FLOAT;
+    bool isSafe = false;
+    switch(operator) {
+        case TOKEN_PLUS:
+        case TOKEN_MINUS:
+        case TOKEN_MULTIPLY:
+        case TOKEN_DIVIDE:
+        case TOKEN_LESS:
+        case TOKEN_GREATER:
+        case TOKEN_LESS_OR_EQUALS:
+        case TOKEN_GREATER_OR_EQUALS:
+            isSafe = isLeftNumber && isRightNumber;
+            break;
+        case TOKEN_CONCATENATE:
+            isSafe = left->type.type == TYPE_STRING && right->type.type == TYPE_STRING;
+            break;
+        case TOKEN_EQUALS:
+        case TOKEN_NOT_EQUALS:
+            isSafe = true;
+            break;
+        default:
+            break;
+    }
+    if(!isSafe) return (SSAValue){.state = SSA_VALUE_BOTTOM};
+    Expression__BinaryOperator * operation = Expression__BinaryOperator__init();
+    operation->operator = operator;
+    operation->lSide = (Expression*)left;
+    operation->rSide = (Expression*)right;
+    Expression__Constant * result = performConstantFolding(operation);
+    free(operation);
+    if(result == NULL) return (SSAValue){.state = SSA_VALUE_BOTTOM};
+    return constantSSAValue(result);
+}
+
+/**
+ * @brief Evaluates expression in the constant propagation lattice
+ */
+SSAValue SSAForm__evaluate(SSAForm * this, Expression * expression) {
+    switch(expression->expressionType) {
+        case EXPRESSION_CONSTANT:
+            return constantSSAValue((Expression__Constant*)expression);
+        case EXPRESSION_VARIABLE: {
+            PointerTableItem * item = pointer_table_find(this->useTable, expression);
+            if(item == NULL) return (SSAValue){.state = SSA_VALUE_BOTTOM};
+            return SSAForm__resolve(((SSAUse*)item->data)->definition)->value;
+        }
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            if(op->operator == TOKEN_ASSIGN) return SSAForm__evaluate(this, op->rSide);
+            SSAValue left = SSAForm__evaluate(this, op->lSide);
+            if(op->operator == TOKEN_NULL_COALESCING) {
+                if(left.state != SSA_VALUE_CONSTANT) return left;
+                if(left.constant->type.type != TYPE_NULL) return left;
+                return SSAForm__evaluate(this, op->rSide);
+            }
+            if(op->operator == TOKEN_AND || op->operator == TOKEN_OR) {
+                if(left.state != SSA_VALUE_CONSTANT) return left;
+                bool leftValue = isSSAValueTrue(left);
+                if(op->operator == TOKEN_AND && !leftValue) return boolSSAValue(false);
+                if(op->operator == TOKEN_OR && leftValue) return boolSSAValue(true);
+                SSAValue right = SSAForm__evaluate(this, op->rSide);
+                if(right.state != SSA_VALUE_CONSTANT) return right;
+                return boolSSAValue(isSSAValueTrue(right));
+            }
+            SSAValue right = SSAForm__evaluate(this, op->rSide);
+            if(left.state == SSA_VALUE_BOTTOM || right.state == SSA_VALUE_BOTTOM) return (SSAValue){.state = SSA_VALUE_BOTTOM};
+            if(left.state == SSA_VALUE_TOP || right.state == SSA_VALUE_TOP) return (SSAValue){.state = SSA_VALUE_TOP};
+            return foldSSAConstants(op->operator, left.constant, right.constant);
+        }
+        case EXPRESSION_PREFIX_OPERATOR: {
+            Expression__PrefixOperator * op = (Expression__PrefixOperator*)expression;
+            if(op->operator != TOKEN_NEGATE) return (SSAValue){.state = SSA_VALUE_BOTTOM};
+            SSAValue value = SSAForm__evaluate(this, op->rSide);
+            if(value.state != SSA_VALUE_CONSTANT) return value;
+            return boolSSAValue(!isSSAValueTrue(value));
+        }
+        case EXPRESSION_FUNCTION_CALL: {
+            Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+            TableItem * item = table_find(this->functionTable, call->name);
+            if(item == NULL || !isPureBuiltinFunction(call->name)) return (SSAValue){.state = SSA_VALUE_BOTTOM};
+            Expression__FunctionCall * constantCall = Expression__FunctionCall__init();
+            constantCall->name = call->name;
+            SSAValueState state = SSA_VALUE_CONSTANT;
+            for(int i=0; i<call->arity; i++) {
+                SSAValue argument = SSAForm__evaluate(this, call->arguments[i]);
+                if(argument.state == SSA_VALUE_BOTTOM || (argument.state == SSA_VALUE_TOP && state == SSA_VALUE_CONSTANT)) state = argument.state;
+                if(state == SSA_VALUE_CONSTANT) Expression__FunctionCall__addArgument(constantCall, (Expression*)argument.constant);
+            }
+            Expression__Constant * result = state == SSA_VALUE_CONSTANT ? performBuiltinFolding(constantCall, (Function*)item->data) : NULL;
+            free(constantCall->arguments);
+            free(constantCall);
+            if(state != SSA_VALUE_CONSTANT) return (SSAValue){.state = state};
+            // calls which would fail at runtime arent folded
+            if(result == NULL) return (SSAValue){.state = SSA_VALUE_BOTTOM};
+            return constantSSAValue(result);
+        }
+        default:
+            return (SSAValue){.state = SSA_VALUE_BOTTOM};
+    }
+}
+
+/**
+ * @brief Checks whether the block can be executed, unknown guards are optimistically not executable
+ */
+bool SSAForm__isBlockExecutable(SSAForm * this, SSABlock * block) {
+    while(block != NULL) {
+        if(block->isUnreachable) return false;
+        if(block->guard != NULL) {
+            SSAValue value = SSAForm__evaluate(this, block->guard);
+            if(value.state == SSA_VALUE_TOP) return false;
+            if(value.state == SSA_VALUE_CONSTANT && isSSAValueTrue(value) != block->guardValue) return false;
+        }
+        block = block->parent;
+    }
+    return true;
+}
+
+SSAValue computeSSADefinitionValue(SSAForm * this, SSADefinition * definition) {
+    switch(definition->type) {
+        case SSA_DEFINITION_ASSIGNMENT:
+            if(!SSAForm__isBlockExecutable(this, definition->block)) return (SSAValue){.state = SSA_VALUE_TOP};
+            return SSAForm__evaluate(this, definition->assignment->rSide);
+        case SSA_DEFINITION_CLOBBER: {
+            if(!SSAForm__isBlockExecutable(this, definition->block)) return (SSAValue){.state = SSA_VALUE_TOP};
+            SSAValue value = SSAForm__resolve(definition->incremented)->value;
+            if(value.state != SSA_VALUE_CONSTANT) return value;
+            if(value.constant->type.type != TYPE_INT && value.constant->type.type != TYPE_FLOAT) return (SSAValue){.state = SSA_VALUE_BOTTOM};
+            Expression__Constant * one = Expression__Constant__init();
+            one->type = (Type){.type = TYPE_INT, .isRequired = true};
+            one->value.integer = 1;
+            return foldSSAConstants(definition->isDecrement ? TOKEN_MINUS : TOKEN_PLUS, value.constant, one);
+        }
+        case SSA_DEFINITION_PHI: {
+            SSAValue value = {.state = SSA_VALUE_TOP};
+            for(int i=0; i<definition->operandCount; i++) {
+                if(definition->operands[i] == definition) continue;
+                if(!SSAForm__isBlockExecutable(this, definition->operandBlocks[i])) continue;
+                value = meetSSAValues(value, definition->operands[i]->value);
+            }
+            return value;
+        }
+        default:
+            return (SSAValue){.state = SSA_VALUE_BOTTOM};
+    }
+}
+
+/**
+ * @brief Sparse conditional constant propagation, values only descend in the lattice so it terminates
+ */
+void SSAForm__propagateConstants(SSAForm * this) {
+    bool changed = true;
+    int iterations = 0;
+    while(changed) {
+        changed = false;
+        for(int i=0; i<this->definitionCount; i++) {
+            SSADefinition * definition = this->definitions[i];
+            SSAValue value = computeSSADefinitionValue(this, definition);
+            if(value.state != definition->value.state || (value.state == SSA_VALUE_CONSTANT && !Expression__Constant__equals(value.constant, definition->value.constant))) {
+                definition->value = value;
+                changed = true;
+            }
+        }
+        if(++iterations > 2 * this->definitionCount + 8) {
+            // should not happen, but better safe than sorry
+            this->isValid = false;
+            return;
+        }
+    }
+}
+
+void computeSSAUndefinedDefinitions(SSAForm * this) {
+    for(int i=0; i<this->definitionCount; i++) {
+        SSADefinition * definition = this->definitions[i];
+        definition->isPossiblyUndefined = definition->type == SSA_DEFINITION_ENTRY && !this->isParameter[definition->variable];
+    }
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(int i=0; i<this->definitionCount; i++) {
+            SSADefinition * definition = this->definitions[i];
+            if(definition->type != SSA_DEFINITION_PHI || definition->isPossiblyUndefined) continue;
+            for(int j=0; j<definition->operandCount; j++) {
+                if(definition->operands[j]->isPossiblyUndefined) {
+                    definition->isPossiblyUndefined = true;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool isSSAExpressionOfType(SSAForm * this, Expression * expression, bool acceptNumber, bool acceptString) {
+    UnionType type = expression->getType(expression, this->functionTable, this->program, this->currentFunction, this->resultTable);
+    if(type.isUndefined || type.isNull || type.isBool) return false;
+    if(!acceptNumber && (type.isInt || type.isFloat)) return false;
+    if(!acceptString && type.isString) return false;
+    return type.isInt || type.isFloat || type.isString;
+}
+
+/**
+ * @brief Checks if the expression has no side effects and can not end with runtime error
+ */
+bool isSSAExpressionRemovable(SSAForm * this, Expression * expression) {
+    switch(expression->expressionType) {
+        case EXPRESSION_CONSTANT:
+            return true;
+        case EXPRESSION_VARIABLE: {
+            PointerTableItem * item = pointer_table_find(this->useTable, expression);
+            if(item == NULL) return false;
+            return !SSAForm__resolve(((SSAUse*)item->data)->definition)->isPossiblyUndefined;
+        }
+        case EXPRESSION_BINARY_OPERATOR: {
+            Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+            switch(op->operator) {
+                case TOKEN_EQUALS:
+                case TOKEN_NOT_EQUALS:
+                    return isSSAExpressionRemovable(this, op->lSide) && isSSAExpressionRemovable(this, op->rSide);
+                case TOKEN_PLUS:
+                case TOKEN_MINUS:
+                case TOKEN_MULTIPLY:
+                    return isSSAExpressionRemovable(this, op->lSide) && isSSAExpressionRemovable(this, op->rSide) &&
+                        isSSAExpressionOfType(this, op->lSide, true, false) && isSSAExpressionOfType(this, op->rSide, true, false);
+                case TOKEN_CONCATENATE:
+                    return isSSAExpressionRemovable(this, op->lSide) && isSSAExpressionRemovable(this, op->rSide) &&
+                        isSSAExpressionOfType(this, op->lSide, false, true) && isSSAExpressionOfType(this, op->rSide, false, true);
+                default:
+                    return false;
+            }
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Marks definitions whose value can be observed, everything else is dead
+ */
+void markSSALiveDefinitions(SSAForm * this) {
+    for(int i=0; i<this->definitionCount; i++) {
+        SSADefinition * definition = this->definitions[i];
+        definition->isLive = false;
+        definition->isRemovable = definition->type == SSA_DEFINITION_ASSIGNMENT && definition->statementSlot != NULL && isSSAExpressionRemovable(this, definition->assignment->rSide);
+        if(definition->type == SSA_DEFINITION_CLOBBER && definition->nestedSlot != NULL) {
+            // increment of other types than number can fail
+            definition->isRemovable = isSSAExpressionOfType(this, ((Expression__PostfixOperator*)*definition->nestedSlot)->operand, true, false);
+        }
+    }
+    int stackSize = 0;
+    int stackCapacity = 16;
+    SSADefinition ** stack = malloc(sizeof(SSADefinition*) * stackCapacity);
+    for(int i=0; i<this->useCount + this->definitionCount; i++) {
+        SSADefinition * root = NULL;
+        if(i < this->useCount) {
+            SSAUse * use = this->uses[i];
+            // use in the right side of removable assignment is needed only if the assignment is needed
+            if(use->owner == NULL || !use->owner->isRemovable) root = use->definition;
+        }
+        while(root != NULL) {
+            if(!root->isLive) {
+                root->isLive = true;
+                if(stackSize + root->operandCount + root->ownedUseCount >= stackCapacity) {
+                    stackCapacity = (stackSize + root->operandCount + root->ownedUseCount) * 2;
+                    stack = realloc(stack, sizeof(SSADefinition*) * stackCapacity);
+                }
+                for(int j=0; j<root->operandCount; j++) {
+                    stack[stackSize++] = root->operands[j];
+                }
+                for(int j=0; j<root->ownedUseCount; j++) {
+                    stack[stackSize++] = root->ownedUses[j]->definition;
+                }
+            }
+            root = stackSize > 0 ? stack[--stackSize] : NULL;
+        }
+    }
+    free(stack);
+}
+
+/**
+ * @brief Checks if some variable can be read before it is assigned
+ *
+ * @return true if undefined variable can be read or the body cant be converted to SSA form
+ */
+bool mayReadUndefinedVariable(Statement ** body, Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable) {
+    if(body == NULL || *body == NULL) return false;
+    SSAForm * form = SSAForm__build(body, functionTable, program, currentFunction, resultTable);
+    bool result = !form->isValid;
+    if(form->isValid) {
+        computeSSAUndefinedDefinitions(form);
+        for(int i=0; i<form->useCount; i++) {
+            if(SSAForm__resolve(form->uses[i]->definition)->isPossiblyUndefined) {
+                result = true;
+                break;
+            }
+        }
+    }
+    SSAForm__free(form);
+    return result;
+}
+
+void SSAForm__free(SSAForm * this) {
+    for(int i=0; i<this->definitionCount; i++) {
+        free(this->definitions[i]->operands);
+        free(this->definitions[i]->operandBlocks);
+        free(this->definitions[i]->ownedUses);
+        free(this->definitions[i]);
+    }
+    for(int i=0; i<this->useCount; i++) {
+        free(this->uses[i]);
+    }
+    for(int i=0; i<this->blockCount; i++) {
+        free(this->blocks[i]);
+    }
+    TableItem * indices = table_find(this->variableIndices, "");
+    if(indices != NULL) free(indices->data);
+    table_free(this->variableIndices);
+    pointer_table_free(this->useTable);
+    free(this->definitions);
+    free(this->uses);
+    free(this->blocks);
+    free(this->variableNames);
+    free(this->isParameter);
+    free(this);
+}
+
+/**
+ * @brief Replaces conditions with constant value by the constant, so the pruned branch or loop can be removed
+ * @note condition can be replaced only if it has no side effect and cant fail, its value is computed even if parts of it
+ *  arent known thanks to short circuit evaluation and builtin folding
+ */
+bool foldSSAConditions(SSAForm * this, Statement * statement) {
+    if(statement == NULL || statement->statementType == STATEMENT_EXPRESSION || statement->statementType == STATEMENT_FUNCTION) return false;
+    bool changed = false;
+    Expression ** condition = NULL;
+    if(statement->statementType == STATEMENT_IF) condition = &((StatementIf*)statement)->condition;
+    if(statement->statementType == STATEMENT_WHILE) condition = &((StatementWhile*)statement)->condition;
+    if(statement->statementType == STATEMENT_FOR) condition = &((StatementFor*)statement)->condition;
+    if(condition != NULL && *condition != NULL && (*condition)->expressionType != EXPRESSION_CONSTANT) {
+        SSAValue value = SSAForm__evaluate(this, *condition);
+        if(value.state == SSA_VALUE_CONSTANT && isInvariantExpression(NULL, *condition) &&
+            !canExpressionFail(*condition, this->currentFunction, this->functionTable, this->program, this->resultTable)) {
+            *condition = (Expression*)value.constant->super.super.duplicate((Statement*)value.constant);
+            changed = true;
+        }
+    }
+    int childrenCount = 0;
+    Statement *** children = statement->getChildren(statement, &childrenCount);
+    for(int i=0; i<childrenCount; i++) {
+        if(children[i] != NULL) changed |= foldSSAConditions(this, *children[i]);
+    }
+    free(children);
+    return changed;
+}
+
+/**
+ * @brief Converts the body to SSA form and performs constant propagation, copy propagation and dead code elimination
+ * @note SSA versions are never written to the tree, so leaving SSA form only requires freeing it
+ *
+ * @return true if the tree was changed
+ */
+bool performSSAOptimizations(Statement ** body, Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable) {
+    if(body == NULL || *body == NULL) return false;
+    SSAForm * form = SSAForm__build(body, functionTable, program, currentFunction, resultTable);
+    if(form->isValid) SSAForm__propagateConstants(form);
+    if(!form->isValid) {
+        SSAForm__free(form);
+        return false;
+    }
+    computeSSAUndefinedDefinitions(form);
+    markSSALiveDefinitions(form);
+    // conditions are evaluated before any use is replaced, the lattice refers to the original expressions
+    bool changed = foldSSAConditions(form, *body);
+    for(int i=0; i<form->useCount; i++) {
+        SSAUse * use = form->uses[i];
+        if(!use->isReplaceable || !SSAForm__isBlockExecutable(form, use->block)) continue;
+        SSADefinition * definition = SSAForm__resolve(use->definition);
+        if(definition->value.state == SSA_VALUE_CONSTANT) {
+            *use->slot = (Expression*)definition->value.constant->super.super.duplicate((Statement*)definition->value.constant);
+            changed = true;
+        } else if(definition->type == SSA_DEFINITION_ASSIGNMENT && use->copySource != NULL && definition->assignment->rSide->expressionType == EXPRESSION_VARIABLE) {
+            PointerTableItem * sourceItem = pointer_table_find(form->useTable, definition->assignment->rSide);
+            if(sourceItem == NULL) continue;
+            SSAUse * source = (SSAUse*)sourceItem->data;
+            // copied variable must still have the same value at the place of use
+            if(SSAForm__resolve(source->definition) != SSAForm__resolve(use->copySource)) continue;
+            *use->slot = (Expression*)definition->assignment->rSide->super.duplicate((Statement*)definition->assignment->rSide);
+            changed = true;
+        }
+    }
+    for(int i=0; i<form->definitionCount; i++) {
+        SSADefinition * definition = form->definitions[i];
+        if(definition->isLive) continue;
+        if(definition->nestedSlot != NULL) {
+            // dead store inside expression is replaced by the value of the expression
+            if(definition->type == SSA_DEFINITION_ASSIGNMENT) {
+                *definition->nestedSlot = definition->assignment->rSide;
+                changed = true;
+            } else if(definition->type == SSA_DEFINITION_CLOBBER && definition->isRemovable) {
+                *definition->nestedSlot = ((Expression__PostfixOperator*)*definition->nestedSlot)->operand;
+                changed = true;
+            }
+            continue;
+        }
+        if(definition->type != SSA_DEFINITION_ASSIGNMENT || definition->statementSlot == NULL) continue;
+        if(definition->isExpressionSlot) {
+            *definition->statementSlot = definition->isRemovable ? NULL : (Statement*)definition->assignment->rSide;
+        } else {
+            *definition->statementSlot = definition->isRemovable ? (Statement*)StatementList__init() : (Statement*)definition->assignment->rSide;
+        }
+        changed = true;
+    }
+    SSAForm__free(form);
+    return changed;
+}
@@ -0,0 +1,113 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file ssa.h
+ * @brief Header file for the SSA form used by the optimizer
+ */
+
+#ifndef __SSA_H__
+#define __SSA_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+#include "pointer_hashtable.h"
+
+/**
+ * @brief Kind of SSA definition
+ */
+typedef enum {
+    SSA_DEFINITION_ENTRY, /*<Value on entry (parameter or undefined variable)>*/
+    SSA_DEFINITION_ASSIGNMENT, /*<Assignment $x = expression>*/
+    SSA_DEFINITION_CLOBBER, /*<Increment or decrement ($x++, ++$x, $x--, --$x)>*/
+    SSA_DEFINITION_PHI /*<Join of definitions from multiple paths>*/
+} SSADefinitionType;
+
+/**
+ * @brief State of value in the constant propagation lattice
+ */
+typedef enum {
+    SSA_VALUE_TOP, /*<Not reached yet>*/
+    SSA_VALUE_CONSTANT, /*<Always the same constant>*/
+    SSA_VALUE_BOTTOM /*<Unknown at compile time>*/
+} SSAValueState;
+
+typedef struct {
+    SSAValueState state;
+    Expression__Constant * constant;
+} SSAValue;
+
+/**
+ * @brief Region of code executed only when its guard has the given value
+ */
+typedef struct SSABlock {
+    struct SSABlock * parent; /*<Enclosing block>*/
+    Expression * guard; /*<Condition guarding the block or NULL>*/
+    bool guardValue; /*<Value of the guard required to enter the block>*/
+    bool isUnreachable; /*<Block follows return, exit, break or continue>*/
+} SSABlock;
+
+typedef struct SSADefinition {
+    SSADefinitionType type;
+    int variable; /*<Index of the variable in SSAForm>*/
+    Expression__BinaryOperator * assignment; /*<Assignment for SSA_DEFINITION_ASSIGNMENT>*/
+    Statement ** statementSlot; /*<Slot of the assignment if the assignment is whole statement>*/
+    bool isExpressionSlot; /*<The slot is for or while header which has to contain expression>*/
+    Expression ** nestedSlot; /*<Slot of the assignment or postfix operator nested in other expression>*/
+    SSABlock * block; /*<Block containing the definition>*/
+    int operandCount; /*<Operands of phi>*/
+    struct SSADefinition ** operands;
+    SSABlock ** operandBlocks; /*<Blocks from which the operands come>*/
+    struct SSADefinition * replacement; /*<Phi simplified to other definition>*/
+    struct SSADefinition * incremented; /*<Definition changed by SSA_DEFINITION_CLOBBER>*/
+    bool isDecrement; /*<SSA_DEFINITION_CLOBBER subtracts one>*/
+    int ownedUseCount; /*<Uses inside right side of the assignment statement>*/
+    struct SSAUse ** ownedUses;
+    SSAValue value;
+    bool isPossiblyUndefined;
+    bool isRemovable; /*<Right side of the assignment or the increment can be dropped without changing behaviour>*/
+    bool isLive;
+} SSADefinition;
+
+typedef struct SSAUse {
+    Expression ** slot; /*<Slot containing the variable>*/
+    SSADefinition * definition; /*<Definition reaching this use>*/
+    SSADefinition * copySource; /*<Current definition of the copied variable, if definition is a copy>*/
+    SSADefinition * owner; /*<Assignment statement whose right side contains this use>*/
+    SSABlock * block;
+    bool isReplaceable;
+} SSAUse;
+
+/**
+ * @brief SSA form of function body or main program
+ * @note the AST isnt renamed, versions are kept only in this structure, so leaving SSA form is just freeing it
+ */
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    Function * currentFunction;
+    PointerTable * resultTable;
+    int variableCount;
+    char ** variableNames;
+    bool * isParameter;
+    Table * variableIndices;
+    int definitionCount;
+    SSADefinition ** definitions;
+    int useCount;
+    SSAUse ** uses;
+    PointerTable * useTable; /*<Expression__Variable -> SSAUse>*/
+    int blockCount;
+    SSABlock ** blocks;
+    bool isValid; /*<Code contains construct which cant be converted, nothing can be optimized>*/
+} SSAForm;
+
+SSAForm * SSAForm__build(Statement ** body, Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable);
+void SSAForm__propagateConstants(SSAForm * this);
+bool SSAForm__isBlockExecutable(SSAForm * this, SSABlock * block);
+SSADefinition * SSAForm__resolve(SSADefinition * definition);
+SSAValue SSAForm__evaluate(SSAForm * this, Expression * expression);
+void SSAForm__free(SSAForm * this);
+
+bool mayReadUndefinedVariable(Statement ** body, Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable);
+bool performSSAOptimizations(Statement ** body, Table * functionTable, StatementList * program, Function * currentFunction, PointerTable * resultTable);
+
+#endif // __SSA_H__
@@ -0,0 +1,329 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file tail_recursion.c
+ * @brief Conversion of self tail calls and accumulated self recursion to loops
+ */
+
+#include "tail_recursion.h"
+#include "inliner.h"
+#include "ssa.h"
+#include "optimizer.h"
+#include "loop_invariant_motion.h"
+#include "string_builder.h"
+
+#define TAIL_ACCUMULATOR_NAME "$&tail&accumulator" /*<Partial result of accumulated recursion*/
+
+typedef struct {
+    Table * functionTable;
+    StatementList * program;
+    PointerTable * resultTable;
+    Function * function;
+    bool isValid; /*<Body can be wrapped into loop*/
+    int tailCallCount; /*<Calls which are directly returned*/
+    int accumulatedCallCount; /*<Calls combined with other operand before returning, return f(...) * $n*/
+    TokenType accumulatorOperator;
+    bool isAccumulatorValid; /*<All accumulated calls use the same operator and other returns are int*/
+} TailRecursion;
+
+bool isOnlyIntExpression(TailRecursion * recursion, Expression * expression) {
+    UnionType type = expression->getType(expression, recursion->functionTable, recursion->program, recursion->function, recursion->resultTable);
+    return type.isInt && !type.isFloat && !type.isString && !type.isBool && !type.isNull && !type.isUndefined;
+}
+
+/**
+ * @brief Checks if the expression is call of the processed function which can be replaced by jump
+ * @note type checks of the arguments would be lost, so only statically compatible arguments are accepted
+ */
+bool isSelfCall(TailRecursion * recursion, Expression * expression) {
+    if(expression == NULL || expression->expressionType != EXPRESSION_FUNCTION_CALL) return false;
+    Expression__FunctionCall * call = (Expression__FunctionCall*)expression;
+    Function * function = recursion->function;
+    if(strcmp(call->name, function->name) != 0 || call->arity != function->arity) return false;
+    for(int i=0; i<call->arity; i++) {
+        UnionType argumentType = call->arguments[i]->getType(call->arguments[i], recursion->functionTable, recursion->program, function, recursion->resultTable);
+        if(!isTypeStaticallyCompatible(function->parameterTypes[i], argumentType)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Finds self call combined with other operand by int addition or multiplication
+ *
+ * @param accumulated other operand, it has to be pure so it can be evaluated before the call
+ * @param isCallFirst call is left operand, so its arguments are evaluated before the other operand
+ * @return Expression__FunctionCall* the call or NULL
+ */
+Expression__FunctionCall * getAccumulatedCall(TailRecursion * recursion, Expression * expression, Expression ** accumulated, bool * isCallFirst) {
+    if(expression == NULL || expression->expressionType != EXPRESSION_BINARY_OPERATOR) return NULL;
+    Expression__BinaryOperator * op = (Expression__BinaryOperator*)expression;
+    if(op->operator != TOKEN_PLUS && op->operator != TOKEN_MULTIPLY) return NULL;
+    *isCallFirst = isSelfCall(recursion, op->lSide);
+    if(!*isCallFirst && !isSelfCall(recursion, op->rSide)) return NULL;
+    *accumulated = *isCallFirst ? op->rSide : op->lSide;
+    if(!isInvariantExpression(NULL, *accumulated) || !isOnlyIntExpression(recursion, *accumulated)) return NULL;
+    if(canExpressionFail(*accumulated, recursion->function, recursion->functionTable, recursion->program, recursion->resultTable)) return NULL;
+    return (Expression__FunctionCall*)(*isCallFirst ? op->lSide : op->rSide);
+}
+
+/**
+ * @brief Checks if the statement of list is in tail position, void function can end by the statement followed by empty return
+ */
+bool isTailStatement(StatementList * list, int index, bool isListTail) {
+    if(index == list->listSize - 1) return isListTail;
+    Statement * next = list->statements[index + 1];
+    return next->statementType == STATEMENT_RETURN && ((StatementReturn*)next)->expression == NULL;
+}
+
+/**
+ * @brief Finds calls which can be converted and checks that the body can be wrapped into loop
+ *
+ * @param loopDepth number of loops of the body containing the statement
+ * @param isTail end of the statement is end of the function
+ */
+void analyzeTailCalls(TailRecursion * recursion, Statement * statement, int loopDepth, bool isTail) {
+    if(statement == NULL) return;
+    switch(statement->statementType) {
+        case STATEMENT_RETURN: {
+            Expression * expression = ((StatementReturn*)statement)->expression;
+            if(expression == NULL) break;
+            Expression * accumulated = NULL;
+            bool isCallFirst = false;
+            if(isSelfCall(recursion, expression)) {
+                recursion->tailCallCount++;
+            } else if(getAccumulatedCall(recursion, expression, &accumulated, &isCallFirst) != NULL) {
+                TokenType operator = ((Expression__BinaryOperator*)expression)->operator;
+                if(recursion->accumulatedCallCount > 0 && recursion->accumulatorOperator != operator) recursion->isAccumulatorValid = false;
+                recursion->accumulatorOperator = operator;
+                recursion->accumulatedCallCount++;
+            } else if(!isOnlyIntExpression(recursion, expression)) {
+                // result of other returns is combined with the accumulator
+                recursion->isAccumulatorValid = false;
+            }
+            break;
+        }
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)statement;
+            for(int i=0; i<list->listSize; i++) {
+                analyzeTailCalls(recursion, list->statements[i], loopDepth, isTailStatement(list, i, isTail));
+            }
+            break;
+        }
+        case STATEMENT_IF:
+            analyzeTailCalls(recursion, ((StatementIf*)statement)->ifBody, loopDepth, isTail);
+            analyzeTailCalls(recursion, ((StatementIf*)statement)->elseBody, loopDepth, isTail);
+            break;
+        case STATEMENT_WHILE:
+            analyzeTailCalls(recursion, ((StatementWhile*)statement)->body, loopDepth + 1, false);
+            break;
+        case STATEMENT_FOR:
+            analyzeTailCalls(recursion, ((StatementFor*)statement)->body, loopDepth + 1, false);
+            break;
+        case STATEMENT_BREAK:
+            // break leaving the body would leave the new loop
+            if(((StatementBreak*)statement)->depth > loopDepth) recursion->isValid = false;
+            break;
+        case STATEMENT_CONTINUE:
+            if(((StatementContinue*)statement)->depth > loopDepth) recursion->isValid = false;
+            break;
+        case STATEMENT_EXPRESSION:
+            if(isTail && recursion->function->returnType.type == TYPE_VOID && isSelfCall(recursion, (Expression*)statement)) recursion->tailCallCount++;
+            break;
+        case STATEMENT_FUNCTION:
+            recursion->isValid = false;
+            break;
+        default:
+            break;
+    }
+}
+
+Expression__Variable * createTailVariable(char * name) {
+    Expression__Variable * variable = Expression__Variable__init();
+    variable->name = name;
+    return variable;
+}
+
+Expression__BinaryOperator * createTailOperation(Expression * lSide, TokenType operator, Expression * rSide) {
+    Expression__BinaryOperator * op = Expression__BinaryOperator__init();
+    op->operator = operator;
+    op->lSide = lSide;
+    op->rSide = rSide;
+    return op;
+}
+
+char * getTailArgumentName(int index) {
+    StringBuilder sb;
+    StringBuilder__init(&sb);
+    StringBuilder__appendString(&sb, "$&tail&");
+    StringBuilder__appendInt(&sb, index);
+    return sb.text;
+}
+
+void addAccumulatorUpdate(TailRecursion * recursion, StatementList * jump, Expression * accumulated) {
+    Expression * sum = (Expression*)createTailOperation((Expression*)createTailVariable(TAIL_ACCUMULATOR_NAME), recursion->accumulatorOperator, accumulated);
+    StatementList__addStatement(jump, (Statement*)createTailOperation((Expression*)createTailVariable(TAIL_ACCUMULATOR_NAME), TOKEN_ASSIGN, sum));
+}
+
+/**
+ * @brief Creates replacement of the call, arguments are evaluated first and then assigned to the parameters
+ *
+ * @param accumulated operand combined with result of the call or NULL
+ * @param loopDepth number of loops of the body containing the call
+ */
+Statement * createTailJump(TailRecursion * recursion, Expression__FunctionCall * call, Expression * accumulated, bool isCallFirst, int loopDepth) {
+    Function * function = recursion->function;
+    StatementList * jump = StatementList__init();
+    if(accumulated != NULL && !isCallFirst) addAccumulatorUpdate(recursion, jump, accumulated);
+    Expression ** values = malloc(sizeof(Expression*) * (call->arity + 1));
+    for(int i=0; i<call->arity; i++) {
+        Expression * argument = call->arguments[i];
+        values[i] = argument;
+        if(argument->expressionType == EXPRESSION_CONSTANT) continue;
+        if(argument->expressionType == EXPRESSION_VARIABLE && strcmp(((Expression__Variable*)argument)->name, function->parameterNames[i]) == 0) {
+            values[i] = NULL;
+            continue;
+        }
+        // parameters can be read by following arguments, so the value is kept in temporary variable
+        char * name = getTailArgumentName(i);
+        StatementList__addStatement(jump, (Statement*)createTailOperation((Expression*)createTailVariable(name), TOKEN_ASSIGN, argument));
+        values[i] = (Expression*)createTailVariable(name);
+    }
+    if(accumulated != NULL && isCallFirst) addAccumulatorUpdate(recursion, jump, accumulated);
+    for(int i=0; i<call->arity; i++) {
+        if(values[i] == NULL) continue;
+        StatementList__addStatement(jump, (Statement*)createTailOperation((Expression*)createTailVariable(function->parameterNames[i]), TOKEN_ASSIGN, values[i]));
+    }
+    free(values);
+    StatementContinue * continueStatement = StatementContinue__init();
+    continueStatement->depth = loopDepth + 1;
+    StatementList__addStatement(jump, (Statement*)continueStatement);
+    return (Statement*)jump;
+}
+
+/**
+ * @brief Replaces calls found by analyzeTailCalls, returns of other values are combined with the accumulator
+ */
+void rewriteTailCalls(TailRecursion * recursion, Statement ** slot, int loopDepth, bool isTail, bool useAccumulator) {
+    Statement * statement = *slot;
+    if(statement == NULL) return;
+    switch(statement->statementType) {
+        case STATEMENT_RETURN: {
+            StatementReturn * returnStatement = (StatementReturn*)statement;
+            Expression * expression = returnStatement->expression;
+            if(expression == NULL) break;
+            Expression * accumulated = NULL;
+            bool isCallFirst = false;
+            Expression__FunctionCall * call = NULL;
+            if(isSelfCall(recursion, expression)) {
+                *slot = createTailJump(recursion, (Expression__FunctionCall*)expression, NULL, false, loopDepth);
+            } else if(useAccumulator && (call = getAccumulatedCall(recursion, expression, &accumulated, &isCallFirst)) != NULL) {
+                *slot = createTailJump(recursion, call, accumulated, isCallFirst, loopDepth);
+            } else if(useAccumulator) {
+                returnStatement->expression = (Expression*)createTailOperation((Expression*)createTailVariable(TAIL_ACCUMULATOR_NAME), recursion->accumulatorOperator, expression);
+            }
+            break;
+        }
+        case STATEMENT_LIST: {
+            StatementList * list = (StatementList*)statement;
+            for(int i=0; i<list->listSize; i++) {
+                rewriteTailCalls(recursion, &list->statements[i], loopDepth, isTailStatement(list, i, isTail), useAccumulator);
+            }
+            break;
+        }
+        case STATEMENT_IF:
+            rewriteTailCalls(recursion, &((StatementIf*)statement)->ifBody, loopDepth, isTail, useAccumulator);
+            rewriteTailCalls(recursion, &((StatementIf*)statement)->elseBody, loopDepth, isTail, useAccumulator);
+            break;
+        case STATEMENT_WHILE:
+            rewriteTailCalls(recursion, &((StatementWhile*)statement)->body, loopDepth + 1, false, useAccumulator);
+            break;
+        case STATEMENT_FOR:
+            rewriteTailCalls(recursion, &((StatementFor*)statement)->body, loopDepth + 1, false, useAccumulator);
+            break;
+        case STATEMENT_EXPRESSION:
+            if(isTail && recursion->function->returnType.type == TYPE_VOID && isSelfCall(recursion, (Expression*)statement)) {
+                *slot = createTailJump(recursion, (Expression__FunctionCall*)statement, NULL, false, loopDepth);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Wraps body of the function into infinite loop and replaces self calls by jumps to its start
+ * @note function frame is reused, so locals have to be always assigned before use
+ *
+ * @return true if the function was changed
+ */
+bool convertTailRecursion(TailRecursion * recursion) {
+    Function * function = recursion->function;
+    recursion->isValid = true;
+    recursion->isAccumulatorValid = true;
+    recursion->tailCallCount = 0;
+    recursion->accumulatedCallCount = 0;
+    analyzeTailCalls(recursion, function->body, 0, true);
+    // accumulated value is int, so the result can be combined in any order
+    bool useAccumulator = recursion->accumulatedCallCount > 0 && recursion->isAccumulatorValid &&
+        function->returnType.type == TYPE_INT && function->returnType.isRequired;
+    if(!recursion->isValid || (recursion->tailCallCount == 0 && !useAccumulator)) return false;
+    if(mayReadUndefinedVariable(&function->body, recursion->functionTable, recursion->program, function, recursion->resultTable)) return false;
+    rewriteTailCalls(recursion, &function->body, 0, true, useAccumulator);
+    StatementList * loopBody = StatementList__init();
+    StatementList__addStatement(loopBody, function->body);
+    if(function->returnType.type == TYPE_VOID) {
+        StatementList__addStatement(loopBody, (Statement*)StatementReturn__init());
+    } else {
+        // falling through end of non void function is runtime error
+        StatementExit * exit = StatementExit__init();
+        exit->exitCode = 4;
+        StatementList__addStatement(loopBody, (Statement*)exit);
+    }
+    Expression__Constant * condition = Expression__Constant__init();
+    condition->type = (Type){.type = TYPE_BOOL, .isRequired = true};
+    condition->value.boolean = true;
+    StatementWhile * loop = StatementWhile__init();
+    loop->condition = (Expression*)condition;
+    loop->body = (Statement*)loopBody;
+    // peeling wouldnt terminate, condition of the loop is known in every iteration
+    loop->isUnrolled = true;
+    StatementList * body = StatementList__init();
+    if(useAccumulator) {
+        Expression__Constant * identity = Expression__Constant__init();
+        identity->type = (Type){.type = TYPE_INT, .isRequired = true};
+        identity->value.integer = recursion->accumulatorOperator == TOKEN_MULTIPLY ? 1 : 0;
+        StatementList__addStatement(body, (Statement*)createTailOperation((Expression*)createTailVariable(TAIL_ACCUMULATOR_NAME), TOKEN_ASSIGN, (Expression*)identity));
+    }
+    StatementList__addStatement(body, (Statement*)loop);
+    function->body = (Statement*)body;
+    invalidateResultsType(recursion->resultTable, (Statement*)function);
+    return true;
+}
+
+/**
+ * @brief Converts self tail calls and accumulated self recursion of user functions to loops, so deep recursion doesnt need new frames
+ * @note runs before inlining, so converted functions can be inlined into their callers
+ *
+ * @param program
+ * @param functionTable
+ * @return true if any function was converted
+ */
+bool eliminateTailRecursion(StatementList * program, Table * functionTable) {
+    TailRecursion recursion = {0};
+    recursion.functionTable = functionTable;
+    recursion.program = program;
+    recursion.resultTable = pointer_table_init();
+    bool changed = false;
+    for(int i = 0; i < TB_SIZE; i++) {
+        TableItem * item = functionTable->tb[i];
+        while(item != NULL) {
+            Function * function = (Function*)item->data;
+            if(function->body != NULL) {
+                recursion.function = function;
+                changed |= convertTailRecursion(&recursion);
+            }
+            item = item->next;
+        }
+    }
+    pointer_table_free(recursion.resultTable);
+    return changed;
+}
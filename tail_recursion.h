@@ -0,0 +1,16 @@
+/**
+ * Implementace překladače imperativního jazyka IFJ22
+ * @file tail_recursion.h
+ * @brief Header file for conversion of self recursion to loops
+ */
+
+#ifndef __TAIL_RECURSION_H__
+#define __TAIL_RECURSION_H__
+
+#include <stdbool.h>
+#include "ast.h"
+#include "symtable.h"
+
+bool eliminateTailRecursion(StatementList * program, Table * functionTable);
+
+#endif // __TAIL_RECURSION_H__
@@ -0,0 +1,63 @@
+<?php
+declare(strict_types=1);
+// constants are moved to the right side, relational operators are mirrored
+
+function a(): int {
+    write("a");
+    return 2;
+}
+
+function b(): int {
+    write("b");
+    return 3;
+}
+
+$x = readi();
+if ($x === null) {
+    $x = 0;
+}
+$y = readi();
+if ($y === null) {
+    $y = 0;
+}
+write(1 + $x, " ", 2 * $x, " ", 3 - $x, " ", ($y + $x) - ($x + $y), "\n");
+if (3 < $x) {
+    write("3 < x\n");
+}
+if (4 <= $x) {
+    write("4 <= x\n");
+}
+if (5 > $x) {
+    write("5 > x\n");
+}
+if (4 >= $x) {
+    write("4 >= x\n");
+}
+if (4 === $x) {
+    write("4 === x\n");
+}
+if (5 !== $x) {
+    write("5 !== x\n");
+}
+if ($y * $x === $x * $y) {
+    write("commutes\n");
+}
+
+// operands with side effects keep their evaluation order
+write(" ", a() + b(), "\n");
+write(" ", b() * a(), "\n");
+$c = b() < a();
+write(" ", $c, "\n");
+
+// ?int operand would fail the arithmetic, so it is not swapped with another failing one
+$n = readi();
+if ($n === null) {
+    write("null\n");
+} else {
+    write(1 + $n, " ", $n + $x, "\n");
+}
+$s = reads();
+if ($s === null) {
+    $s = "";
+}
+write("<" . $s, "|", "<" . $s . ">", "\n");
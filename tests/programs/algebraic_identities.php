@@ -0,0 +1,46 @@
+<?php
+declare(strict_types=1);
+// identities are removed only when the operand already has the type of the result
+
+$x = readi();
+if ($x === null) {
+    $x = 0;
+}
+write($x + 0, " ", $x - 0, " ", $x * 1, " ", $x * 0, " ", 0 + $x, " ", 1 * $x, "\n");
+
+// null + 0 is int 0, so the addition has to stay for ?int
+$n = readi();
+write($n + 0, " ", $n * 1, "\n");
+if ($n * 1 === 0) {
+    write("null is 0\n");
+}
+
+// -0.0 + 0 is 0.0, so the addition is kept for floats
+$f = readf();
+if ($f === null) {
+    $f = 0.0;
+}
+write($f + 0, " ", $f - 0, " ", $f * 1, " ", $f / 1, " ", $f * 1.0, "\n");
+
+// int divided by 1 is float
+$d = $x / 1;
+write($d, "\n");
+
+$s = reads();
+if ($s === null) {
+    $s = "";
+}
+write($s . "", "|", "" . $s, "\n");
+// concatenation with empty string converts int to string
+if (($x . "") === "7") {
+    write("string\n");
+}
+
+$b = $x > 5;
+if (($b && true) === true && (true && $b) === true && ($b || false) === true && (false || $b) === true) {
+    write("bool\n");
+}
+// && and || convert their operands to bool
+if (($x && true) === true && ($x || false) === true) {
+    write("converted\n");
+}
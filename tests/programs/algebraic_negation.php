@@ -0,0 +1,52 @@
+<?php
+declare(strict_types=1);
+// double negation and negated strict (in)equality
+
+$x = readi();
+$b = $x === 3;
+if (!!$b) {
+    write("b\n");
+}
+$nb = !!$b;
+write($nb, "|", !!$nb, "\n");
+if (!($x === 3)) {
+    write("not 3\n");
+} else {
+    write("is 3\n");
+}
+if (!($x !== 3)) {
+    write("is 3\n");
+} else {
+    write("not 3\n");
+}
+if (!($x === null)) {
+    write("not null\n");
+} else {
+    write("null\n");
+}
+if (!!($x !== null)) {
+    write("set\n");
+}
+
+// !! on non-bool value converts it to bool
+$i = readi();
+if ($i === null) {
+    $i = 0;
+}
+if (!!$i) {
+    write("truthy\n");
+} else {
+    write("falsy\n");
+}
+// "0" is falsy as well
+$s = reads();
+if (!!$s) {
+    write("truthy\n");
+} else {
+    write("falsy\n");
+}
+// int 3 and float 3.0 are not strictly equal
+$f = readf();
+if (!($f === 3)) {
+    write("float\n");
+}
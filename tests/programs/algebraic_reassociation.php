@@ -0,0 +1,49 @@
+<?php
+declare(strict_types=1);
+// constants of int addition, multiplication and string concatenation are gathered
+
+$x = readi();
+if ($x === null) {
+    $x = 0;
+}
+$y = readi();
+if ($y === null) {
+    $y = 0;
+}
+write($x + 1 + 2, " ", $x - 1 + 5, " ", $x - 3 - 4, " ", ($x + 3) + $y, " ", $x + ($y - 4), " ", $x - ($y - 4), "\n");
+write($x * 2 * 3, " ", ($x * 2) * $y, " ", $x * ($y * 5), "\n");
+
+// sum or product of the constants overflows, so the constants arent gathered
+$big = $x - 15;
+write($big + 9223372036854775807 + 1, "\n");
+write($big - 9223372036854775807 - 2, "\n");
+$zero = $x - 10;
+write($zero * 4294967296 * 4294967296, "\n");
+
+// float addition isnt associative
+$f = readf();
+if ($f === null) {
+    $f = 0.0;
+}
+write($f + 0.2 + 0.3, "\n");
+write($f * 0.1 * 3, "\n");
+
+// int|float value is float here, so it is not reassociated either
+$m = 1;
+if ($x > 5) {
+    $m = 1e16;
+}
+write($m + 1 + 1, "\n");
+write($m + 1.0 + 1.0, "\n");
+
+$s = reads();
+if ($s === null) {
+    $s = "";
+}
+$t = reads();
+if ($t === null) {
+    $t = "";
+}
+write($s . "a" . "b", "|", "a" . ("b" . $s), "|", $s . ($t . "c"), "\n");
+// operands of concatenation are converted to string in any order
+write($x . "a" . "b", "|", "a" . ("b" . $x), "\n");
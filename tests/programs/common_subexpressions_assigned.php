@@ -0,0 +1,37 @@
+<?php
+declare(strict_types=1);
+// value computed after assignment of its variable in the same statement cant be saved before the statement
+
+$n = readi();
+if ($n === null) {
+    $n = 0;
+}
+$q = $n * 2;
+write($q, "\n");
+$m = ($n = $n + 1) * 2 + $n * 2;
+write($m, " ", $n * 2, "\n");
+
+$k = $n + 5;
+$r = $k * 3 + ($k++) + $k * 3;
+write($r, " ", $k * 3, "\n");
+$r = $k * 3 + (++$k) + $k * 3;
+write($r, " ", $k * 3, "\n");
+$r = $k * 3 - (--$k) - $k * 3;
+write($r, " ", $k * 3, "\n");
+
+$s = reads();
+if ($s === null) {
+    $s = "";
+}
+$t = $s . "!";
+$u = ($s = $s . "?") . ($s . "!");
+write($t, " ", $u, " ", $s . "!", "\n");
+
+$b = $n > 0;
+$v = $n + 10;
+$w = ($b && ($n = $n + 1) > 0) . "," . ($n + 10);
+write($v, " ", $w, " ", $n + 10, "\n");
+
+// reuse without assignment between stays
+$a = $n * $n + 1;
+write($a, " ", $n * $n + 1, "\n");
@@ -0,0 +1,21 @@
+<?php
+declare(strict_types=1);
+// variable arguments of inlined call are read after the other arguments are evaluated
+
+function two(int $p, int $q): int {
+    return $p * 10 + $q;
+}
+function three(int $p, int $q, int $r): int {
+    return $p * 100 + $q * 10 + $r;
+}
+
+$z = readi();
+if ($z === null) {
+    $z = 0;
+}
+write(two($z, $z = 7), "\n");
+$y = readi();
+if ($y === null) {
+    $y = 0;
+}
+write(three($y, $y = $y + 1, $z), " ", $y, "\n");
@@ -0,0 +1,40 @@
+<?php
+declare(strict_types=1);
+// variable operand is read by the operator after the assignment nested in the other operand
+
+function sq(int $v): int {
+    return $v * $v;
+}
+function g(int $a): int {
+    $b = $a + ($a = 5);
+    return $b;
+}
+function h(int $x): int {
+    return $x + sq($x = 2);
+}
+
+$a = readi();
+$b = $a + ($a = 5);
+write($b, "\n");
+$x = readi();
+$y = $x + sq($x = 2);
+write($y, "\n");
+$n = readi();
+$m = readi();
+write(g($n), " ", h($m), "\n");
+write(g($n), " ", h($m), "\n");
+$c = "p";
+$d = $c . ($c = "q") . $c;
+write($d, "\n");
+$e = 3;
+$f = $e * ($e = $e + 1) - $e;
+write($f, "\n");
+$i = 0;
+$t = 0;
+while ($i < 3) {
+    $t = $t + ($t = $i);
+    $i = $i + 1;
+}
+write($t, "\n");
+$w = readi();
+write($w, " ", $w = 3, "\n");
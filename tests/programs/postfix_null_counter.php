@@ -0,0 +1,42 @@
+<?php
+declare(strict_types=1);
+// counters initialized to null become ints after increment and stay null after decrement
+
+$j = null;
+while ($j < 4) {
+    write($j * 3 + 1, " ");
+    $j++;
+}
+write("\n");
+$k = null;
+$k++;
+$k++;
+write($k, "\n");
+$n = null;
+$old = $n--;
+if ($n === null && $old === null) {
+    write("null\n");
+}
+$m = null;
+$old = $m++;
+if ($old === null) {
+    write($m, "\n");
+}
+$f = 1.5;
+$f++;
+write($f, "\n");
+$mixed = 0.5;
+if (readi() > 2) {
+    $mixed = 2;
+}
+$mixed++;
+write($mixed, "\n");
+$x = readi();
+$y = $x--;
+write($x, " ", $y, "\n");
+$t = true;
+$t++;
+$t--;
+if ($t === true) {
+    write("bool\n");
+}
@@ -0,0 +1,41 @@
+<?php
+declare(strict_types=1);
+// postfix operators on ?int values have to change the variable itself
+
+function increment(?int $x): ?int {
+    $x++;
+    return $x;
+}
+
+function decrement(?int $x): ?int {
+    $x--;
+    return $x;
+}
+
+$i = readi();
+$i++;
+write($i, "\n");
+$j = $i++;
+write($j, " ", $i, "\n");
+$k = $i--;
+write($k, " ", $i, "\n");
+write(increment(readi()), "\n");
+write(decrement(readi()), "\n");
+write(increment(null), "\n");
+$n = decrement(null);
+if ($n === null) {
+    write("null\n");
+}
+for ($i = readi(); $i < 6; $i++) {
+    write($i);
+}
+write("\n");
+$i = readi();
+while ($i > 0) {
+    $i--;
+    write($i, ",");
+}
+write("\n");
+$b = readi();
+$b = $b++;
+write($b, "\n");
@@ -5,6 +5,7 @@
 #include "catch.hpp"
 
 #include <filesystem>
+#include <string>
 
 TEST_CASE("Verify that required files exists") {
 	using namespace std::filesystem;
@@ -14,3 +15,19 @@ TEST_CASE("Verify that required files exists") {
 	CHECK(exists("./rozdeleni"));
 	CHECK(system("cd tests/IFJ22_Tester && ./test.py ../../ifj22") == 0);
 }
+
+TEST_CASE("Verify output of test programs") {
+	using namespace std::filesystem;
+	path code = temp_directory_path() / "ifj22_test.code";
+	for(const directory_entry & entry : directory_iterator("tests/programs")) {
+		path source = entry.path();
+		if(source.extension() != ".php") continue;
+		path input = path(source).replace_extension(".in");
+		path output = path(source).replace_extension(".out");
+		std::string command = "./ifj22 < " + source.string() + " > " + code.string() +
+			" && ic22int " + code.string() + " < " + (exists(input) ? input.string() : "/dev/null") +
+			" | cmp -s - " + output.string();
+		INFO(source.string());
+		CHECK(system(command.c_str()) == 0);
+	}
+}